@@ -1,4 +1,5 @@
 #include "audio_digital_vol.h"
+#include "audio_fx_chain.h"
 
 
 #define DIGITAL_FADE_EN 	1
@@ -707,6 +708,9 @@ void *user_audio_process_open(void *parm, void *priv, void (*handler)(void *priv
         log_i("vol :%d vol_max:%d fade_step:%d\n", dvol_parm->vol, dvol_parm->vol_max, dvol_parm->fade_step);
         user_hdl->dvol_hdl = user_audio_digital_volume_open(dvol_parm->vol, dvol_parm->vol_max, dvol_parm->fade_step);
     }
+    if (dvol_parm->fx) {
+        user_hdl->fx_chain = audio_fx_chain_open(dvol_parm->fx);
+    }
     log_i("%s ok\n", __FUNCTION__);
     return user_hdl;
 }
@@ -723,6 +727,11 @@ int user_audio_process_close(void *_uparm_hdl)
         user_audio_digital_volume_close(user_hdl->dvol_hdl);
         user_hdl->dvol_hdl = NULL;
     }
+    if (user_hdl->fx_chain) {
+        audio_fx_chain_stat_dump(user_hdl->fx_chain);
+        audio_fx_chain_close(user_hdl->fx_chain);
+        user_hdl->fx_chain = NULL;
+    }
     free(user_hdl);
     user_hdl = NULL;
     log_i("%s ok\n", __FUNCTION__);
@@ -742,6 +751,19 @@ void user_audio_process_handler_run(void *_uparm_hdl, void *data, u32 len, u8 ch
         user_hdl->handler(user_hdl->priv, data, len, ch_num);
     }
 
+    if (user_hdl->fx_chain) {
+        /*EQ/DRC/噪声门/数字音量分块一次跑完*/
+        struct digital_volume *d_volume = user_hdl->dvol_hdl;
+        if (d_volume && d_volume->toggle) {
+            os_mutex_pend(&d_volume->mutex, 0);
+            audio_fx_chain_run(user_hdl->fx_chain, data, len, d_volume);
+            os_mutex_post(&d_volume->mutex);
+        } else {
+            audio_fx_chain_run(user_hdl->fx_chain, data, len, NULL);
+        }
+        return;
+    }
+
     if (user_hdl->dvol_hdl) {
         user_audio_digital_volume_run(user_hdl->dvol_hdl, data, len, ch_num);
     }
@@ -46,11 +46,14 @@ void *user_audio_process_open(void *parm, void *priv, void (*handler)(void *priv
 int user_audio_process_close(void *_uparm_hdl);
 void user_audio_process_handler_run(void *_uparm_hdl, void *data, u32 len, u8 ch_num);
 
+struct audio_fx_chain_parm;
+
 struct user_audio_digital_parm {
     u8 en;
     u8 vol;
     u8 vol_max;
     u16 fade_step;
+    const struct audio_fx_chain_parm *fx;   /*音效链配置(EQ/DRC/噪声门), NULL:不使用; 使用时数字音量作为链的最后一级*/
 };
 
 struct digital_volume {
@@ -74,6 +77,7 @@ struct user_audio_parm {
     void *priv;
     void (*handler)(void *priv, void *data, int len, u8 ch_num);/*用户自定义回调处理*/
     struct digital_volume *dvol_hdl;
+    void *fx_chain;
 };
 
 #endif
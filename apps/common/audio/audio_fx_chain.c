@@ -0,0 +1,339 @@
+#include "asm/includes.h"
+#include "system/includes.h"
+#include "audio_fx_chain.h"
+
+#define FX_WORK_MAX         ((1 << 17) - 1)     /*工作区幅度上限, 给EQ留18dB余量, 后级乘Q14增益不溢出*/
+#define FX_GAIN_ONE         (1 << 14)
+
+struct audio_fx_biquad {
+    s32 x1;
+    s32 x2;
+    s32 y1;
+    s32 y2;
+};
+
+struct audio_fx_chain {
+    u8 ch_num;
+    u8 eq_section;
+    u8 drc_en;
+    u8 drc_ratio;
+    u8 gate_en;
+    u8 drc_cnt;
+    s16 drc_thr;
+    u16 drc_attack;
+    u16 drc_release;
+    s16 gate_thr;
+    u16 gate_open_step;
+    u16 gate_close_step;
+    s32 drc_env;
+    s32 drc_gain;
+    s32 gate_gain;
+    struct audio_fx_eq_coeff *eq_coeff;     /*eq_section个*/
+    struct audio_fx_biquad *eq_state;       /*eq_section * ch_num个*/
+    s32 *work;                              /*AUDIO_FX_CHUNK_POINTS * ch_num*/
+    struct audio_fx_chain_stat stat;
+    u8 arena[0];
+};
+
+#if AUDIO_FX_PROFILE_EN
+static inline u32 fx_tick_diff(u32 begin, u32 end)
+{
+    return end >= begin ? end - begin : end + TICK_PRD - begin;
+}
+#define FX_PROFILE_BEGIN()          u32 __t = TICK_CNT
+#define FX_PROFILE_END(fx, stage)   do { \
+    u32 __e = TICK_CNT; \
+    (fx)->stat.cost[stage] += fx_tick_diff(__t, __e); \
+    __t = __e; \
+} while (0)
+#else
+#define FX_PROFILE_BEGIN()
+#define FX_PROFILE_END(fx, stage)
+#endif
+
+void *audio_fx_chain_open(const struct audio_fx_chain_parm *parm)
+{
+    struct audio_fx_chain *fx;
+    u32 size;
+    u8 *p;
+
+    if (!parm || parm->ch_num == 0 || parm->ch_num > AUDIO_FX_MAX_CH ||
+        parm->eq_section > AUDIO_FX_EQ_MAX_SECTION ||
+        (parm->eq_section && !parm->eq_coeff)) {
+        log_e("fx chain parm err\n");
+        return NULL;
+    }
+
+    /*一次分配, 依次切出EQ系数, EQ状态, 工作区*/
+    size = sizeof(*fx);
+    size += parm->eq_section * sizeof(struct audio_fx_eq_coeff);
+    size += parm->eq_section * parm->ch_num * sizeof(struct audio_fx_biquad);
+    size += AUDIO_FX_CHUNK_POINTS * parm->ch_num * sizeof(s32);
+    fx = zalloc(size);
+    if (!fx) {
+        log_e("fx chain NULL\n");
+        return NULL;
+    }
+
+    p = fx->arena;
+    fx->eq_coeff = (struct audio_fx_eq_coeff *)p;
+    p += parm->eq_section * sizeof(struct audio_fx_eq_coeff);
+    fx->eq_state = (struct audio_fx_biquad *)p;
+    p += parm->eq_section * parm->ch_num * sizeof(struct audio_fx_biquad);
+    fx->work = (s32 *)p;
+
+    fx->ch_num = parm->ch_num;
+    fx->eq_section = parm->eq_section;
+    if (parm->eq_section) {
+        memcpy(fx->eq_coeff, parm->eq_coeff, parm->eq_section * sizeof(struct audio_fx_eq_coeff));
+    }
+    fx->drc_en = parm->drc_en;
+    fx->drc_ratio = parm->drc_ratio;
+    fx->drc_thr = parm->drc_thr > 0 ? parm->drc_thr : 1;
+    fx->drc_attack = parm->drc_attack;
+    fx->drc_release = parm->drc_release;
+    fx->drc_gain = FX_GAIN_ONE;
+    fx->gate_en = parm->gate_en;
+    fx->gate_thr = parm->gate_thr;
+    fx->gate_open_step = parm->gate_open_step ? parm->gate_open_step : FX_GAIN_ONE;
+    fx->gate_close_step = parm->gate_close_step ? parm->gate_close_step : FX_GAIN_ONE;
+    fx->gate_gain = FX_GAIN_ONE;
+
+    log_i("fx chain open:ch %d eq %d drc %d gate %d, %d bytes\n",
+          fx->ch_num, fx->eq_section, fx->drc_en, fx->gate_en, size);
+    return fx;
+}
+
+void audio_fx_chain_close(void *chain)
+{
+    if (chain) {
+        free(chain);
+    }
+}
+
+static void fx_eq_run(struct audio_fx_chain *fx, s32 *work, int points)
+{
+    const struct audio_fx_eq_coeff *c;
+    struct audio_fx_biquad *st;
+    s64 acc;
+    s32 x, y;
+    int i, ch, sec;
+
+    for (sec = 0; sec < fx->eq_section; sec++) {
+        c = &fx->eq_coeff[sec];
+        for (ch = 0; ch < fx->ch_num; ch++) {
+            st = &fx->eq_state[sec * fx->ch_num + ch];
+            for (i = ch; i < points * fx->ch_num; i += fx->ch_num) {
+                x = work[i];
+                acc = (s64)c->b0 * x + (s64)c->b1 * st->x1 + (s64)c->b2 * st->x2
+                      - (s64)c->a1 * st->y1 - (s64)c->a2 * st->y2;
+                y = (s32)(acc >> 28);
+                st->x2 = st->x1;
+                st->x1 = x;
+                st->y2 = st->y1;
+                st->y1 = y;
+                work[i] = y;
+            }
+        }
+    }
+
+    /*EQ之后限制到工作区范围, 保证后面乘Q14增益不溢出*/
+    for (i = 0; i < points * fx->ch_num; i++) {
+        if (work[i] > FX_WORK_MAX) {
+            work[i] = FX_WORK_MAX;
+        } else if (work[i] < -FX_WORK_MAX) {
+            work[i] = -FX_WORK_MAX;
+        }
+    }
+}
+
+static void fx_drc_run(struct audio_fx_chain *fx, s32 *work, int points)
+{
+    s32 peak, v, out;
+    int i, ch;
+
+    for (i = 0; i < points; i++) {
+        s32 *frame = &work[i * fx->ch_num];
+
+        /*立体声联动: 取各声道最大值做检测*/
+        peak = 0;
+        for (ch = 0; ch < fx->ch_num; ch++) {
+            v = frame[ch] < 0 ? -frame[ch] : frame[ch];
+            if (v > peak) {
+                peak = v;
+            }
+        }
+        if (peak > fx->drc_env) {
+            fx->drc_env += (s32)(((s64)(peak - fx->drc_env) * fx->drc_attack) >> 15);
+        } else {
+            fx->drc_env -= (s32)(((s64)(fx->drc_env - peak) * fx->drc_release) >> 15);
+        }
+
+        if (++fx->drc_cnt >= AUDIO_FX_DRC_GAIN_INTERVAL) {
+            fx->drc_cnt = 0;
+            if (fx->drc_env > fx->drc_thr) {
+                out = fx->drc_thr;
+                if (fx->drc_ratio > 1) {
+                    out += (fx->drc_env - fx->drc_thr) / fx->drc_ratio;
+                }
+                fx->drc_gain = (out << 13) / (fx->drc_env >> 1);
+                if (fx->drc_gain > FX_GAIN_ONE) {
+                    fx->drc_gain = FX_GAIN_ONE;
+                }
+            } else {
+                fx->drc_gain = FX_GAIN_ONE;
+            }
+        }
+
+        if (fx->drc_gain != FX_GAIN_ONE) {
+            for (ch = 0; ch < fx->ch_num; ch++) {
+                frame[ch] = (frame[ch] * fx->drc_gain) >> 14;
+            }
+        }
+    }
+}
+
+static void fx_gate_run(struct audio_fx_chain *fx, s32 *work, int points)
+{
+    s32 peak = 0, v, target;
+    int i, ch;
+
+    /*按块判断开关门, 块内逐帧平滑增益*/
+    for (i = 0; i < points * fx->ch_num; i++) {
+        v = work[i] < 0 ? -work[i] : work[i];
+        if (v > peak) {
+            peak = v;
+        }
+    }
+    target = peak < fx->gate_thr ? 0 : FX_GAIN_ONE;
+    if (target == FX_GAIN_ONE && fx->gate_gain == FX_GAIN_ONE) {
+        return;
+    }
+
+    for (i = 0; i < points; i++) {
+        if (fx->gate_gain < target) {
+            fx->gate_gain += fx->gate_open_step;
+            if (fx->gate_gain > target) {
+                fx->gate_gain = target;
+            }
+        } else if (fx->gate_gain > target) {
+            fx->gate_gain -= fx->gate_close_step;
+            if (fx->gate_gain < target) {
+                fx->gate_gain = target;
+            }
+        }
+        for (ch = 0; ch < fx->ch_num; ch++) {
+            work[i * fx->ch_num + ch] = (work[i * fx->ch_num + ch] * fx->gate_gain) >> 14;
+        }
+    }
+}
+
+/*最后一级: 数字音量(淡入淡出规则同audio_vol_mix) + 饱和写回s16*/
+static void fx_vol_run(struct audio_fx_chain *fx, s32 *work, s16 *out, int points, struct digital_volume *dvol)
+{
+    s32 v, vol = FX_GAIN_ONE;
+    int i, ch;
+
+    if (dvol && dvol->fade == 0) {
+        dvol->vol_fade = dvol->vol_target;
+    }
+
+    for (i = 0; i < points; i++) {
+        if (dvol) {
+            if (dvol->vol_fade < dvol->vol_target) {
+                dvol->vol_fade += dvol->fade_step;
+                if (dvol->vol_fade > dvol->vol_target) {
+                    dvol->vol_fade = dvol->vol_target;
+                }
+            } else if (dvol->vol_fade > dvol->vol_target) {
+                dvol->vol_fade -= dvol->fade_step;
+                if (dvol->vol_fade < dvol->vol_target) {
+                    dvol->vol_fade = dvol->vol_target;
+                }
+            }
+            vol = dvol->vol_fade;
+        }
+        for (ch = 0; ch < fx->ch_num; ch++) {
+            v = (work[i * fx->ch_num + ch] * vol) >> 14;
+            if (v > 32767) {
+                v = 32767;
+            } else if (v < -32768) {
+                v = -32768;
+            }
+            out[i * fx->ch_num + ch] = (s16)v;
+        }
+    }
+}
+
+int audio_fx_chain_run(void *chain, s16 *data, u32 len, struct digital_volume *dvol)
+{
+    struct audio_fx_chain *fx = (struct audio_fx_chain *)chain;
+    s32 *work;
+    u32 points;
+    int n, i;
+
+    if (!fx || !data) {
+        return -EINVAL;
+    }
+    work = fx->work;
+    points = len / 2 / fx->ch_num;
+    fx->stat.blocks++;
+    fx->stat.points += points;
+
+    while (points) {
+        n = points > AUDIO_FX_CHUNK_POINTS ? AUDIO_FX_CHUNK_POINTS : points;
+        FX_PROFILE_BEGIN();
+
+        for (i = 0; i < n * fx->ch_num; i++) {
+            work[i] = data[i];
+        }
+        if (fx->eq_section) {
+            fx_eq_run(fx, work, n);
+        }
+        FX_PROFILE_END(fx, AUDIO_FX_STAGE_EQ);
+        if (fx->drc_en) {
+            fx_drc_run(fx, work, n);
+        }
+        FX_PROFILE_END(fx, AUDIO_FX_STAGE_DRC);
+        if (fx->gate_en) {
+            fx_gate_run(fx, work, n);
+        }
+        FX_PROFILE_END(fx, AUDIO_FX_STAGE_GATE);
+        fx_vol_run(fx, work, data, n, dvol);
+        FX_PROFILE_END(fx, AUDIO_FX_STAGE_VOL);
+
+        data += n * fx->ch_num;
+        points -= n;
+    }
+
+    return 0;
+}
+
+int audio_fx_chain_stat_get(void *chain, struct audio_fx_chain_stat *stat)
+{
+    struct audio_fx_chain *fx = (struct audio_fx_chain *)chain;
+
+    if (!fx || !stat) {
+        return -EINVAL;
+    }
+    memcpy(stat, &fx->stat, sizeof(*stat));
+    return 0;
+}
+
+void audio_fx_chain_stat_dump(void *chain)
+{
+    struct audio_fx_chain *fx = (struct audio_fx_chain *)chain;
+    u32 points;
+
+    if (!fx || !fx->stat.points) {
+        return;
+    }
+    points = fx->stat.points;
+    /*每100帧耗时(TICK_CNT计数)*/
+    printf("fx chain blocks:%d points:%d cost/100pt eq:%d drc:%d gate:%d vol:%d\n",
+           fx->stat.blocks, points,
+           (u32)((u64)fx->stat.cost[AUDIO_FX_STAGE_EQ] * 100 / points),
+           (u32)((u64)fx->stat.cost[AUDIO_FX_STAGE_DRC] * 100 / points),
+           (u32)((u64)fx->stat.cost[AUDIO_FX_STAGE_GATE] * 100 / points),
+           (u32)((u64)fx->stat.cost[AUDIO_FX_STAGE_VOL] * 100 / points));
+}
@@ -0,0 +1,74 @@
+#ifndef _AUDIO_FX_CHAIN_H_
+#define _AUDIO_FX_CHAIN_H_
+
+#include "generic/typedef.h"
+#include "audio_digital_vol.h"
+
+/*
+ * 音效处理链: EQ -> DRC -> 噪声门 -> 数字音量
+ * 数据按AUDIO_FX_CHUNK_POINTS帧分块, 每块依次跑完所有级再处理下一块,
+ * 块内中间结果放在32bit工作区里(EQ增益不会在DRC之前被截断),
+ * 所有状态在open时从一块内存里分配, run过程中不再申请内存.
+ */
+
+#define AUDIO_FX_CHUNK_POINTS       32      //每块帧数
+#define AUDIO_FX_MAX_CH             2
+#define AUDIO_FX_EQ_MAX_SECTION     8
+#define AUDIO_FX_DRC_GAIN_INTERVAL  8       //DRC增益每多少帧重新计算一次
+#define AUDIO_FX_PROFILE_EN         1       //统计每一级的耗时
+
+enum {
+    AUDIO_FX_STAGE_EQ = 0,
+    AUDIO_FX_STAGE_DRC,
+    AUDIO_FX_STAGE_GATE,
+    AUDIO_FX_STAGE_VOL,
+    AUDIO_FX_STAGE_NUM,
+};
+
+/*
+ * 二阶节系数, Q28
+ * y = b0*x + b1*x1 + b2*x2 - a1*y1 - a2*y2
+ */
+struct audio_fx_eq_coeff {
+    s32 b0;
+    s32 b1;
+    s32 b2;
+    s32 a1;
+    s32 a2;
+};
+
+struct audio_fx_chain_parm {
+    u8 ch_num;                                  /*声道数, 1或2*/
+
+    u8 eq_section;                              /*EQ二阶节个数, 0:不使用EQ*/
+    const struct audio_fx_eq_coeff *eq_coeff;   /*open时拷贝, 调用者不需要保留*/
+
+    u8 drc_en;
+    u8 drc_ratio;                               /*压缩比n:1, 0:限幅*/
+    s16 drc_thr;                                /*门限(线性幅度)*/
+    u16 drc_attack;                             /*包络跟随系数Q15, 越大越快*/
+    u16 drc_release;
+
+    u8 gate_en;
+    s16 gate_thr;                               /*块峰值低于门限时关门*/
+    u16 gate_open_step;                         /*每帧增益步进, Q14*/
+    u16 gate_close_step;
+};
+
+struct audio_fx_chain_stat {
+    u32 blocks;                                 /*run调用次数*/
+    u32 points;                                 /*处理的帧数*/
+    u32 cost[AUDIO_FX_STAGE_NUM];               /*各级累计耗时(TICK_CNT计数)*/
+};
+
+void *audio_fx_chain_open(const struct audio_fx_chain_parm *parm);
+void audio_fx_chain_close(void *chain);
+/*
+ * dvol: 作为最后一级的数字音量, NULL时只做饱和
+ * len: 字节数
+ */
+int audio_fx_chain_run(void *chain, s16 *data, u32 len, struct digital_volume *dvol);
+int audio_fx_chain_stat_get(void *chain, struct audio_fx_chain_stat *stat);
+void audio_fx_chain_stat_dump(void *chain);
+
+#endif/*_AUDIO_FX_CHAIN_H_*/
@@ -32,6 +32,7 @@
 #include <limits.h>
 #include <ctype.h>
 #include "cJSON.h"
+#include "system/malloc.h"
 
 static const char *ep;
 
@@ -54,8 +55,9 @@ static int cJSON_strcasecmp(const char *s1, const char *s2)
     return tolower(*(const unsigned char *)s1) - tolower(*(const unsigned char *)s2);
 }
 
-static void *(*cJSON_malloc)(size_t sz) = malloc;
-static void (*cJSON_free)(void *ptr) = free;
+/* 节点和短字符串都是小块内存, 默认走slab, cJSON_Print*的结果要用slab_free释放 */
+static void *(*cJSON_malloc)(size_t sz) = slab_malloc;
+static void (*cJSON_free)(void *ptr) = slab_free;
 
 static char *cJSON_strdup(const char *str)
 {
@@ -73,13 +75,13 @@ static char *cJSON_strdup(const char *str)
 void cJSON_InitHooks(cJSON_Hooks *hooks)
 {
     if (!hooks) { /* Reset hooks */
-        cJSON_malloc = malloc;
-        cJSON_free = free;
+        cJSON_malloc = slab_malloc;
+        cJSON_free = slab_free;
         return;
     }
 
-    cJSON_malloc = (hooks->malloc_fn) ? hooks->malloc_fn : malloc;
-    cJSON_free	 = (hooks->free_fn) ? hooks->free_fn : free;
+    cJSON_malloc = (hooks->malloc_fn) ? hooks->malloc_fn : slab_malloc;
+    cJSON_free	 = (hooks->free_fn) ? hooks->free_fn : slab_free;
 }
 
 /* Internal constructor. */
@@ -0,0 +1,189 @@
+#include "app_config.h"
+#include "system/includes.h"
+#include "system/timer.h"
+#include "generic/spsc_buf.h"
+#include "generic/dlog.h"
+#include <stdarg.h>
+
+#if CONFIG_DLOG_ENABLE && defined(CONFIG_DEBUG_ENABLE)
+
+/*
+ * 多个任务/中断都可能写日志, 生产者之间用关中断互斥(只包住一次拷贝),
+ * 消费者只有dlog任务, 读写两端仍按spsc_buf的规则更新指针
+ */
+struct dlog_hdl {
+    spsc_buf_t sbuf;
+    OS_SEM sem;
+    u8 init;
+    u8 seq;
+    struct dlog_stat stat;
+};
+
+static struct dlog_hdl dlog;
+static u8 dlog_buf[DLOG_BUF_SIZE] __attribute__((aligned(4)));
+SPSC_BUF_SIZE_CHECK(dlog_buf, DLOG_BUF_SIZE);
+
+static void dlog_push(struct dlog_frame_head *head, u32 len)
+{
+    u32 used;
+
+    if (!dlog.init) {
+        dlog.stat.lost++;
+        return;
+    }
+
+    head->sync = DLOG_SYNC;
+    head->ts = sys_timer_get_ms();
+
+    local_irq_disable();
+    used = spsc_buf_get_data_len(&dlog.sbuf);
+    if (spsc_buf_get_free_len(&dlog.sbuf) < len) {
+        dlog.stat.lost++;
+        dlog.seq++;             //序号照样递增, 主机据此发现丢帧
+        local_irq_enable();
+        return;
+    }
+    head->seq = dlog.seq++;
+    spsc_buf_write(&dlog.sbuf, head, len);
+    dlog.stat.frames++;
+    if (used + len > dlog.stat.max_used) {
+        dlog.stat.max_used = used + len;
+    }
+    local_irq_enable();
+
+    //ring由空变为非空时才唤醒输出任务
+    if (used == 0) {
+        os_sem_post(&dlog.sem);
+    }
+}
+
+void dlog_write(int level, u32 id, int argc, ...)
+{
+    u32 frame[(sizeof(struct dlog_frame_head) + DLOG_MAX_ARGS * sizeof(u32)) / sizeof(u32)];
+    struct dlog_frame_head *head = (struct dlog_frame_head *)frame;
+    u32 *args = (u32 *)(head + 1);
+    va_list argptr;
+    int i;
+
+    if (argc > DLOG_MAX_ARGS) {
+        argc = DLOG_MAX_ARGS;
+    }
+    va_start(argptr, argc);
+    for (i = 0; i < argc; i++) {
+        args[i] = va_arg(argptr, u32);
+    }
+    va_end(argptr);
+
+    head->info = level & 0x7;
+    head->len = argc * sizeof(u32);
+    head->id = id;
+    dlog_push(head, sizeof(struct dlog_frame_head) + head->len);
+}
+
+void dlog_write_hex(int level, const void *buf, int len)
+{
+    u32 frame[(sizeof(struct dlog_frame_head) + 2 + DLOG_HEXDUMP_MAX + 3) / sizeof(u32)];
+    struct dlog_frame_head *head = (struct dlog_frame_head *)frame;
+    u8 *payload = (u8 *)(head + 1);
+    int n = len > DLOG_HEXDUMP_MAX ? DLOG_HEXDUMP_MAX : len;
+
+    if (n < 0) {
+        return;
+    }
+    //原始长度放在payload前2字节, 主机据此标注截断
+    payload[0] = len & 0xff;
+    payload[1] = (len >> 8) & 0xff;
+    memcpy(payload + 2, buf, n);
+
+    head->info = DLOG_INFO_HEX | (level & 0x7);
+    head->len = 2 + n;
+    head->id = 0;
+    dlog_push(head, sizeof(struct dlog_frame_head) + head->len);
+}
+
+/*
+ * 按帧取出输出, lock=1时每帧单独占住log输出: 帧不会被普通打印插断,
+ * 帧与帧之间放开锁, 普通printf不用等整段ring输出完
+ */
+static void dlog_drain(u8 lock)
+{
+    u32 frame[(sizeof(struct dlog_frame_head) + 2 + DLOG_HEXDUMP_MAX + 3) / sizeof(u32)];
+    struct dlog_frame_head *head = (struct dlog_frame_head *)frame;
+    u8 *ptr = (u8 *)frame;
+    u32 len;
+    u32 i;
+
+    while (spsc_buf_read(&dlog.sbuf, head, sizeof(struct dlog_frame_head))) {
+        len = sizeof(struct dlog_frame_head);
+        len += spsc_buf_read(&dlog.sbuf, head + 1, head->len);
+        if (lock) {
+            log_output_lock();
+        }
+        for (i = 0; i < len; i++) {
+            log_putbyte(ptr[i]);
+        }
+        if (lock) {
+            log_output_unlock();
+        }
+    }
+}
+
+/*
+ * 只能在dlog任务不会再运行的场合调用(死机/复位前),
+ * 否则会与dlog任务同时消费ring
+ */
+void dlog_flush(void)
+{
+    if (dlog.init) {
+        dlog_drain(0);
+    }
+}
+
+void dlog_stat_get(struct dlog_stat *stat)
+{
+    local_irq_disable();
+    memcpy(stat, &dlog.stat, sizeof(struct dlog_stat));
+    local_irq_enable();
+}
+
+static void dlog_task(void *p)
+{
+    while (1) {
+        os_sem_pend(&dlog.sem, 0);
+        dlog_drain(1);
+    }
+}
+
+static int dlog_init(void)
+{
+    spsc_buf_init(&dlog.sbuf, dlog_buf, sizeof(dlog_buf));
+    os_sem_create(&dlog.sem, 0);
+    task_create(dlog_task, NULL, "dlog");
+    dlog.init = 1;
+    return 0;
+}
+late_initcall(dlog_init);
+
+#else
+
+void dlog_write(int level, u32 id, int argc, ...)
+{
+
+}
+
+void dlog_write_hex(int level, const void *buf, int len)
+{
+
+}
+
+void dlog_flush(void)
+{
+
+}
+
+void dlog_stat_get(struct dlog_stat *stat)
+{
+    memset(stat, 0, sizeof(struct dlog_stat));
+}
+
+#endif /* #if CONFIG_DLOG_ENABLE && defined(CONFIG_DEBUG_ENABLE) */
@@ -21,6 +21,8 @@ u8 sensor_iic_init_status = 0;
 #define ADDR_R   ((0x19U<<1) | 1)
 #define ADDR_W   ((0x19U<<1) | 0)
 
+static u8 sl_fifo_wtm = 0; // 0:不使用FIFO水位中断
+
 typedef struct {
     u8 reg;
     u8 value;
@@ -108,7 +110,26 @@ static void sl_restart_fifo(void)
     and then switch back to FIFO mode
     */
     sl_write_regs(0x2e, 0);
-    sl_write_regs(0x2e, 0x9F);
+    sl_write_regs(0x2e, sl_fifo_wtm ? (0x80 | sl_fifo_wtm) : 0x9F);
+}
+
+// wtm:FIFO水位(1~31), INT1在FIFO数据超过水位时输出高电平; 0:关闭
+static u8 sl_fifo_wtm_set(u8 wtm)
+{
+    u8 ret = 1;
+
+    if (wtm > 31) {
+        wtm = 31;
+    }
+    sl_fifo_wtm = wtm;
+    if (wtm) {
+        ret &= sl_write_regs(0x25, 0x00); // INT高电平有效
+        ret &= sl_write_regs(0x22, 0x04); // I1_WTM
+    } else {
+        ret &= sl_write_regs(0x22, 0x00);
+    }
+    sl_restart_fifo();
+    return ret;
 }
 
 
@@ -126,7 +147,12 @@ u8 sl_device_init(void)
     os_time_dly(1); // 10ms
 #endif
     sl_device_check();
-    return sl_config_register();
+    u8 ret = sl_config_register();
+    // 软复位后水位中断配置丢失, 需要重新配置
+    if (ret == 0 && sl_fifo_wtm) {
+        sl_fifo_wtm_set(sl_fifo_wtm);
+    }
+    return ret;
 }
 
 u8 sl_device_disable(void)
@@ -161,6 +187,9 @@ s32 sl_device_ctl(u8 cmd, void *arg)
         res = sl_device_check();
         memcpy(arg, &res, 1);
         break;
+    case GSENSOR_SET_FIFO_WTM:
+        ret = sl_fifo_wtm_set(*(u8 *)arg) ? 0 : -1;
+        break;
     default:
         break;
     }
@@ -23,10 +23,13 @@
 
 #define SL_SC7A20H_FIFO_CTRL_REG   (unsigned char)0X2E
 #define SL_SC7A20H_FIFO_SRC_REG    (unsigned char)0X2F
+#define SL_SC7A20H_CTRL_REG3       (unsigned char)0X22
+#define SL_SC7A20H_CTRL_REG6       (unsigned char)0X25
 #define SL_SC7A20H_SPI_OUT_X_L     (unsigned char)0X27
 #define SL_SC7A20H_IIC_OUT_X_L     (unsigned char)0XA8
 
 static unsigned char  SL_SPI_IIC_INTERFACE         = 0;
+static unsigned char  SL_FIFO_WTM                  = 0; // 0:不使用FIFO水位中断
 
 /***使用驱动前请根据实际接线情况配置（7bit）IIC地址******/
 /**SC7A20的SDO 脚接地：            0x18****************/
@@ -121,9 +124,35 @@ static signed char SL_SC7A20H_Driver_Init(unsigned char Sl_spi_iic_init, unsigne
     return 0;
 }
 
+// wtm:FIFO水位(1~31), INT1在FIFO数据超过水位时输出高电平, 读走数据后恢复低电平; 0:关闭
+static unsigned char SL_SC7A20H_Fifo_Wtm_Set(unsigned char wtm)
+{
+    unsigned char ret = 1;
+
+    if (wtm > 31) {
+        wtm = 31;
+    }
+    if (wtm) {
+        ret &= SL_SC7A20H_I2c_Spi_Write(SL_SPI_IIC_INTERFACE, SL_SC7A20H_CTRL_REG6, 0x00); // INT高电平有效
+        ret &= SL_SC7A20H_I2c_Spi_Write(SL_SPI_IIC_INTERFACE, SL_SC7A20H_FIFO_CTRL_REG, 0x80 | wtm); // stream模式 + 水位
+        ret &= SL_SC7A20H_I2c_Spi_Write(SL_SPI_IIC_INTERFACE, SL_SC7A20H_CTRL_REG3, 0x04); // I1_WTM
+    } else {
+        ret &= SL_SC7A20H_I2c_Spi_Write(SL_SPI_IIC_INTERFACE, SL_SC7A20H_CTRL_REG3, 0x00);
+        ret &= SL_SC7A20H_I2c_Spi_Write(SL_SPI_IIC_INTERFACE, SL_SC7A20H_FIFO_CTRL_REG, 0x9F);
+    }
+    SL_FIFO_WTM = wtm;
+    return ret;
+}
+
 static unsigned char SL_SC7A20H_Init(void)
 {
-    return SL_SC7A20H_Driver_Init(1, 0);
+    signed char ret = SL_SC7A20H_Driver_Init(1, 0);
+
+    // 重新初始化会把FIFO配置恢复成默认值, 水位中断需要重新配置
+    if (ret == 0 && SL_FIFO_WTM) {
+        SL_SC7A20H_Fifo_Wtm_Set(SL_FIFO_WTM);
+    }
+    return ret;
 }
 
 // 使用FIFO模式读取数据，每次读取缓冲区多个数据（最多32组）
@@ -131,6 +160,7 @@ static unsigned char SL_SC7A20H_Read_FIFO_Buf(axis_info_t *accel)
 {
     unsigned char  i = 0;
     unsigned char  sc7a20_data[7];
+    unsigned char  fifo_data[32 * 6];
     unsigned char  SL_FIFO_ACCEL_NUM;
     short x, y, z;
     short x_sum = 0, y_sum = 0, z_sum = 0;
@@ -143,21 +173,28 @@ static unsigned char SL_SC7A20H_Read_FIFO_Buf(axis_info_t *accel)
 
     LOG("send data len is %d\n", SL_FIFO_ACCEL_NUM);
     if (SL_FIFO_ACCEL_NUM == 0) {
-        SL_SC7A20H_Init();
+        // 水位中断模式下启动时的排空和保护定时器都可能读到空FIFO, 属于正常情况, 不重新初始化
+        if (!SL_FIFO_WTM) {
+            SL_SC7A20H_Init();
+        }
         return 0;
     }
-    /* spin_lock() */
-    for (i = 0; i < SL_FIFO_ACCEL_NUM; i++) {
-
-        if (SL_SPI_IIC_INTERFACE == 0) {
+    if (SL_SPI_IIC_INTERFACE == 0) {
+        for (i = 0; i < SL_FIFO_ACCEL_NUM; i++) {
             SL_SC7A20H_I2c_Spi_Read(SL_SPI_IIC_INTERFACE, SL_SC7A20H_SPI_OUT_X_L, 7, &sc7a20_data[0]);
-        } else {
-            SL_SC7A20H_I2c_Spi_Read(SL_SPI_IIC_INTERFACE, SL_SC7A20H_IIC_OUT_X_L, 6, &sc7a20_data[1]);
+            memcpy(&fifo_data[i * 6], &sc7a20_data[1], 6);
         }
+    } else {
+        // 0xA8地址自增, FIFO使能时读到0x2D后回到0x28, 一次连续读出FIFO里的全部数据
+        if (SL_SC7A20H_I2c_Spi_Read(SL_SPI_IIC_INTERFACE, SL_SC7A20H_IIC_OUT_X_L, SL_FIFO_ACCEL_NUM * 6, fifo_data) != SL_FIFO_ACCEL_NUM * 6) {
+            return 0;
+        }
+    }
 
-        x = (signed short int)(((unsigned char)sc7a20_data[2] * 256) + (unsigned char)sc7a20_data[1]);
-        y = (signed short int)(((unsigned char)sc7a20_data[4] * 256) + (unsigned char)sc7a20_data[3]);
-        z = (signed short int)(((unsigned char)sc7a20_data[6] * 256) + (unsigned char)sc7a20_data[5]);
+    for (i = 0; i < SL_FIFO_ACCEL_NUM; i++) {
+        x = (signed short int)(((unsigned char)fifo_data[i * 6 + 1] * 256) + (unsigned char)fifo_data[i * 6 + 0]);
+        y = (signed short int)(((unsigned char)fifo_data[i * 6 + 3] * 256) + (unsigned char)fifo_data[i * 6 + 2]);
+        z = (signed short int)(((unsigned char)fifo_data[i * 6 + 5] * 256) + (unsigned char)fifo_data[i * 6 + 4]);
 
         accel[i].x = x >> 3;
         accel[i].y = y >> 3;
@@ -201,6 +238,9 @@ s32 SL_SC7A20H_CTL(u8 cmd, void *arg)
         res = SL_SC7A20H_Check();
         memcpy(arg, &res, 1);
         break;
+    case GSENSOR_SET_FIFO_WTM:
+        ret = SL_SC7A20H_Fifo_Wtm_Set(*(u8 *)arg) ? 0 : -1;
+        break;
     default:
         break;
     }
@@ -0,0 +1,343 @@
+#include "gSensor_manage.h"
+#include "app_config.h"
+#include "Motion_api.h"
+
+/*
+ * gsensor FIFO水位中断模式 + 运动特征提取
+ *
+ * 定时读取时每次都要唤醒CPU走一遍IIC, 找我设备大部分时间静止, 这些唤醒基本是白做.
+ * 水位中断模式下传感器自己攒数据, 攒够watermark组才拉INT, 这里在中断中只投递事件,
+ * app_core里一次IIC连续读出整个FIFO, 逐点更新特征, 上层只查询特征, 不再读IIC.
+ *
+ * 特征全部用整数增量计算:
+ *   activity : |a| - 重力幅值低通, 取绝对值再平滑
+ *   step     : 动态分量过上门限计一步, 需先回落到下门限以下, 且两步间隔不小于250ms
+ *   tilt     : 重力方向低通后与上次静止时的方向比较, 夹角大于30度
+ *   free_fall: |a|连续低于0.3g超过100ms
+ */
+
+#if (TCFG_GSENSOR_ENABLE && (TCFG_SC7A20_EN || TCFG_SC7A20_E_EN || TCFG_MSA310_EN))
+
+#if GSENSOR_PRINTF_ENABLE
+#define log_info(x, ...)  printf("[GSENSOR_FIFO]" x "\r\n", ## __VA_ARGS__)
+#else
+#define log_info(...)
+#endif
+
+/*各驱动READ_GSENSOR_DATA输出的量程和采样率*/
+#if TCFG_MSA310_EN
+#define GSENSOR_ODR_HZ          125
+#define GSENSOR_LSB_1G          256     //±8g, 12bit
+#else
+#define GSENSOR_ODR_HZ          25
+#define GSENSOR_LSB_1G          1024    //±4g
+#endif
+
+#define GSENSOR_MG(mg)          ((mg) * GSENSOR_LSB_1G / 1000)
+
+#define GSENSOR_ACTIVE_TH       GSENSOR_MG(40)      //activity超过该值认为在运动
+#define GSENSOR_STILL_SAMPLES   (GSENSOR_ODR_HZ * 2)    //activity连续2s低于门限认为静止
+#define GSENSOR_STEP_HI         GSENSOR_MG(150)
+#define GSENSOR_STEP_LO         GSENSOR_MG(50)
+#define GSENSOR_STEP_MIN_GAP    (GSENSOR_ODR_HZ / 4)    //最快4步/s
+#define GSENSOR_FREEFALL_TH     GSENSOR_MG(300)
+#define GSENSOR_FREEFALL_SAMPLES ((GSENSOR_ODR_HZ / 10) ? (GSENSOR_ODR_HZ / 10) : 1)
+
+/*中断丢失(INT保持高电平没有新边沿)时靠定时兜底读取, 间隔为水位时间的2倍*/
+#define GSENSOR_GUARD_SLACK     500
+
+struct gsensor_feature_state {
+    s32 mag_lp;         //|a|低通, Q4
+    s32 grav_lp[3];     //重力方向低通, Q3
+    s32 grav_ref[3];    //上次静止时的重力方向
+    u16 activity;       //LSB
+    u16 still_cnt;
+    u16 ff_cnt;
+    u16 step_gap;
+    u8  step_armed;
+    u8  ref_valid;
+    u8  warmup;
+    struct gsensor_feature out;
+};
+
+struct gsensor_stat {
+    u32 irq;            //INT中断次数
+    u32 read;           //FIFO读取次数
+    u32 sample;         //读出的数据组数
+    u32 empty;          //读到0组的次数
+    u32 full;           //读到满FIFO(可能已溢出)的次数
+    u32 guard;          //兜底定时读取次数
+};
+
+static struct gsensor_feature_state feature;
+static struct gsensor_stat gsensor_stat;
+static u8 fifo_watermark;
+static u8 fifo_enable;
+static u16 fifo_guard_timer;
+static u32 fifo_irq_last;
+
+static u32 gsensor_isqrt(u32 v)
+{
+    u32 res = 0;
+    u32 bit = 1UL << 30;
+
+    while (bit > v) {
+        bit >>= 2;
+    }
+    while (bit) {
+        if (v >= res + bit) {
+            v -= res + bit;
+            res = (res >> 1) + bit;
+        } else {
+            res >>= 1;
+        }
+        bit >>= 2;
+    }
+    return res;
+}
+
+void gsensor_feature_reset(void)
+{
+    local_irq_disable();
+    memset(&feature, 0, sizeof(feature));
+    local_irq_enable();
+}
+
+/*两个方向夹角是否大于30度: cos²30 = 3/4*/
+static u8 gsensor_tilt_check(const s32 *a, const s32 *b)
+{
+    s64 dot = (s64)a[0] * b[0] + (s64)a[1] * b[1] + (s64)a[2] * b[2];
+    s64 na = (s64)a[0] * a[0] + (s64)a[1] * a[1] + (s64)a[2] * a[2];
+    s64 nb = (s64)b[0] * b[0] + (s64)b[1] * b[1] + (s64)b[2] * b[2];
+
+    if (dot <= 0) {
+        return 1;
+    }
+    /*Q3的平方和最大约2^32, 先缩小再相乘避免溢出*/
+    dot >>= 8;
+    return 4 * dot * dot < 3 * (na >> 8) * (nb >> 8);
+}
+
+void gsensor_feature_update(const axis_info_t *accel, int num)
+{
+    struct gsensor_feature_state *f = &feature;
+    u8 moved = 0;
+    u8 free_fall = 0;
+    u8 tilt = 0;
+    u8 active;
+    u32 step;
+    s32 mag, dyn;
+    int i;
+
+    local_irq_disable();
+    gsensor_stat.read++;
+    gsensor_stat.sample += num;
+    if (num == 0) {
+        gsensor_stat.empty++;
+    } else if (num >= 32) {
+        gsensor_stat.full++;
+    }
+    local_irq_enable();
+
+    active = f->out.active;
+    step = f->out.step;
+
+    for (i = 0; i < num; i++) {
+        s32 x = accel[i].x;
+        s32 y = accel[i].y;
+        s32 z = accel[i].z;
+
+        mag = gsensor_isqrt(x * x + y * y + z * z);
+        if (!f->warmup) {
+            f->warmup = 1;
+            f->mag_lp = mag << 4;
+            f->grav_lp[0] = x << 3;
+            f->grav_lp[1] = y << 3;
+            f->grav_lp[2] = z << 3;
+        }
+        f->mag_lp += mag - (f->mag_lp >> 4);
+        f->grav_lp[0] += x - (f->grav_lp[0] >> 3);
+        f->grav_lp[1] += y - (f->grav_lp[1] >> 3);
+        f->grav_lp[2] += z - (f->grav_lp[2] >> 3);
+
+        //activity
+        dyn = mag - (f->mag_lp >> 4);
+        f->activity += ((dyn < 0 ? -dyn : dyn) - (s32)f->activity) / 8;
+        if (f->activity > GSENSOR_ACTIVE_TH) {
+            active = 1;
+            moved = 1;
+            f->still_cnt = 0;
+        } else if (f->still_cnt < GSENSOR_STILL_SAMPLES) {
+            f->still_cnt++;
+        } else if (active || !f->ref_valid) {
+            //进入静止, 与上次静止的方向比较后, 记录当前方向作为新的参考
+            if (f->ref_valid && gsensor_tilt_check(f->grav_lp, f->grav_ref)) {
+                tilt = 1;
+            }
+            active = 0;
+            memcpy(f->grav_ref, f->grav_lp, sizeof(f->grav_ref));
+            f->ref_valid = 1;
+        }
+
+        //step
+        if (f->step_gap < GSENSOR_STEP_MIN_GAP) {
+            f->step_gap++;
+        }
+        if (dyn < GSENSOR_STEP_LO) {
+            f->step_armed = 1;
+        } else if (dyn > GSENSOR_STEP_HI && f->step_armed && f->step_gap >= GSENSOR_STEP_MIN_GAP) {
+            f->step_armed = 0;
+            f->step_gap = 0;
+            step++;
+        }
+
+        //free fall
+        if (mag < GSENSOR_FREEFALL_TH) {
+            if (f->ff_cnt < GSENSOR_FREEFALL_SAMPLES) {
+                f->ff_cnt++;
+                if (f->ff_cnt == GSENSOR_FREEFALL_SAMPLES) {
+                    free_fall = 1;
+                }
+            }
+        } else {
+            f->ff_cnt = 0;
+        }
+    }
+
+    //运动过程中的倾斜只在一批数据处理完后算一次
+    if (f->ref_valid && gsensor_tilt_check(f->grav_lp, f->grav_ref)) {
+        tilt = 1;
+    }
+
+    local_irq_disable();
+    f->out.active = active;
+    f->out.moved |= moved;
+    f->out.tilt |= tilt;
+    f->out.free_fall |= free_fall;
+    f->out.step = step;
+    f->out.activity = (u32)f->activity * 1000 / GSENSOR_LSB_1G;
+    local_irq_enable();
+
+    if (moved || free_fall) {
+        log_info("num %d, active %d, step %d, free_fall %d", num, active, step, free_fall);
+    }
+}
+
+void gsensor_feature_get(struct gsensor_feature *f, u8 clear)
+{
+    local_irq_disable();
+    memcpy(f, &feature.out, sizeof(*f));
+    if (clear) {
+        feature.out.moved = feature.out.active;
+        feature.out.tilt = 0;
+        feature.out.free_fall = 0;
+    }
+    local_irq_enable();
+}
+
+static void gsensor_fifo_read(void)
+{
+    axis_info_t buf[32];
+
+    get_gSensor_data((short *)buf);
+}
+
+static void gsensor_fifo_event_handler(struct sys_event *e)
+{
+    if (fifo_enable) {
+        gsensor_fifo_read();
+    }
+}
+
+static void gsensor_fifo_guard(void *priv)
+{
+    u32 irq = gsensor_stat.irq;
+
+    if (irq == fifo_irq_last) {
+        gsensor_stat.guard++;
+        gsensor_fifo_read();
+    }
+    fifo_irq_last = irq;
+}
+
+/*INT脚唤醒中断里调用, 不能直接操作IIC, 投递事件到app_core, 未处理的中断合并为一次*/
+void gsensor_int_isr(void)
+{
+    struct sys_event e;
+
+    if (!fifo_enable) {
+        return;
+    }
+    gsensor_stat.irq++;
+
+    e.type = SYS_DEVICE_EVENT;
+    e.arg = (void *)DEVICE_EVENT_FROM_GSENSOR;
+    e.u.dev.event = 0;
+    e.u.dev.value = 0;
+    sys_event_post_merge(&e, DEVICE_EVENT_FROM_GSENSOR, NULL);
+}
+
+int gsensor_fifo_mode_start(u8 watermark)
+{
+    u32 period;
+
+    if (fifo_enable) {
+        return -1;
+    }
+    if (gsensor_io_ctl(GSENSOR_SET_FIFO_WTM, &watermark) < 0) {
+        log_info("not support fifo watermark");
+        return -1;
+    }
+    fifo_watermark = watermark;
+    sys_event_table_register(SYS_DEVICE_EVENT, DEVICE_EVENT_FROM_GSENSOR, 0, gsensor_fifo_event_handler);
+    fifo_irq_last = gsensor_stat.irq;
+    fifo_enable = 1;
+
+    period = watermark * 1000 / GSENSOR_ODR_HZ * 2;
+    fifo_guard_timer = sys_slack_timer_add(NULL, gsensor_fifo_guard, period, GSENSOR_GUARD_SLACK);
+
+    //开启前INT可能已经是高电平, 不会再有边沿, 先读空一次
+    gsensor_fifo_read();
+    log_info("fifo mode start, watermark %d", watermark);
+    return 0;
+}
+
+void gsensor_fifo_mode_stop(void)
+{
+    u8 watermark = 0;
+
+    if (!fifo_enable) {
+        return;
+    }
+    fifo_enable = 0;
+    if (fifo_guard_timer) {
+        sys_slack_timer_del(fifo_guard_timer);
+        fifo_guard_timer = 0;
+    }
+    sys_event_table_unregister(gsensor_fifo_event_handler);
+    gsensor_io_ctl(GSENSOR_SET_FIFO_WTM, &watermark);
+}
+
+u8 gsensor_fifo_mode_is_on(void)
+{
+    return fifo_enable;
+}
+
+void gsensor_stat_dump(void)
+{
+    struct gsensor_stat s;
+    struct gsensor_feature f;
+
+    local_irq_disable();
+    memcpy(&s, &gsensor_stat, sizeof(s));
+    local_irq_enable();
+    gsensor_feature_get(&f, 0);
+
+    printf("gsensor: fifo %d, watermark %d, irq %d, guard %d\n", fifo_enable, fifo_watermark, s.irq, s.guard);
+    printf("gsensor: read %d, sample %d (avg %d/read), empty %d, full %d\n",
+           s.read, s.sample, s.read ? s.sample / s.read : 0, s.empty, s.full);
+    printf("gsensor: active %d, moved %d, tilt %d, free_fall %d, step %d, activity %d mg\n",
+           f.active, f.moved, f.tilt, f.free_fall, f.step, f.activity);
+}
+
+#endif
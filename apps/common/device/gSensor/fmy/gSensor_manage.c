@@ -72,6 +72,10 @@ int get_gSensor_data(short *buf)
 {
     axis_info_t accel_data[32];
     int axis_info_len = gSensor_hdl->gravity_sensor_ctl(READ_GSENSOR_DATA, accel_data);
+    if (axis_info_len < 0) {
+        return 0;
+    }
+    gsensor_feature_update(accel_data, axis_info_len);
     for (int i = 0; i < axis_info_len; i++) {
         buf[i * 3] = accel_data[i].x;
         buf[i * 3 + 1] = accel_data[i].y;
@@ -80,6 +84,53 @@ int get_gSensor_data(short *buf)
     return axis_info_len;
 }
 
+#if CONFIG_IIC_QUEUE_ENABLE
+/*
+ * 通过iic传输队列访问, 总线互斥由队列保证, 读写期间不关中断
+ * 各驱动的从机地址固定, 地址变化时才重新打开client
+ */
+static iic_client_t gsensor_client;
+static u8 gsensor_client_addr;
+
+static iic_client_t gsensor_iic_client(u8 chip_id)
+{
+    u8 addr = chip_id >> 1;
+
+    if (gsensor_client && gsensor_client_addr == addr) {
+        return gsensor_client;
+    }
+    if (gsensor_client) {
+        iic_client_close(gsensor_client);
+    }
+    gsensor_client = iic_client_open("gsensor",
+                                     TCFG_GSENOR_USER_IIC_TYPE ? IIC_QUEUE_BUS_HW : IIC_QUEUE_BUS_SOFT,
+                                     gSensor_info->iic_hdl, addr, gSensor_info->iic_delay);
+    gsensor_client_addr = addr;
+    return gsensor_client;
+}
+
+u8 gravity_sensor_command(u8 w_chip_id, u8 register_address, u8 function_command)
+{
+    if (iic_reg_write(gsensor_iic_client(w_chip_id), register_address, function_command)) {
+        log_info("\n gsen iic wr err");
+        return 0;
+    }
+    return 1;
+}
+
+u8 _gravity_sensor_get_ndata(u8 r_chip_id, u8 register_address, u8 *buf, u8 data_len)
+{
+    int ret = iic_reg_read(gsensor_iic_client(r_chip_id), register_address, buf, data_len);
+
+    if (ret != data_len) {
+        log_info("\n gsen iic rd err %d", ret);
+        return 0;
+    }
+    return data_len;
+}
+
+#else
+
 u8 gravity_sensor_command(u8 w_chip_id, u8 register_address, u8 function_command)
 {
     spin_lock(&sensor_iic);
@@ -142,14 +193,11 @@ u8 _gravity_sensor_get_ndata(u8 r_chip_id, u8 register_address, u8 *buf, u8 data
 
     delay(gSensor_info->iic_delay);
 
-    for (; data_len > 1; data_len--) {
-        *buf++ = iic_rx_byte(gSensor_info->iic_hdl, 1);
-        read_len ++;
+    //整段连续读出(FIFO数据一次读完), 最后1byte回nack
+    if (iic_read_buf(gSensor_info->iic_hdl, buf, data_len) == data_len) {
+        read_len = data_len;
     }
 
-    *buf = iic_rx_byte(gSensor_info->iic_hdl, 0);
-    read_len ++;
-
 __gdend:
 
     iic_stop(gSensor_info->iic_hdl);
@@ -158,10 +206,14 @@ __gdend:
 
     return read_len;
 }
+#endif
 
-void gsensor_io_ctl(u8 cmd, void *arg)
+int gsensor_io_ctl(u8 cmd, void *arg)
 {
-    gSensor_hdl->gravity_sensor_ctl(cmd, arg);
+    if (gSensor_info->init_flag != 1) {
+        return -1;
+    }
+    return gSensor_hdl->gravity_sensor_ctl(cmd, arg);
 }
 
 int gravity_sensor_init(void *_data)
@@ -5,6 +5,7 @@
 //#include "iic.h"
 #include "asm/iic_hw.h"
 #include "asm/iic_soft.h"
+#include "asm/iic_queue.h"
 #include "timer.h"
 #include "app_config.h"
 #include "event.h"
@@ -21,6 +22,7 @@ enum {
     READ_GSENSOR_DATA,
     GET_ACCEL_DATA,
     SEARCH_SENSOR,
+    GSENSOR_SET_FIFO_WTM,       //arg:u8 *, FIFO水位(组), 0:关闭水位中断; 返回<0:不支持
 };
 
 typedef struct {
@@ -54,9 +56,34 @@ typedef struct {
 
 int gravity_sensor_init(void *_data);
 int gsensor_disable(void);
+int gsensor_io_ctl(u8 cmd, void *arg);
 u8 gravity_sensor_command(u8 w_chip_id, u8 register_address, u8 function_command);
 u8 _gravity_sensor_get_ndata(u8 r_chip_id, u8 register_address, u8 *buf, u8 data_len);
 int get_gSensor_data(short *buf);
+
+/*
+ * FIFO水位中断模式 + 运动特征
+ * INT脚接到唤醒口, 传感器攒够watermark组数据才拉中断, 中断里只投递事件,
+ * 在app_core中一次IIC连续读出整个FIFO, 并逐点更新下面的特征.
+ * 不开FIFO模式时, get_gSensor_data()读到的数据同样会更新特征.
+ */
+struct gsensor_feature {
+    u8  active;         //当前是否处于运动状态
+    u8  moved;          //自上次取走以来是否运动过
+    u8  tilt;           //自上次取走以来是否相对上次静止时的方向倾斜超过30度
+    u8  free_fall;      //自上次取走以来是否检测到失重
+    u32 step;           //累计步数
+    u16 activity;       //动态加速度(去掉重力)的平滑值, 单位: mg
+};
+
+void gsensor_feature_reset(void);
+void gsensor_feature_update(const axis_info_t *accel, int num);
+void gsensor_feature_get(struct gsensor_feature *f, u8 clear);
+int gsensor_fifo_mode_start(u8 watermark);
+void gsensor_fifo_mode_stop(void);
+u8 gsensor_fifo_mode_is_on(void);
+void gsensor_int_isr(void);
+void gsensor_stat_dump(void);
 extern G_SENSOR_INTERFACE  gsensor_dev_begin[];
 extern G_SENSOR_INTERFACE gsensor_dev_end[];
 
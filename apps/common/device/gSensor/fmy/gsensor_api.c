@@ -33,9 +33,24 @@
 #define GSENSOR_NAME "msa310"
 #endif
 
+// 配置了INT脚时使用FIFO水位中断模式, 运动检测直接取特征, 不再定时读IIC
+#if defined(TCFG_GSENSOR_INT_PORT) && (TCFG_GSENSOR_INT_PORT != NO_CONFIG_PORT)
+#define GSENSOR_FIFO_MODE_EN        1
+#else
+#define GSENSOR_FIFO_MODE_EN        0
+#endif
+
+#ifndef TCFG_GSENSOR_FIFO_WTM
+#define TCFG_GSENSOR_FIFO_WTM       25
+#endif
+
 GSENSOR_PLATFORM_DATA_BEGIN(gSensor_data)
 .iic = 0,
+#if GSENSOR_FIFO_MODE_EN
+ .gSensor_int_io = TCFG_GSENSOR_INT_PORT,
+#else
  .gSensor_int_io = -1,
+#endif
   .gSensor_name = GSENSOR_NAME,
    GSENSOR_PLATFORM_DATA_END();
 
@@ -56,6 +71,12 @@ int sensor_data_get(short *buf)
 bool sensor_motion_detection(void)
 {
     log_info("run motion detection task!");
+    if (gsensor_fifo_mode_is_on()) {
+        struct gsensor_feature feature;
+        gsensor_feature_get(&feature, 1);
+        log_info("moved %d, step %d, activity %d mg", feature.moved, feature.step, feature.activity);
+        return feature.moved;
+    }
     axis_info_t axis_buffer[32] = {0};
     int data_len = sensor_data_get(axis_buffer);
     char flag = run_MotionDetection(workbuf, data_len, axis_buffer);
@@ -76,6 +97,12 @@ int sensor_init(void)
     PORT_IO_OUPUT(GSENSOR_POWER_IO, PORT_VALUE_HIGH);
 #endif
     int ret = gravity_sensor_init((struct gsensor_platform_data *)&gSensor_data);
+    gsensor_feature_reset();
+#if GSENSOR_FIFO_MODE_EN
+    if (ret == 0) {
+        gsensor_fifo_mode_start(TCFG_GSENSOR_FIFO_WTM);
+    }
+#endif
 
     int buff_size = get_DetectionBuf(fs);
     workbuf = (char *)malloc(buff_size);
@@ -98,6 +125,7 @@ int sensor_deinit(void)
         return 0;
     }
 
+    gsensor_fifo_mode_stop();
     int ret = gsensor_disable();
 
     free(workbuf);
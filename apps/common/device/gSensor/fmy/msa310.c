@@ -23,6 +23,7 @@ u8 sensor_iic_init_status = 0;
 #define MSA310_R_ADDR (0x62 << 1 | 0x1)
 
 uint8_t msa_id = 0;
+static uint8_t msa_fifo_wtm = 0; // 0:不使用FIFO水位中断
 
 /*return value: 0: is ok    -1:read is failed*/
 int32_t msa_register_read(uint8_t addr, uint8_t *data)
@@ -51,16 +52,11 @@ int32_t msa_register_write(uint8_t addr, uint8_t data)
 // return:0:ok,  -1:err
 int32_t msa_register_read_continuously(uint8_t addr, uint8_t count, uint8_t *data)
 {
-    int32_t res = 0;
-    int32_t i = 0;
-
-    for (i = 0; i < count; i++) {
-        res = msa_register_read(addr + i, data + i);
-        if (res) {
-            return res;
-        }
+    // 寄存器地址自增, 一次连续读出
+    if (_gravity_sensor_get_ndata(MSA310_R_ADDR, addr, data, count) == count) {
+        return 0;
     }
-    return res; // ok
+    return -1;
 }
 
 // return:0:ok,  -1/-2:err
@@ -92,7 +88,12 @@ int32_t msa_read_fifo(axis_info_t *raw_accel)
         data_count = 32;
     }
     /* log_info("data_count = %d \r\n",data_count); */
-    _gravity_sensor_get_ndata(MSA310_R_ADDR, 0xff, temp_buf, data_count * 6); // return:0:err,  acc_count*6:ok
+    if (data_count == 0) {
+        return 0;
+    }
+    if (_gravity_sensor_get_ndata(MSA310_R_ADDR, 0xff, temp_buf, data_count * 6) != data_count * 6) { // return:0:err,  acc_count*6:ok
+        return 0;
+    }
 
     for (u8 i = 0; i < data_count; i++) {
         raw_accel[i].x = ((short)(temp_buf[i * 6 + 1] << 8 | temp_buf[i * 6 + 0])) >> 4;
@@ -104,6 +105,7 @@ int32_t msa_read_fifo(axis_info_t *raw_accel)
 }
 
 extern void msa_param_init(void);
+static int32_t msa310_fifo_wtm_set(uint8_t wtm);
 /*return value: 0: is ok    other: is failed*/
 uint8_t msa310_init(void)
 {
@@ -142,8 +144,27 @@ uint8_t msa310_init(void)
 
     msa_param_init();
 
+    // 复位后水位中断配置丢失, 需要重新配置
+    if (msa_fifo_wtm) {
+        res |= msa310_fifo_wtm_set(msa_fifo_wtm);
+    }
+
     return res;
 }
+// wtm:FIFO水位(1~32), INT1在FIFO数据达到水位时输出高电平; 0:恢复默认配置(水位32, INT1低电平有效)
+static int32_t msa310_fifo_wtm_set(uint8_t wtm)
+{
+    int32_t res = 0;
+
+    if (wtm > 32) {
+        wtm = 32;
+    }
+    msa_fifo_wtm = wtm;
+    res |= msa_register_mask_write(MSA_REG_FIFO_CTRL, 0x3F, wtm ? wtm : 0x20);
+    res |= msa_register_mask_write(MSA_REG_INT_PIN_CONFIG, 0x01, wtm ? 0x01 : 0x00);
+    return res;
+}
+
 /*return value: 0: is ok    other: is failed*/
 uint8_t msa310_stop(void)
 {
@@ -200,6 +221,9 @@ int msa310_ctl(u8 cmd, void *arg)
         res = msa310_check();
         memcpy(arg, &res, 1);
         break;
+    case GSENSOR_SET_FIFO_WTM:
+        res = msa310_fifo_wtm_set(*(u8 *)arg);
+        break;
     default:
 
         break;
@@ -41,11 +41,45 @@
 #endif
 #endif
 
-static volatile u8 is_key_active = 0;
 static volatile u8 key_poweron_flag = 0;
 
 extern u32 timer_get_ms(void);
 
+//已注册的按键源
+static struct key_driver_para *key_source[KEY_DRIVER_TYPE_MAX];
+static u8 key_source_num = 0;
+
+//=======================================================//
+// 连击事件表: 第N击抬起后等待下一击的时间, 等待结束发出对应事件
+// wait: 等待的扫描次数, KEY_CLICK_WAIT_DEFAULT表示使用按键源的click_delay_time,
+//       0表示不再支持更多连击, 抬起后直接发出
+//=======================================================//
+#define KEY_CLICK_WAIT_DEFAULT      0xff
+
+struct key_click_map {
+    u8 event;
+    u8 wait;
+};
+
+static const struct key_click_map key_click_table[] = {
+    { KEY_EVENT_CLICK,          KEY_CLICK_WAIT_DEFAULT },
+    { KEY_EVENT_DOUBLE_CLICK,   KEY_CLICK_WAIT_DEFAULT },
+    { KEY_EVENT_TRIPLE_CLICK,   KEY_CLICK_WAIT_DEFAULT },
+    { KEY_EVENT_FOURTH_CLICK,   KEY_CLICK_WAIT_DEFAULT },
+    { KEY_EVENT_FIRTH_CLICK,    0 },
+};
+
+static const struct key_click_map *key_click_map_get(u8 click_cnt)
+{
+    if (click_cnt > ARRAY_SIZE(key_click_table)) {
+        click_cnt = ARRAY_SIZE(key_click_table);
+    }
+    return &key_click_table[click_cnt - 1];
+}
+
+static void key_driver_scan(void *_scan_para);
+static void key_driver_latency_update(struct key_driver_para *scan_para);
+
 //=======================================================//
 // 按键值重新映射函数:
 // 用户可以实现该函数把一些按键值重新映射, 可用于组合键的键值重新映射
@@ -128,15 +162,14 @@ void save_wakeup_key_notify(struct sys_event *event)
 #endif
 
 //=======================================================//
-// 按键扫描函数: 扫描所有注册的按键驱动
+// 按键状态机: 所有按键源的采样值都在这里做消抖和单击/连击/长按/HOLD判断
 //=======================================================//
-static void key_driver_scan(void *_scan_para)
+static void key_driver_process(struct key_driver_para *scan_para, u8 cur_key_value)
 {
-    struct key_driver_para *scan_para = (struct key_driver_para *)_scan_para;
-
     u8 key_event = 0;
-    u8 cur_key_value = NO_KEY;
     u8 key_value = 0;
+    const struct key_click_map *click;
+    u8 click_wait;
     struct sys_event e;
     static u8 poweron_cnt = 0;
 
@@ -146,7 +179,6 @@ static void key_driver_scan(void *_scan_para)
     /*     return; */
     /* } */
 
-    cur_key_value = scan_para->get_value();
     /* if (cur_key_value != NO_KEY) { */
     /*     printf(">>>cur_key_value: %d\n", cur_key_value); */
     /* } */
@@ -190,11 +222,6 @@ static void key_driver_scan(void *_scan_para)
     }
 #endif
 
-    if (cur_key_value != NO_KEY) {
-        is_key_active = 35;      //35*10Ms
-    } else if (is_key_active) {
-        is_key_active --;
-    }
 //===== 按键消抖处理
     if (cur_key_value != scan_para->filter_value && scan_para->filter_time) {	//当前按键值与上一次按键值如果不相等, 重新消抖处理, 注意filter_time != 0;
         scan_para->filter_cnt = 0; 		//消抖次数清0, 重新开始消抖
@@ -269,19 +296,11 @@ static void key_driver_scan(void *_scan_para)
                     goto _notify;
                 }
 #endif
-                if (scan_para->click_delay_cnt > scan_para->click_delay_time) { //按键被抬起后延时到
-                    //TODO: 在此可以添加任意多击事件
-                    if (scan_para->click_cnt >= 5) {
-                        key_event = KEY_EVENT_FIRTH_CLICK;  //五击
-                    } else if (scan_para->click_cnt >= 4) {
-                        key_event = KEY_EVENT_FOURTH_CLICK;  //4击
-                    } else if (scan_para->click_cnt >= 3) {
-                        key_event = KEY_EVENT_TRIPLE_CLICK;  //三击
-                    } else if (scan_para->click_cnt >= 2) {
-                        key_event = KEY_EVENT_DOUBLE_CLICK;  //双击
-                    } else {
-                        key_event = KEY_EVENT_CLICK;  //单击
-                    }
+                //多击事件及其等待时间见key_click_table
+                click = key_click_map_get(scan_para->click_cnt);
+                click_wait = (click->wait == KEY_CLICK_WAIT_DEFAULT) ? scan_para->click_delay_time : click->wait;
+                if (scan_para->click_delay_cnt > click_wait) { //按键被抬起后延时到
+                    key_event = click->event;
                     key_value = scan_para->notify_value;
                     goto _notify;
                 } else {	//按键抬起后等待下次延时时间未到
@@ -340,6 +359,7 @@ _notify:
         return;
     }
     if (key_event_remap(&e)) {
+        key_driver_latency_update(scan_para);
 #if TCFG_SOFTOFF_WAKEUP_KEY_DRIVER_ENABLE
         if (key_wk_send_flag) {
             sys_event_notify(&e);
@@ -361,15 +381,173 @@ _scan_end:
 }
 
 
+//=======================================================//
+// 调度: 有按键按下/消抖中/等待连击时按scan_time扫描,
+// 空闲后按idle_scan_time扫描或停止扫描, 由边沿唤醒重新开始
+//=======================================================//
+static u8 key_driver_is_active(struct key_driver_para *scan_para, u8 cur_key_value)
+{
+    if (cur_key_value != NO_KEY || scan_para->last_key != NO_KEY || scan_para->click_cnt) {
+        return 1;
+    }
+    if (scan_para->filter_time && scan_para->filter_value != NO_KEY) {
+        return 1;
+    }
+    return 0;
+}
+
+static void key_driver_schedule(struct key_driver_para *scan_para, u8 active)
+{
+    u16 idle_time = scan_para->idle_scan_time ? scan_para->idle_scan_time : scan_para->scan_time;
+
+    if (active == scan_para->active) {
+        return;
+    }
+    scan_para->active = active;
+    if (!active) {
+        scan_para->press_ms = 0;
+    }
+    if (idle_time == scan_para->scan_time) {
+        return;     //空闲与按下时扫描周期相同, 定时器不变
+    }
+
+    if (active) {
+        if (scan_para->timer) {
+            sys_s_hi_timer_modify(scan_para->timer, scan_para->scan_time);
+        } else {
+            scan_para->timer = sys_s_hi_timer_add((void *)scan_para, key_driver_scan, scan_para->scan_time);
+        }
+    } else if (idle_time == KEY_SCAN_IDLE_STOP) {
+        sys_s_hi_timer_del(scan_para->timer);
+        scan_para->timer = 0;
+    } else {
+        sys_s_hi_timer_modify(scan_para->timer, idle_time);
+    }
+}
+
+static void key_driver_latency_update(struct key_driver_para *scan_para)
+{
+    u32 latency;
+
+    scan_para->stat.notify++;
+    if (!scan_para->press_ms) {
+        return;
+    }
+    latency = timer_get_ms() - scan_para->press_ms;
+    scan_para->stat.last_latency = latency;
+    if (latency > scan_para->stat.max_latency) {
+        scan_para->stat.max_latency = latency;
+    }
+    scan_para->press_ms = 0;
+}
+
+//=======================================================//
+// 按键扫描函数: 按键源的定时采样入口
+//=======================================================//
+static void key_driver_scan(void *_scan_para)
+{
+    struct key_driver_para *scan_para = (struct key_driver_para *)_scan_para;
+    u8 cur_key_value = scan_para->get_value();
+    u8 active;
+
+    scan_para->stat.scan++;
+    //新的一次按下, 记录按下时间(边沿唤醒时已记录的更早)
+    if (cur_key_value != NO_KEY && scan_para->last_key == NO_KEY && !scan_para->press_ms) {
+        scan_para->press_ms = timer_get_ms();
+    }
+
+    key_driver_process(scan_para, cur_key_value);
+
+    local_irq_disable();
+    //边沿唤醒后至少按scan_time扫一轮, 由这一轮的采样决定是否回到空闲
+    active = key_driver_is_active(scan_para, cur_key_value) || scan_para->wake_pending;
+    scan_para->wake_pending = 0;
+    key_driver_schedule(scan_para, active);
+    local_irq_enable();
+}
+
+#if (TCFG_IOKEY_ENABLE || TCFG_ADKEY_ENABLE || TCFG_TOUCH_KEY_ENABLE)
+//停止扫描(KEY_SCAN_IDLE_STOP)的按键源没有定时器, 唤醒后在app_core里重新添加
+static void key_driver_wake_resume(void)
+{
+    struct key_driver_para *scan_para;
+    u8 i;
+
+    local_irq_disable();
+    for (i = 0; i < key_source_num; i++) {
+        scan_para = key_source[i];
+        if (scan_para->wake_pending && !scan_para->timer) {
+            scan_para->wake_pending = 0;
+            key_driver_schedule(scan_para, 1);
+        }
+    }
+    local_irq_enable();
+}
+#endif
+
+int key_driver_register(struct key_driver_para *scan_para)
+{
+    if (key_source_num >= ARRAY_SIZE(key_source)) {
+        log_error("key source full, type %d", scan_para->key_type);
+        return -1;
+    }
+    key_source[key_source_num++] = scan_para;
+
+    //先按scan_time扫描, 确认没有按键后再进入空闲
+    scan_para->active = 1;
+    scan_para->timer = sys_s_hi_timer_add((void *)scan_para, key_driver_scan, scan_para->scan_time); //注册按键扫描定时器
+    return 0;
+}
+
 //wakeup callback
+//由唤醒中断调用, 不能操作定时器: 只记录唤醒, 切换扫描周期交给扫描定时器
 void key_active_set(u8 port)
 {
     /*要用按键宏包住，不用按键功能，唤醒后就再也不进睡眠*/
 #if (TCFG_IOKEY_ENABLE || TCFG_ADKEY_ENABLE || TCFG_TOUCH_KEY_ENABLE)
-    is_key_active = 35;      //35*10Ms
+    struct key_driver_para *scan_para;
+    u32 now = timer_get_ms();
+    u8 stopped = 0;
+    u8 i;
+    int argv[2];
+
+    //唤醒口不能区分按键源, 所有按键源都标记
+    local_irq_disable();
+    for (i = 0; i < key_source_num; i++) {
+        scan_para = key_source[i];
+        scan_para->stat.wakeup++;
+        if (!scan_para->press_ms) {
+            scan_para->press_ms = now;
+        }
+        scan_para->wake_pending = 1;
+        if (!scan_para->timer) {
+            stopped = 1;
+        }
+    }
+    local_irq_enable();
+
+    if (stopped) {
+        argv[0] = (int)key_driver_wake_resume;
+        argv[1] = 0;
+        os_taskq_post_type("app_core", Q_CALLBACK, 2, argv);
+    }
 #endif
 }
 
+void key_driver_stat_dump(void)
+{
+    struct key_driver_para *scan_para;
+    u8 i;
+
+    for (i = 0; i < key_source_num; i++) {
+        scan_para = key_source[i];
+        log_info("type %d: scan %d, wakeup %d, notify %d, latency %d/%d(max) ms, %s",
+                 scan_para->key_type, scan_para->stat.scan, scan_para->stat.wakeup,
+                 scan_para->stat.notify, scan_para->stat.last_latency,
+                 scan_para->stat.max_latency, scan_para->active ? "active" : "idle");
+    }
+}
+
 //=======================================================//
 // 按键初始化函数: 初始化所有注册的按键驱动
 //=======================================================//
@@ -384,11 +562,11 @@ int key_driver_init(void)
 #ifdef TCFG_IOKEY_TIME_REDEFINE
     extern struct key_driver_para iokey_scan_user_para;
     if (err == 0) {
-        sys_s_hi_timer_add((void *)&iokey_scan_user_para, key_driver_scan, iokey_scan_user_para.scan_time); //注册按键扫描定时器
+        key_driver_register(&iokey_scan_user_para);
     }
 #else
     if (err == 0) {
-        sys_s_hi_timer_add((void *)&iokey_scan_para, key_driver_scan, iokey_scan_para.scan_time); //注册按键扫描定时器
+        key_driver_register(&iokey_scan_para);
     }
 #endif
 #endif
@@ -400,14 +578,14 @@ int key_driver_init(void)
     extern struct key_driver_para multi_adkey_scan_para;
     err = multi_adkey_init(multi_adkey_data);
     if (err == 0) {
-        sys_s_hi_timer_add((void *)&multi_adkey_scan_para, key_driver_scan, multi_adkey_scan_para.scan_time); //注册按键扫描定时器
+        key_driver_register(&multi_adkey_scan_para);
     }
 #else
     extern const struct adkey_platform_data adkey_data;
     extern struct key_driver_para adkey_scan_para;
     err = adkey_init(&adkey_data);
     if (err == 0) {
-        sys_s_hi_timer_add((void *)&adkey_scan_para, key_driver_scan, adkey_scan_para.scan_time); //注册按键扫描定时器
+        key_driver_register(&adkey_scan_para);
     }
 #endif
 #endif
@@ -417,7 +595,7 @@ int key_driver_init(void)
     extern struct key_driver_para irkey_scan_para;
     err = irkey_init(&irkey_data);
     if (err == 0) {
-        sys_s_hi_timer_add((void *)&irkey_scan_para, key_driver_scan, irkey_scan_para.scan_time); //注册按键扫描定时器
+        key_driver_register(&irkey_scan_para);
     }
 #endif
 
@@ -426,7 +604,7 @@ int key_driver_init(void)
     extern struct key_driver_para touch_key_scan_para;
     err = touch_key_init(&touch_key_data);
     if (err == 0) {
-        sys_s_hi_timer_add((void *)&touch_key_scan_para, key_driver_scan, touch_key_scan_para.scan_time); //注册按键扫描定时器
+        key_driver_register(&touch_key_scan_para);
     }
 #endif
 
@@ -435,7 +613,7 @@ int key_driver_init(void)
     extern struct key_driver_para adkey_rtcvdd_scan_para;
     err = adkey_rtcvdd_init(&adkey_rtcvdd_data);
     if (err == 0) {
-        sys_s_hi_timer_add((void *)&adkey_rtcvdd_scan_para, key_driver_scan, adkey_rtcvdd_scan_para.scan_time); //注册按键扫描定时器
+        key_driver_register(&adkey_rtcvdd_scan_para);
     }
 #endif
 
@@ -444,7 +622,7 @@ int key_driver_init(void)
     extern struct key_driver_para rdec_key_scan_para;
     err = rdec_key_init(&rdec_key_data);
     if (err == 0) {
-        sys_s_hi_timer_add((void *)&rdec_key_scan_para, key_driver_scan, rdec_key_scan_para.scan_time); //注册按键扫描定时器
+        key_driver_register(&rdec_key_scan_para);
     }
 #endif
 
@@ -455,7 +633,7 @@ int key_driver_init(void)
     extern int ctmu_touch_key_init(const struct ctmu_touch_key_platform_data * ctmu_touch_key_data);
     err = ctmu_touch_key_init(&ctmu_touch_key_data);
     if (err == 0) {
-        sys_s_hi_timer_add((void *)&ctmu_touch_key_scan_para, key_driver_scan, ctmu_touch_key_scan_para.scan_time); //注册按键扫描定时器
+        key_driver_register(&ctmu_touch_key_scan_para);
     }
 #endif /* #if TCFG_CTMU_TOUCH_KEY_ENABLE */
 
@@ -478,7 +656,7 @@ int key_driver_init(void)
     extern struct key_driver_para tent600_key_scan_para;
     err = tent600_key_init(&key_data);
     if (err == 0) {
-        sys_s_hi_timer_add((void *)&tent600_key_scan_para, key_driver_scan, tent600_key_scan_para.scan_time); //注册按键扫描定时器
+        key_driver_register(&tent600_key_scan_para);
     }
 #endif
 
@@ -487,7 +665,14 @@ int key_driver_init(void)
 
 static u8 key_idle_query(void)
 {
-    return !is_key_active;
+    u8 i;
+
+    for (i = 0; i < key_source_num; i++) {
+        if (key_source[i]->active || key_source[i]->wake_pending) {
+            return 0;
+        }
+    }
+    return 1;
 }
 #if ((!TCFG_LP_TOUCH_KEY_ENABLE) && (TCFG_IOKEY_ENABLE || TCFG_ADKEY_ENABLE))
 REGISTER_LP_TARGET(key_lp_target) = {
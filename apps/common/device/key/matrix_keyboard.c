@@ -6,6 +6,7 @@
 #include "timer.h"
 #include "asm/power_interface.h"
 #include "asm/power/p33.h"
+#include "generic/dlog.h"
 
 #if TCFG_MATRIX_KEY_ENABLE && !TCFG_EX_MCU_ENABLE
 #define MATRIX_NO_KEY           0x1         //没有按键时的IO电平
@@ -69,6 +70,7 @@ void full_key_map(u8 row, u8 col, u8 st)
 
 void P33_AND_WKUP_EDGE(u8 data);
 void P33_OR_WKUP_EDGE(u8 data);
+void port_edge_wakeup_control(u16 data);
 
 enum {
     IO_STATUS_HIGH_DRIVER = 0,
@@ -80,175 +82,298 @@ enum {
 
 void matrix_key_set_io_state(u8 state, u32 *io_table, u8 len)
 {
-    u8 i = 0;
-    u32 porta_value = 0;
-    u32 portb_value = 0;
-    u32 portc_value = 0;
-    u32 portd_value = 0;
-
-    for (; i < len; i++) {
-        switch (io_table[i] / IO_GROUP_NUM) {
-        case 0: //JL_PORTA
-            porta_value |= BIT(io_table[i] % IO_GROUP_NUM);
+    struct gpio_reg *reg;
+    u32 mask;
+    u8 i;
+
+    //按gpio2reg取寄存器组, 与芯片的port编号一致(bd19的第3组是PORTD)
+    for (i = 0; i < len; i++) {
+        reg = gpio2reg(io_table[i]);
+        if (!reg) {
+            continue;
+        }
+        mask = BIT(io_table[i] % IO_GROUP_NUM);
+        switch (state) {
+        case IO_STATUS_HIGH_DRIVER:
+            reg->dir |= mask;
+            reg->die |= mask;
+            reg->pu &= ~mask;
+            reg->pd &= ~mask;
             break;
-        case 1: //JL_PORTB
-            portb_value |= BIT(io_table[i] % IO_GROUP_NUM);
+        case IO_STATUS_OUTPUT_HIGH:
+            reg->out |= mask;
+            reg->dir &= ~mask;
             break;
-        case 2: //JL_PORTC
-            portc_value |= BIT(io_table[i] % IO_GROUP_NUM);
+        case IO_STATUS_OUTPUT_LOW:
+            reg->out &= ~mask;
+            reg->dir &= ~mask;
             break;
-        case 3: //JL_PORTD
-            portd_value |= BIT(io_table[i] % IO_GROUP_NUM);
+        case IO_STATUS_INPUT_PULL_DOWN:
+            reg->dir |= mask;
+            reg->die |= mask;
+            reg->pu &= ~mask;
+            reg->pd |= mask;
             break;
-        default://USB
+        case IO_STATUS_INPUT_PULL_UP:
+            reg->dir |= mask;
+            reg->die |= mask;
+            reg->pu |= mask;
+            reg->pd &= ~mask;
+            break;
+        }
+    }
+}
+
+/*
+ * 整组port扫描
+ *
+ * init时把row/col脚换算成 寄存器组 + 掩码, 扫描时每一列只改一次该列的DIR,
+ * 每组port的IN只读一次, 再按预先算好的bit位置拼成row位图(row在同一组且连续时直接移位).
+ * 按键状态按列保存为row位图(即key_map), 去抖/鬼键判断都按位并行处理.
+ * 没有按键时停掉扫描定时器, 所有列输出有效电平, 由row的边沿唤醒重新开始扫描.
+ */
+#define MATRIX_KEY_SCAN_TIME    10      //扫描周期, 单位：毫秒
+#define MATRIX_KEY_SETTLE_TIME  2       //切换列之后等待行线稳定的delay()参数, 按走线电容调整
+#define MATRIX_PORT_MAX         4
+
+struct matrix_port {
+    struct gpio_reg *reg;
+    u32 mask;
+};
+
+struct matrix_scan {
+    struct matrix_port row_port[MATRIX_PORT_MAX];
+    struct matrix_port col_port[MATRIX_PORT_MAX];
+    struct matrix_port col[COL_MAX];
+    u8 row_port_num;
+    u8 col_port_num;
+    u8 row_idx[ROW_MAX];        //row所在的row_port序号
+    u8 row_bit[ROW_MAX];        //row在port中的bit位置
+    u8 row_shift;               //row在同一组且连续时的移位量, 0xff表示需要逐个拼
+    u8 row_all;                 //全部row的位图
+    u8 raw[COL_MAX];            //上一次的采样
+};
+
+static struct matrix_scan scan;
+static struct matrix_key_stat matrix_stat;
+
+static inline u32 matrix_key_tick_diff(u32 begin, u32 end)
+{
+    return end >= begin ? end - begin : end + TICK_PRD - begin;
+}
 
+static u8 matrix_port_add(struct matrix_port *port, u8 *num, u32 gpio)
+{
+    struct gpio_reg *reg = gpio2reg(gpio);
+    u8 i;
+
+    for (i = 0; i < *num; i++) {
+        if (port[i].reg == reg) {
             break;
         }
     }
-    switch (state) {
-    case IO_STATUS_HIGH_DRIVER:
-        JL_PORTA->DIR |= porta_value;
-        JL_PORTA->DIE |= porta_value;
-        JL_PORTA->PU &= ~porta_value;
-        JL_PORTA->PD &= ~porta_value;
-        JL_PORTB->DIR |= portb_value;
-        JL_PORTB->DIE |= portb_value;
-        JL_PORTB->PU &= ~portb_value;
-        JL_PORTB->PD &= ~portb_value;
-        JL_PORTC->DIR |= portc_value;
-        JL_PORTC->DIE |= portc_value;
-        JL_PORTC->PU &= ~portc_value;
-        JL_PORTC->PD &= ~portc_value;
-        JL_PORTD->DIR |= portd_value;
-        JL_PORTD->DIE |= portd_value;
-        JL_PORTD->PU &= ~portd_value;
-        JL_PORTD->PD &= ~portd_value;
-        break;
-    case IO_STATUS_OUTPUT_HIGH:
-        JL_PORTA->DIR &= ~porta_value;
-        JL_PORTA->OUT |= porta_value;
-        JL_PORTB->DIR &= ~portb_value;
-        JL_PORTB->OUT |= portb_value;
-        JL_PORTC->DIR &= ~portc_value;
-        JL_PORTC->OUT |= portc_value;
-        JL_PORTD->DIR &= ~portd_value;
-        JL_PORTD->OUT |= portd_value;
-        break;
-    case IO_STATUS_OUTPUT_LOW:
-        JL_PORTA->DIR &= ~porta_value;
-        JL_PORTA->OUT &= ~porta_value;
-        JL_PORTB->DIR &= ~portb_value;
-        JL_PORTB->OUT &= ~portb_value;
-        JL_PORTC->DIR &= ~portc_value;
-        JL_PORTC->OUT &= ~portc_value;
-        JL_PORTD->DIR &= ~portd_value;
-        JL_PORTD->OUT &= ~portd_value;
-        break;
-    case IO_STATUS_INPUT_PULL_DOWN:
-        JL_PORTA->DIR |= porta_value;
-        JL_PORTA->DIE |= porta_value;
-        JL_PORTA->PU  &= ~porta_value;
-        JL_PORTA->PD  |= porta_value;
-        JL_PORTB->DIR |= portb_value;
-        JL_PORTB->DIE |= portb_value;
-        JL_PORTB->PU  &= ~portb_value;
-        JL_PORTB->PD  |= portb_value;
-        JL_PORTC->DIR |= portc_value;
-        JL_PORTC->DIE |= portc_value;
-        JL_PORTC->PU  &= ~portc_value;
-        JL_PORTC->PD  |= portc_value;
-        JL_PORTD->DIR |= portd_value;
-        JL_PORTD->DIE |= portd_value;
-        JL_PORTD->PU  &= ~portd_value;
-        JL_PORTD->PD  |= portd_value;
-        break;
-    case IO_STATUS_INPUT_PULL_UP:
-        JL_PORTA->DIR |= porta_value;
-        JL_PORTA->DIE |= porta_value;
-        JL_PORTA->PU  |= porta_value;
-        JL_PORTA->PD  &= ~porta_value;
-        JL_PORTB->DIR |= portb_value;
-        JL_PORTB->DIE |= portb_value;
-        JL_PORTB->PU  |= portb_value;
-        JL_PORTB->PD  &= ~portb_value;
-        JL_PORTC->DIR |= portc_value;
-        JL_PORTC->DIE |= portc_value;
-        JL_PORTC->PU  |= portc_value;
-        JL_PORTC->PD  &= ~portc_value;
-        JL_PORTD->DIR |= portd_value;
-        JL_PORTD->DIE |= portd_value;
-        JL_PORTD->PU  |= portd_value;
-        JL_PORTD->PD  &= ~portd_value;
-        break;
+    if (i == *num) {
+        ASSERT(i < MATRIX_PORT_MAX);
+        port[i].reg = reg;
+        port[i].mask = 0;
+        (*num)++;
     }
+    port[i].mask |= BIT(gpio % IO_GROUP_NUM);
+    return i;
 }
 
-#if 1
-void port_edge_wakeup_control(u16 data);
-void matrix_key_scan(void)
+static void matrix_scan_init(void)
 {
-
     u8 row, col;
-    u8 cur_key_value = MATRIX_NO_KEY, notify = 0;
-    static u8 wk_toggle = 0;
 
-    //g_printf("scan...\n");
-    //P33_LEVEL_WKUP_EN(0);
-    port_edge_wakeup_control(0);
-    //p33_tx_1byte(P3_WKUP_EN, 0);        //关掉wakeup防止扫描过程一直唤醒
+    memset(&scan, 0, sizeof(scan));
+    for (row = 0; row < this->row_num; row++) {
+        scan.row_idx[row] = matrix_port_add(scan.row_port, &scan.row_port_num, this->row_pin_list[row]);
+        scan.row_bit[row] = this->row_pin_list[row] % IO_GROUP_NUM;
+    }
+    scan.row_all = (u8)(BIT(this->row_num) - 1);
 
-    //不直接调用gpio.c的接口主要是由于想控制扫描时间。这样能把时间从1.8ms缩减到800us
-    matrix_key_set_io_state(IO_STATUS_HIGH_DRIVER, this->col_pin_list, this->col_num);
+    scan.row_shift = 0xff;
+    if (scan.row_port_num == 1) {
+        for (row = 1; row < this->row_num; row++) {
+            if (scan.row_bit[row] != scan.row_bit[0] + row) {
+                break;
+            }
+        }
+        if (row == this->row_num) {
+            scan.row_shift = scan.row_bit[0];
+        }
+    }
 
-    is_key_active = 0;
-    for (col = 0; col < this->col_num; col ++) {
-        matrix_key_set_io_state((MATRIX_NO_KEY) ? IO_STATUS_OUTPUT_LOW : IO_STATUS_OUTPUT_HIGH, &(this->col_pin_list[col]), 1);
-        //gpio_direction_output(this->col_pin_list[col], !MATRIX_NO_KEY);
-        for (row = 0; row < this->row_num; row ++) {
-            cur_key_value = gpio_read(this->row_pin_list[row]);
-            if (cur_key_value != MATRIX_NO_KEY) {
-                is_key_active = 1;
+    for (col = 0; col < this->col_num; col++) {
+        scan.col[col].reg = gpio2reg(this->col_pin_list[col]);
+        scan.col[col].mask = BIT(this->col_pin_list[col] % IO_GROUP_NUM);
+        matrix_port_add(scan.col_port, &scan.col_port_num, this->col_pin_list[col]);
+    }
+}
+
+//读当前被驱动列上所有row, 返回按下的row位图
+static u8 matrix_key_read_rows(void)
+{
+    u32 in[MATRIX_PORT_MAX];
+    u8 value = 0;
+    u8 i;
+
+    for (i = 0; i < scan.row_port_num; i++) {
+        in[i] = scan.row_port[i].reg->in;
+    }
+    if (scan.row_shift != 0xff) {
+        value = (in[0] >> scan.row_shift) & scan.row_all;
+    } else {
+        for (i = 0; i < this->row_num; i++) {
+            if (in[scan.row_idx[i]] & BIT(scan.row_bit[i])) {
+                value |= BIT(i);
             }
-            if (cur_key_value != (key_st[row][col]).last_st) {
-                if (cur_key_value == MATRIX_NO_KEY) { //按键抬起判断
-                    (key_st[row][col]).press_cnt = 0;
-                    //printf("row:%d  col:%d   [UP]\n", row, col);
-                    (MATRIX_NO_KEY) ? P33_OR_WKUP_EDGE(row) : P33_AND_WKUP_EDGE(row);
-                    //P33_AND_WKUP_EDGE(row);
-                    full_key_map(row, col, 0);
-                    notify = 1;
-                } else {            //按键初次按下
-                    printf("row:%d  col:%d   [SHORT]\n", row, col);
-                    full_key_map(row, col, 1);
-                    (MATRIX_NO_KEY) ? P33_AND_WKUP_EDGE(row) : P33_OR_WKUP_EDGE(row);
-                    //P33_OR_WKUP_EDGE(row);
-                    notify = 1;
-                }
-            } else {        //判断是否按键抬起
-                if (cur_key_value != MATRIX_NO_KEY) {
-                    (key_st[row][col]).press_cnt ++;
-                    if ((key_st[row][col]).press_cnt == MATRIX_LONG_TIME) {
-                        /* printf("row:%d  col:%d   [LONG]\n", row, col);     */
-                    } else if ((key_st[row][col]).press_cnt == MATRIX_HOLD_TIME) {
-                        /* printf("row:%d  col:%d   [HOLD]\n", row, col);     */
-                        (key_st[row][col]).press_cnt = MATRIX_LONG_TIME;
-                    } else {
-                        //press_cnt还未累加够
-                    }
-                }
+        }
+    }
+    return (MATRIX_NO_KEY) ? (~value & scan.row_all) : value;
+}
+
+//全部列切成高阻/全部列输出有效电平(空闲时等待按下)
+static void matrix_key_cols_release(void)
+{
+    u8 i;
+
+    for (i = 0; i < scan.col_port_num; i++) {
+        scan.col_port[i].reg->dir |= scan.col_port[i].mask;
+    }
+}
+
+static void matrix_key_cols_drive(void)
+{
+    u8 i;
+
+    for (i = 0; i < scan.col_port_num; i++) {
+        scan.col_port[i].reg->dir &= ~scan.col_port[i].mask;
+    }
+}
+
+//有鬼键风险时(两列有两行以上同时按下), 这两列只接受抬起, 不接受新的按下
+static u8 matrix_key_ghost_filter(u8 *next)
+{
+    u8 c1, c2, common, ghost = 0;
+
+    for (c1 = 0; c1 < this->col_num; c1++) {
+        if (!(next[c1] & (next[c1] - 1))) {
+            continue;
+        }
+        for (c2 = c1 + 1; c2 < this->col_num; c2++) {
+            common = next[c1] & next[c2];
+            if (common & (common - 1)) {
+                next[c1] &= key_map[c1];
+                next[c2] &= key_map[c2];
+                ghost = 1;
             }
-            (key_st[row][col]).last_st = cur_key_value;
         }
-        //gpio_direction_input(this->col_pin_list[col]);
-        matrix_key_set_io_state(IO_STATUS_HIGH_DRIVER, &(this->col_pin_list[col]), 1);
     }
+    return ghost;
+}
+
+static void matrix_key_notify(u8 col, u8 change)
+{
+    u8 row;
+
+    for (row = 0; change; row++, change >>= 1) {
+        if (!(change & BIT(0))) {
+            continue;
+        }
+        if (key_map[col] & BIT(row)) {
+            dlog_print(__LOG_INFO, "row:%d  col:%d   [SHORT]", row, col);
+        }
+        (key_st[row][col]).press_cnt = 0;
+    }
+}
+
+static void matrix_key_hold_count(u8 col)
+{
+    u8 row;
+    u8 pressed = key_map[col];
+
+    for (row = 0; pressed; row++, pressed >>= 1) {
+        if (!(pressed & BIT(0))) {
+            continue;
+        }
+        (key_st[row][col]).press_cnt ++;
+        if ((key_st[row][col]).press_cnt == MATRIX_LONG_TIME) {
+            /* printf("row:%d  col:%d   [LONG]\n", row, col);     */
+        } else if ((key_st[row][col]).press_cnt == MATRIX_HOLD_TIME) {
+            /* printf("row:%d  col:%d   [HOLD]\n", row, col);     */
+            (key_st[row][col]).press_cnt = MATRIX_LONG_TIME;
+        }
+    }
+}
 
-    matrix_key_set_io_state((MATRIX_NO_KEY == 1) ? IO_STATUS_OUTPUT_LOW : IO_STATUS_OUTPUT_HIGH, this->col_pin_list, this->col_num);
+static void matrix_key_enter_idle(void)
+{
+    u8 row;
 
+    local_irq_disable();
+    matrix_key_cols_drive();
+    //和扫描一样等行线稳定后再开边沿唤醒和回读
+    delay(MATRIX_KEY_SETTLE_TIME);
+    for (row = 0; row < this->row_num; row++) {
+        (MATRIX_NO_KEY) ? P33_OR_WKUP_EDGE(row) : P33_AND_WKUP_EDGE(row);
+    }
     port_edge_wakeup_control(0xff);
-    //p33_tx_1byte(P3_WKUP_EN, 0xff);
-    //P33_LEVEL_WKUP_EN(1);
+    //打开唤醒前刚好按下的键不会产生边沿, 再读一次
+    if (matrix_key_read_rows()) {
+        port_edge_wakeup_control(0);
+    } else {
+        sys_s_hi_timer_del(matrix_key_timer);
+        matrix_key_timer = 0;
+        is_key_active = 0;
+    }
+    local_irq_enable();
+}
 
+void matrix_key_scan(void)
+{
+    u8 next[COL_MAX];
+    u8 raw, stable, change;
+    u8 col, notify = 0, busy = 0;
+    u32 begin = TICK_CNT;
+    u32 cost;
+
+    matrix_key_cols_release();
+    for (col = 0; col < this->col_num; col ++) {
+        scan.col[col].reg->dir &= ~scan.col[col].mask;
+        delay(MATRIX_KEY_SETTLE_TIME);
+        raw = matrix_key_read_rows();
+        scan.col[col].reg->dir |= scan.col[col].mask;
+
+        //连续两次采样一致的位才更新状态
+        stable = ~(raw ^ scan.raw[col]);
+        next[col] = (key_map[col] & ~stable) | (raw & stable);
+        busy |= raw | scan.raw[col];
+        scan.raw[col] = raw;
+    }
+    matrix_key_cols_drive();
+
+    if (matrix_key_ghost_filter(next)) {
+        matrix_stat.ghost++;
+    }
+
+    for (col = 0; col < this->col_num; col ++) {
+        change = next[col] ^ key_map[col];
+        key_map[col] = next[col];
+        if (change) {
+            matrix_key_notify(col, change);
+            notify = 1;
+        }
+        matrix_key_hold_count(col);
+    }
+
+    cost = matrix_key_tick_diff(begin, TICK_CNT);
+    matrix_stat.scan++;
+    matrix_stat.last_cost = cost;
+    if (cost > matrix_stat.max_cost) {
+        matrix_stat.max_cost = cost;
+    }
 
     if (notify) {
         struct sys_event e;
@@ -257,36 +382,28 @@ void matrix_key_scan(void)
         e.arg  = (void *)DEVICE_EVENT_FROM_KEY;
         sys_event_notify(&e);
     }
+
+    //没有按下的键, 也没有正在去抖的键
+    if (!busy) {
+        matrix_key_enter_idle();
+    }
 }
-#else
 
-void matrix_key_scan(void)
+void matrix_key_stat_get(struct matrix_key_stat *stat)
 {
-    u8 row, col;
-    u8 cur_key_value = MATRIX_NO_KEY, notify = 0;
-    for (row = 0; row < this->row_num; row ++) {
-        gpio_direction_input(this->row_pin_list[row]);
-        gpio_set_die(this->row_pin_list[row], 1);
-        gpio_set_pull_up(this->row_pin_list[row], 1);
-        gpio_set_pull_down(this->row_pin_list[row], 0);
-    }
+    local_irq_disable();
+    memcpy(stat, &matrix_stat, sizeof(*stat));
+    local_irq_enable();
+}
 
-    for (col = 0; col < this->col_num; col ++) {
-        gpio_direction_output(this->col_pin_list[col], 0);
-        gpio_set_die(this->col_pin_list[col], 1);
-        for (row = 0; row < this->row_num; row ++) {
-            if (gpio_read(this->row_pin_list[row]) == 0) {
-                printf("col:%x  row:%x\n", col, row);
-            }
+void matrix_key_stat_dump(void)
+{
+    struct matrix_key_stat stat;
 
-        }
-        gpio_direction_input(this->col_pin_list[col]);
-        gpio_set_pull_up(this->col_pin_list[col], 0);
-        gpio_set_pull_up(this->col_pin_list[col], 0);
-        gpio_set_die(this->col_pin_list[col], 0);
-    }
+    matrix_key_stat_get(&stat);
+    printf("matrix_key: scan %d, wakeup %d, ghost %d, cost %d/%d(max) tick\n",
+           stat.scan, stat.wakeup, stat.ghost, stat.last_cost, stat.max_cost);
 }
-#endif
 
 void matrix_key_wakeup_timeout_handler(void *arg)
 {
@@ -302,10 +419,19 @@ void matrix_key_wakeup_keep(void)
     matrix_key_wakeup_hold_timer = sys_s_hi_timerout_add(NULL, matrix_key_wakeup_timeout_handler, 10);
 }
 
+static void matrix_key_scan_start(void)
+{
+    port_edge_wakeup_control(0);
+    is_key_active = 1;
+    matrix_key_timer = sys_s_hi_timer_add(NULL, matrix_key_scan, MATRIX_KEY_SCAN_TIME);
+}
+
 void matrix_key_wakeup(u8 idx, u32 gpio)
 {
-    r_printf("matrix_key wkup!\n");
-    matrix_key_wakeup_keep();
+    matrix_stat.wakeup++;
+    if (!matrix_key_timer) {
+        matrix_key_scan_start();
+    }
 }
 
 int matrix_key_init(matrix_key_param *param)
@@ -325,14 +451,17 @@ int matrix_key_init(matrix_key_param *param)
     printf("key_row:%d rol:%d\n", this->row_num, this->col_num);
     if (matrix_key_timer) {
         sys_s_hi_timer_del(matrix_key_timer);
+        matrix_key_timer = 0;
     }
 
     matrix_key_set_io_state((MATRIX_NO_KEY) ? IO_STATUS_OUTPUT_LOW : IO_STATUS_OUTPUT_HIGH, this->col_pin_list, this->col_num);
     matrix_key_set_io_state((MATRIX_NO_KEY) ? IO_STATUS_INPUT_PULL_UP : IO_STATUS_INPUT_PULL_DOWN, this->row_pin_list, this->row_num);
-
+    matrix_scan_init();
+    memset(key_map, 0, sizeof(key_map));
 
     port_edge_wkup_set_callback(matrix_key_wakeup);
-    matrix_key_timer = sys_s_hi_timer_add(NULL, matrix_key_scan, 10);
+    //先扫一轮, 没有按键时自动进入边沿唤醒等待
+    matrix_key_scan_start();
     return 0;
 }
 
@@ -2,6 +2,7 @@
 #include "system/includes.h"
 /* #include "asm/port_wkup.h" */
 #include "app_config.h"
+#include "generic/jiffies.h"
 
 #if TCFG_OMSENSOR_ENABLE
 
@@ -13,8 +14,38 @@
 #define LOG_CLI_ENABLE
 #include "debug.h"
 
+//定时读传感器的周期, 单位ms, 可在板级配置中覆盖
+#ifndef OPTICAL_SENSOR_SAMPLE_PERIOD
+#define OPTICAL_SENSOR_SAMPLE_PERIOD    10
+#endif
+
 static const OMSENSOR_INTERFACE *OMSensor_hdl = NULL;
 
+struct omsensor_stat {
+    u32 read;           //读传感器次数
+    u32 motion;         //读到位移的次数
+    u32 report;         //取走的报告数
+    u32 empty;          //取报告时没有位移的次数
+    u32 clip;           //位移超出单个报告范围, 余量留到下一次的次数
+    u16 rate;           //最近1秒的报告数, 即实际上报率(Hz)
+    u16 rate_max;
+    u32 lat_sum;        //第一次读到位移到被取走的延时累计, 单位0.5ms
+    u16 lat_max;
+};
+
+struct omsensor_pipe {
+    u8 enable;
+    u8 pending;
+    s32 acc_x;
+    s32 acc_y;
+    u32 first_time;     //累加中最早一次位移的时间, 单位0.5ms
+    u32 win_start;      //上报率统计窗口开始时间, 单位0.5ms
+    u16 win_cnt;
+    struct omsensor_stat stat;
+};
+
+static struct omsensor_pipe omsensor_pipe;
+
 /* static void optical_mouse_sensor_read_motion_handler(void); */
 /* static void optical_mouse_sensor_read_motion_handler(void *priv); */
 
@@ -41,15 +72,18 @@ static s16 avg_filter(s16 *pdata, u8 num)
 /* 	} */
 /* } */
 
+static const char omsensor_axis[] = "omsensor_axis";
+
 static void optical_mouse_sensor_event_to_usr(u8 event, s16 x, s16 y)
 {
     struct sys_event e;
     e.type = SYS_DEVICE_EVENT;
-    e.arg = "omsensor_axis";
+    e.arg = (void *)omsensor_axis;
     e.u.axis.event = event;
     e.u.axis.x = x;
     e.u.axis.y = y;
-    sys_event_notify(&e);
+    //每10ms采样一次, app_core来不及处理时位移累加到同一个事件中, 不丢位移
+    sys_event_post_merge(&e, (u32)omsensor_axis, sys_event_axis_merge);
 }
 
 static u8 optical_mouse_sensor_data_ready(void)
@@ -64,24 +98,59 @@ static u8 optical_mouse_sensor_data_ready(void)
     return ret;
 }
 
+//burst_only: 只用快速读, 线程中调用时使用, 同步检查依赖定时器计时不能在关中断时做
+static bool optical_mouse_sensor_read(s16 *x, s16 *y, u8 burst_only)
+{
+    bool ret = false;
+    s16 dx = 0, dy = 0;
+
+    if (OMSensor_hdl->OMSensor_read_burst) {
+        ret = OMSensor_hdl->OMSensor_read_burst(&dx, &dy);
+    }
+    if (!ret && !burst_only && OMSensor_hdl->OMSensor_read_motion) {
+        ret = OMSensor_hdl->OMSensor_read_motion(&dx, &dy);
+    }
+    if (!ret) {
+        return false;
+    }
+
+    //x/y互换并取反
+    VECTOR_REVERS(dx);
+    VECTOR_REVERS(dy);
+    *x = dy;
+    *y = dx;
+
+    return true;
+}
+
+static void optical_mouse_sensor_motion_add(s16 x, s16 y)
+{
+    struct omsensor_pipe *pipe = &omsensor_pipe;
+
+    local_irq_disable();
+    pipe->stat.read++;
+    if (x || y) {
+        if (!pipe->pending) {
+            pipe->pending = 1;
+            pipe->first_time = jiffies_half_msec();
+        }
+        pipe->acc_x += x;
+        pipe->acc_y += y;
+        pipe->stat.motion++;
+    }
+    local_irq_enable();
+}
+
 void optical_mouse_sensor_read_motion_handler(void)
 /* static void optical_mouse_sensor_read_motion_handler(void) */
 {
     s16 x = 0, y = 0;
-    s16 temp = 0;
 
     if (optical_mouse_sensor_data_ready()) {
-        if (OMSensor_hdl->OMSensor_read_motion) {
-            OMSensor_hdl->OMSensor_read_motion(&x, &y);
+        if (!optical_mouse_sensor_read(&x, &y, 0)) {
+            return;
         }
 
-        temp = x;
-        x = y;
-        y = temp;
-
-        VECTOR_REVERS(x);
-        VECTOR_REVERS(y);
-
 #if 0
         static s16 x_data[3] = {0}, y_data[3] = {0};
         static u8 count = 0;
@@ -110,10 +179,112 @@ void optical_mouse_sensor_read_motion_handler(void)
         y = avg_filter(&y_data[0], ARRAY_SIZE(y_data));
 #endif
 
-        optical_mouse_sensor_event_to_usr(0, x, y);
+        if (omsensor_pipe.enable) {
+            optical_mouse_sensor_motion_add(x, y);
+        } else {
+            optical_mouse_sensor_event_to_usr(0, x, y);
+        }
     }
 }
 
+static void optical_mouse_sensor_timer_handler(void *priv)
+{
+    optical_mouse_sensor_read_motion_handler();
+}
+
+void optical_mouse_sensor_pipeline_enable(u8 enable)
+{
+    local_irq_disable();
+    omsensor_pipe.enable = enable;
+    omsensor_pipe.pending = 0;
+    omsensor_pipe.acc_x = 0;
+    omsensor_pipe.acc_y = 0;
+    omsensor_pipe.win_start = jiffies_half_msec();
+    omsensor_pipe.win_cnt = 0;
+    local_irq_enable();
+}
+
+static s16 motion_clip(s32 *acc, s16 limit)
+{
+    s32 v = *acc;
+
+    if (v > limit) {
+        v = limit;
+    } else if (v < -limit) {
+        v = -limit;
+    }
+    *acc -= v;
+
+    return v;
+}
+
+int optical_mouse_sensor_motion_take(s16 *x, s16 *y, s16 limit)
+{
+    struct omsensor_pipe *pipe = &omsensor_pipe;
+    s16 dx = 0, dy = 0;
+    u32 now;
+    u32 lat;
+
+    if (!OMSensor_hdl || !pipe->enable) {
+        return 0;
+    }
+
+    //发送前再读一次, 带上上次定时读之后的位移
+    if (optical_mouse_sensor_data_ready() && optical_mouse_sensor_read(&dx, &dy, 1)) {
+        optical_mouse_sensor_motion_add(dx, dy);
+    }
+
+    local_irq_disable();
+    now = jiffies_half_msec();
+    if (now - pipe->win_start >= 2000) {   //1秒
+        pipe->stat.rate = pipe->win_cnt;
+        if (pipe->stat.rate > pipe->stat.rate_max) {
+            pipe->stat.rate_max = pipe->stat.rate;
+        }
+        pipe->win_start = now;
+        pipe->win_cnt = 0;
+    }
+    if (!pipe->pending) {
+        pipe->stat.empty++;
+        local_irq_enable();
+        return 0;
+    }
+
+    *x = motion_clip(&pipe->acc_x, limit);
+    *y = motion_clip(&pipe->acc_y, limit);
+    lat = now - pipe->first_time;
+    if (pipe->acc_x || pipe->acc_y) {
+        //余量保留原来的时间, 延时按最早一次位移算
+        pipe->stat.clip++;
+    } else {
+        pipe->pending = 0;
+    }
+    pipe->win_cnt++;
+    pipe->stat.report++;
+    pipe->stat.lat_sum += lat;
+    if (lat > pipe->stat.lat_max) {
+        pipe->stat.lat_max = lat > 0xffff ? 0xffff : lat;
+    }
+    local_irq_enable();
+
+    return 1;
+}
+
+void optical_mouse_sensor_stat_dump(void)
+{
+    struct omsensor_stat s;
+
+    local_irq_disable();
+    memcpy(&s, &omsensor_pipe.stat, sizeof(s));
+    local_irq_enable();
+
+    log_info("read %d, motion %d, report %d, empty %d, clip %d",
+             s.read, s.motion, s.report, s.empty, s.clip);
+    log_info("report rate %d Hz, max %d Hz", s.rate, s.rate_max);
+    log_info("latency avg %d us, max %d us",
+             s.report ? s.lat_sum / s.report * 500 : 0, s.lat_max * 500);
+}
+
 
 u16 optical_mouse_sensor_set_cpi(u16 dst_cpi)
 {
@@ -178,7 +349,7 @@ bool optical_mouse_sensor_init(OMSENSOR_PLATFORM_DATA *priv)
 
     //设置optical mouse sensor的采样率
     if (retval == true) {
-        sys_s_hi_timer_add(NULL, optical_mouse_sensor_read_motion_handler, OPTICAL_SENSOR_SAMPLE_PERIOD); //10ms
+        sys_s_hi_timer_add(NULL, optical_mouse_sensor_timer_handler, OPTICAL_SENSOR_SAMPLE_PERIOD); //10ms
 
         /* port_wkup_enable(priv->OMSensor_int_io, 1); */
         /* request_irq(IRQ_PORT_IDX, 3, port_wkup_isr, 0); */
@@ -28,6 +28,7 @@ static void uSecDelay(u8 len);
 static void frameDelay();
 static bool hal_pixart_init(OMSENSOR_PLATFORM_DATA *priv);
 static bool  hal_pixart_readMotion(s16 *deltaX, s16 *deltaY);
+static bool hal_pixart_read_burst(s16 *deltaX, s16 *deltaY);
 static u8 hal_pixart_readRegister(u8 regAddress);
 static void hal_pixart_writeRegister(u8 regAddress, u8 innData);
 static u8 hal_pixart_read(void);
@@ -50,7 +51,7 @@ static const u16 cpi_table[] = {
 //};
 
 //功能：超时计数
-static void time_counter(void)
+static void time_counter(void *priv)
 {
     time_count++;
 }
@@ -307,6 +308,34 @@ _resync_fail_:
 }
 
 
+//功能：快速读数据
+//2线串口没有burst模式, 这里把motion/deltaX/deltaY三个寄存器放在一次关中断内连续读出,
+//不再每次读之前做PID同步检查; 读到0xff认为通信失步, 返回false由上层走hal_pixart_readMotion重新同步
+static bool hal_pixart_read_burst(s16 *deltaX, s16 *deltaY)
+{
+    u8 motion = 0, tmp_X = 0, tmp_Y = 0;
+
+    OS_ENTER_CRITICAL();
+    motion = hal_pixart_readRegister(pixart_MOTION_ADDR);
+    if ((motion != 0xff) && (motion & 0x80)) {
+        uSecDelay(1);
+        tmp_X = hal_pixart_readRegister(pixart_DELTAX_ADDR);
+        uSecDelay(1);
+        tmp_Y = hal_pixart_readRegister(pixart_DELTAY_ADDR);
+    }
+    OS_EXIT_CRITICAL();
+
+    if (motion == 0xff) {
+        return false;
+    }
+    get_overflow_status(motion);
+
+    *deltaX = (s8)tmp_X;
+    *deltaY = (s8)tmp_Y;
+
+    return true;
+}
+
 static u8 hal_pixart_readRegister(u8 regAddress)
 {
     u8 returnVal = 0;
@@ -508,6 +537,7 @@ REGISTER_OMSENSOR(optical_mouse_sensor) = {
     .OMSensor_id          = "hal3205",
     .OMSensor_init        = hal_pixart_init,
     .OMSensor_read_motion = hal_pixart_readMotion,
+    .OMSensor_read_burst  = hal_pixart_read_burst,
     .OMSensor_data_ready  = hal_pixart_data_ready,
     .OMSensor_status_dump = hal_pixart_status_dump,
     .OMSensor_wakeup = hal_pixart_force_wakeup,
@@ -1,8 +1,19 @@
 #ifndef OMSENSOR_CONFIG_H
 #define OMSENSOR_CONFIG_H
 
-#define OMSensor_HAL3205_ENABLE TCFG_HAL3205_ENABLE
-// #define OMSensor_HAL3212_ENABLE TCFG_HAL3212_ENABLE
+#include "app_config.h"
+
+//两个驱动的寄存器定义同名, 板级只能选一个
+#if TCFG_HAL3205_EN && TCFG_HAL3212_EN
+#error "TCFG_HAL3205_EN and TCFG_HAL3212_EN can not be enabled together"
+#endif
+
+#if TCFG_HAL3205_EN
+#define OMSensor_HAL3205_ENABLE
+#endif
+#if TCFG_HAL3212_EN
+#define OMSensor_HAL3212_ENABLE
+#endif
 
 
 #include "hal3205/hal3205.h"
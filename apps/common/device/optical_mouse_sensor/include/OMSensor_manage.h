@@ -16,6 +16,7 @@ typedef struct {
     u8 OMSensor_id[20];
     bool(*OMSensor_init)(OMSENSOR_PLATFORM_DATA *);
     bool (*OMSensor_read_motion)(s16 *, s16 *);
+    bool (*OMSensor_read_burst)(s16 *, s16 *);  //可选, 不做同步检查的快速读, 可在线程中调用
     u8(*OMSensor_data_ready)(void);
     u8(*OMSensor_status_dump)(void);
     void (*OMSensor_wakeup)(void);
@@ -46,5 +47,23 @@ u8 get_optical_mouse_sensor_status(void);
 void optical_mouse_sensor_force_wakeup(void);
 void optical_mouse_sensor_led_switch(u8 led_status);
 
+/*
+ * 累加上报模式
+ *
+ * 使能后定时读到的位移不再逐个发事件, 而是累加起来,
+ * 由发送方在每个连接事件(anchor点)调用optical_mouse_sensor_motion_take()取走,
+ * 每个连接事件只发一个合并后的报告.
+ */
+void optical_mouse_sensor_pipeline_enable(u8 enable);
+
+/*
+ * 取走累加的位移, 每个轴限制在[-limit, limit]内, 超出部分留到下一次
+ * 返回值: 1 有位移, 0 无位移
+ */
+int optical_mouse_sensor_motion_take(s16 *x, s16 *y, s16 limit);
+
+/*输出读传感器次数/上报次数/实际上报率/传感器到上报的延时*/
+void optical_mouse_sensor_stat_dump(void);
+
 #endif // _OMSM_H_
 
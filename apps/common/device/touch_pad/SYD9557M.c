@@ -4,6 +4,7 @@
 #include "timer.h"
 #include "event.h"
 #include "asm/power_interface.h"
+#include "asm/iic_queue.h"
 
 #if TCFG_TOUCHPAD_ENABLE
 #if 0
@@ -81,6 +82,43 @@ __gdend:
     return read_len;
 }
 
+#if CONFIG_IIC_QUEUE_ENABLE
+/*
+ * 2ms定时器中断里只提交传输, 读数和发事件在iic_queue任务的回调中完成,
+ * 不再在中断里占用总线约1ms, 上一次还没读完时跳过
+ */
+static iic_client_t syd9557m_client;
+static struct iic_xfer syd9557m_xfer;
+static const u8 syd9557m_reg = 0x01;
+static u8 syd9557m_data[5];
+
+static void syd9557m_xfer_cb(struct iic_xfer *x, int result)
+{
+    struct sys_event e;
+
+    if (result != sizeof(syd9557m_data)) {
+        return;
+    }
+    memset(&e, 0x0, sizeof(e));
+    e.type = SYS_TOUCHPAD_EVENT;
+    if (syd9557m_data[0] != TOUCHPAD_NO_GESTURE && syd9557m_data[0] < TOUCHPAD_MAX_GESTURE) {     //手势事件优先
+        e.u.touchpad.gesture_event = syd9557m_data[0];
+    }
+    e.u.touchpad.x = syd9557m_data[2];
+    e.u.touchpad.y = syd9557m_data[3];
+    sys_event_notify(&e);
+}
+
+void syd9557_timer_hdl(void *arg)
+{
+    if (syd9557m_client && gpio_read(INT_IO) == 0) {
+        //返回-EBUSY表示上一次还在队列中, 直接跳过
+        iic_xfer_submit(syd9557m_client, &syd9557m_xfer);
+    }
+}
+
+#else
+
 void syd9557_timer_hdl(void *arg)
 {
     u8 i = 0;
@@ -100,11 +138,17 @@ void syd9557_timer_hdl(void *arg)
     }
 }
 
+#endif
+
 void syd9557m_init(u8 iic)
 {
     int i = 0;
     iic_hdl = iic;
     iic_init(iic);
+#if CONFIG_IIC_QUEUE_ENABLE
+    syd9557m_client = iic_client_open("touchpad", IIC_QUEUE_BUS_SOFT, iic, SYD9557M_WRITE_ADDR >> 1, 50);
+    iic_xfer_init(&syd9557m_xfer, &syd9557m_reg, 1, syd9557m_data, sizeof(syd9557m_data), syd9557m_xfer_cb, NULL);
+#endif
     gpio_set_direction(INT_IO, 1);
     gpio_set_die(INT_IO, 1);
     gpio_set_pull_up(INT_IO, 1);
@@ -24,6 +24,7 @@
 /* #define LOG_DUMP_ENABLE */
 #define LOG_CLI_ENABLE
 #include "debug.h"
+#include "generic/dlog.h"
 
  // *INDENT-OFF*
 #define USB_MSD_BULK_DEV_USE_ASYNC			1
@@ -115,6 +116,20 @@ static const u8 SCSIInquiryData[] = {
 #define MSD_BLOCK_SIZE       1
 #define MSD_BUFFER_SIZE     (MSD_BLOCK_SIZE * 512)
 
+#if USB_MSD_BULK_DEV_USE_ASYNC
+//顺序读预取: 命令结束后继续异步读下一块, 主机顺序读时直接命中
+#define MSD_READ_AHEAD_EN   1
+//缓冲环深度: 设备读写与usb传输交替使用, 预取需要额外一块
+#define MSD_BUF_NUM         (2 + MSD_READ_AHEAD_EN)
+#define MSD_BUF(slot)       (msd_handle->msd_buf + (slot) * MSD_BUFFER_SIZE)
+#define MSD_BUF_NEXT(slot)  (((slot) + 1) % MSD_BUF_NUM)
+
+enum {
+    MSD_RA_NONE = 0,
+    MSD_RA_PENDING,     //预取已发起, 数据在下一次设备操作或flush后有效
+};
+#endif
+
 struct usb_msd_handle {
     struct usb_scsi_cbw cbw;
     struct usb_scsi_csw csw;
@@ -122,13 +137,22 @@ struct usb_msd_handle {
     u8 *msd_buf;
     u8 *ep_out_dmabuffer;
     /* u8 *ep_in_dmabuffer; */
-
+#if USB_MSD_BULK_DEV_USE_ASYNC
+    u8 buf_slot;
+    u8 ra_state;
+    u8 ra_slot;
+    u8 ra_lun;
+    u32 ra_lba;
+    u32 next_lba;
+    u32 capacity[MAX_MSD_DEV];
+#endif
+    struct msd_stat stat;
 };
 struct usb_msd_handle *msd_handle;
 #if USB_MALLOC_ENABLE
 #else
 #if USB_MSD_BULK_DEV_USE_ASYNC
-static u8 msd_buf[MSD_BUFFER_SIZE * 2] SEC(.mass_storage) __attribute__((aligned(64)));
+static u8 msd_buf[MSD_BUFFER_SIZE * MSD_BUF_NUM] SEC(.mass_storage) __attribute__((aligned(64)));
 #else
 static u8 msd_buf[MSD_BUFFER_SIZE] SEC(.mass_storage) __attribute__((aligned(64)));
 #endif
@@ -530,14 +554,89 @@ static void verify(const struct usb_device_t *usb_device)
     msd_handle->csw.bCSWStatus = 0;
 }
 
+static void msd_stat_update(u8 rw, u32 start_ms, u32 lba_num)
+{
+    u32 cost = sys_timer_get_ms() - start_ms;
+
+    if (rw) {
+        msd_handle->stat.wr_cmds++;
+        msd_handle->stat.wr_bytes += lba_num * 0x200;
+        msd_handle->stat.wr_ms += cost;
+        if (cost > msd_handle->stat.wr_lat_max) {
+            msd_handle->stat.wr_lat_max = cost;
+        }
+    } else {
+        msd_handle->stat.rd_cmds++;
+        msd_handle->stat.rd_bytes += lba_num * 0x200;
+        msd_handle->stat.rd_ms += cost;
+        if (cost > msd_handle->stat.rd_lat_max) {
+            msd_handle->stat.rd_lat_max = cost;
+        }
+    }
+}
+
+void msd_stat_get(struct msd_stat *stat, u8 reset)
+{
+    if (!msd_handle) {
+        memset(stat, 0, sizeof(*stat));
+        return;
+    }
+    memcpy(stat, &msd_handle->stat, sizeof(*stat));
+    if (reset) {
+        memset(&msd_handle->stat, 0, sizeof(msd_handle->stat));
+    }
+}
+
+void msd_stat_dump(void)
+{
+    struct msd_stat *st;
+
+    if (!msd_handle) {
+        return;
+    }
+    st = &msd_handle->stat;
+    //KB/s = bytes / ms
+    log_info("msd rd: %d cmd %d KB/s lat avg %d max %d ms, ra hit %d miss %d",
+             st->rd_cmds, st->rd_ms ? st->rd_bytes / st->rd_ms : 0,
+             st->rd_cmds ? st->rd_ms / st->rd_cmds : 0, st->rd_lat_max,
+             st->ra_hit, st->ra_miss);
+    log_info("msd wr: %d cmd %d KB/s lat avg %d max %d ms",
+             st->wr_cmds, st->wr_ms ? st->wr_bytes / st->wr_ms : 0,
+             st->wr_cmds ? st->wr_ms / st->wr_cmds : 0, st->wr_lat_max);
+}
+
 #if USB_MSD_BULK_DEV_USE_ASYNC
+/*
+ * 结束预取: 等待在途的异步读完成后作废, 任何其他设备操作前调用
+ * dev_fd为NULL表示设备已掉线, 不再访问
+ */
+static void msd_read_ahead_drop(void *dev_fd)
+{
+    if (msd_handle->ra_state == MSD_RA_PENDING) {
+        if (dev_fd) {
+            dev_ioctl(dev_fd, IOCTL_FLUSH, 0);
+        }
+        msd_handle->stat.ra_miss++;
+    }
+    msd_handle->ra_state = MSD_RA_NONE;
+}
+
 static void msd_write_10_async(const struct usb_device_t *usb_device, u8 cur_lun, u32 lba, u16 lba_num)
 {
     u32 err = 0;
     u16 num = 0;
-    u8  buf_idx = 0;
+    u8  slot = msd_handle->buf_slot;
     u32 have_send_stall = FALSE;
     void *dev_fd = NULL;
+
+    //磁盘状态与异步模式每条命令只设置一次
+    dev_fd = check_disk_status(cur_lun);
+    msd_read_ahead_drop(dev_fd);
+    msd_handle->next_lba = (u32) - 1;
+    if (dev_fd) {
+        dev_ioctl(dev_fd, IOCTL_SET_ASYNC_MODE, 0);
+    }
+
     while (lba_num) {
         wdt_clear();
         num = lba_num > MSD_BLOCK_SIZE ? MSD_BLOCK_SIZE : lba_num;
@@ -548,7 +647,8 @@ static void msd_write_10_async(const struct usb_device_t *usb_device, u8 cur_lun
         if (msd_handle->csw.uCSWDataResidue >= num * 0x200) {
             msd_handle->csw.uCSWDataResidue -= num * 0x200;
         }
-        err = msd_usb2mcu_64byte_fast(usb_device, msd_handle->msd_buf + buf_idx * MSD_BUFFER_SIZE, num * 0x200);
+        //上一块仍在异步写入设备时接收下一块
+        err = msd_usb2mcu_64byte_fast(usb_device, MSD_BUF(slot), num * 0x200);
         if (err != num * 0x200) {
             log_error("read usb_err %d, dev = %s",
                       __LINE__, msd_handle->info.dev_name[cur_lun]);
@@ -556,10 +656,8 @@ static void msd_write_10_async(const struct usb_device_t *usb_device, u8 cur_lun
             have_send_stall = TRUE;
             break;
         }
-        dev_fd = check_disk_status(cur_lun);
         if (dev_fd) {
-            dev_ioctl(dev_fd, IOCTL_SET_ASYNC_MODE, 0);
-            err = dev_bulk_write(dev_fd, msd_handle->msd_buf + buf_idx * MSD_BUFFER_SIZE, lba, num);
+            err = dev_bulk_write(dev_fd, MSD_BUF(slot), lba, num);
             if (err != num) {
                 log_error("write_10 write fail, %d, dev = %s",
                           err, msd_handle->info.dev_name[cur_lun]);
@@ -574,10 +672,11 @@ static void msd_write_10_async(const struct usb_device_t *usb_device, u8 cur_lun
             have_send_stall = TRUE;
             break;
         }
-        buf_idx = !buf_idx;
+        slot = MSD_BUF_NEXT(slot);
         lba_num -= num;
         lba += num;
     }
+    msd_handle->buf_slot = slot;
     dev_fd = check_disk_status(cur_lun);
     if (dev_fd) {
         //async mode last block flush
@@ -596,86 +695,100 @@ static void msd_read_10_async(const struct usb_device_t *usb_device, u8 cur_lun,
 {
     u32 err = 0;
     u16 num = 0;
-    u8 buf_idx = 0;
-    u32 last_lba = 0, last_num = 0;
+    u8 slot = msd_handle->buf_slot;
+    u8 last_slot;
+    u32 last_num = 0;
+    u8 sequential;
     void *dev_fd = NULL;
 
     if (lba_num == 0) {
-        printf_lite("lba_num == 0\n");
+        dlog_print(__LOG_ERROR, "lba_num == 0");
         stall_error(usb_device, 0, 0x02);
         return;
     }
-    printf_lite("%s() %d %d", __func__, lba, lba_num);
-    num = lba_num > MSD_BLOCK_SIZE ? MSD_BLOCK_SIZE : lba_num;
     dev_fd = check_disk_status(cur_lun);
-    if (dev_fd) {
-        dev_ioctl(dev_fd, IOCTL_SET_ASYNC_MODE, 0);
-        err = dev_bulk_read(dev_fd, msd_handle->msd_buf + buf_idx * MSD_BUFFER_SIZE, lba, num);
+    if (!dev_fd) {
+        msd_read_ahead_drop(NULL);
+        dlog_print(__LOG_ERROR, "read_10 disk offline, lun = %d", cur_lun);
+        stall_error(usb_device, 0, MEDIUM_ERROR);
+        return;
+    }
+    sequential = (lba == msd_handle->next_lba);
+    msd_handle->next_lba = lba + lba_num;
+    dev_ioctl(dev_fd, IOCTL_SET_ASYNC_MODE, 0);
+
+    if (msd_handle->ra_state == MSD_RA_PENDING &&
+        msd_handle->ra_lun == cur_lun && msd_handle->ra_lba == lba) {
+        //预取命中: 第一块已在途, 与普通异步读的第一块相同处理
+        msd_handle->ra_state = MSD_RA_NONE;
+        msd_handle->stat.ra_hit++;
+        slot = msd_handle->ra_slot;
+        num = lba_num > MSD_BLOCK_SIZE ? MSD_BLOCK_SIZE : lba_num;
+    } else {
+        msd_read_ahead_drop(dev_fd);
+        num = lba_num > MSD_BLOCK_SIZE ? MSD_BLOCK_SIZE : lba_num;
+        err = dev_bulk_read(dev_fd, MSD_BUF(slot), lba, num);
         if (err != num) {
-            printf_lite("read disk error0 = %d, dev = %s\n", err, msd_handle->info.dev_name[cur_lun]);
+            dlog_print(__LOG_ERROR, "read disk error0 = %d, lun = %d", err, cur_lun);
             stall_error(usb_device, 0, MEDIUM_ERROR);
             return;
         }
-    } else {
-        printf_lite("read_10 disk offline, dev = %s\n", msd_handle->info.dev_name[cur_lun]);
-        stall_error(usb_device, 0, MEDIUM_ERROR);
-        return;
     }
 
     while (lba_num) {
         wdt_clear();
         last_num = num;
-        last_lba = lba;
-        buf_idx = !buf_idx;
+        last_slot = slot;
+        slot = MSD_BUF_NEXT(slot);
         lba += num;
         lba_num -= num;
         num = lba_num > MSD_BLOCK_SIZE ? MSD_BLOCK_SIZE : lba_num;
         if (msd_handle->csw.uCSWDataResidue == 0) {
             msd_handle->csw.bCSWStatus = 1;
+            dev_ioctl(dev_fd, IOCTL_FLUSH, 0);
             break;
         }
         if (msd_handle->csw.uCSWDataResidue >= last_num * 0x200) {
             msd_handle->csw.uCSWDataResidue -= last_num * 0x200;
         }
-        dev_fd = check_disk_status(cur_lun);
-        if (dev_fd) {
-            if (num) {
-                dev_ioctl(dev_fd, IOCTL_SET_ASYNC_MODE, 0);
-                err = dev_bulk_read(dev_fd, msd_handle->msd_buf + buf_idx * MSD_BUFFER_SIZE, lba, num);
-                if (err != num) {
-                    printf_lite("read disk error1 = %d, dev = %s",
-                                err, msd_handle->info.dev_name[cur_lun]);
-                    stall_error(usb_device, 0, MEDIUM_ERROR);
-                    break;
-                }
+        if (num) {
+            err = dev_bulk_read(dev_fd, MSD_BUF(slot), lba, num);
+            if (err != num) {
+                dlog_print(__LOG_ERROR, "read disk error1 = %d, lun = %d", err, cur_lun);
+                stall_error(usb_device, 0, MEDIUM_ERROR);
+                break;
+            }
+        } else if (MSD_READ_AHEAD_EN && sequential &&
+                   lba + MSD_BLOCK_SIZE <= msd_handle->capacity[cur_lun]) {
+            //顺序读: 发起下一块的异步读, 同时完成当前块, 数据在下一条命令中使用
+            err = dev_bulk_read(dev_fd, MSD_BUF(slot), lba, MSD_BLOCK_SIZE);
+            if (err == MSD_BLOCK_SIZE) {
+                msd_handle->ra_state = MSD_RA_PENDING;
+                msd_handle->ra_slot = slot;
+                msd_handle->ra_lun = cur_lun;
+                msd_handle->ra_lba = lba;
             } else {
-                //async mode last block flush
                 dev_ioctl(dev_fd, IOCTL_FLUSH, 0);
             }
         } else {
-            printf_lite("read_10 disk offline, dev = %s",
-                        msd_handle->info.dev_name[cur_lun]);
-            stall_error(usb_device, 0, MEDIUM_ERROR);
-            break;
+            //async mode last block flush
+            dev_ioctl(dev_fd, IOCTL_FLUSH, 0);
         }
 
-        /* u8 *p = msd_handle->msd_buf + !buf_idx * MSD_BUFFER_SIZE; */
-        /* for (int i = 0; i < last_num * 512; i++) {                */
-        /*     p[i] = i;                                             */
-        /* }                                                         */
-
-        err = msd_mcu2usb(usb_device, msd_handle->msd_buf + !buf_idx * MSD_BUFFER_SIZE, last_num * 0x200);
+        err = msd_mcu2usb(usb_device, MSD_BUF(last_slot), last_num * 0x200);
 
         if (err != last_num * 0x200) {
-            printf_lite("read_10 data transfer err %d, dev = %s",
-                        __LINE__, msd_handle->info.dev_name[cur_lun]);
+            dlog_print(__LOG_ERROR, "read_10 data transfer err %d, lun = %d", __LINE__, cur_lun);
             stall_error(usb_device, 0, 0x05);
             if (num) {
                 dev_ioctl(dev_fd, IOCTL_FLUSH, 0);
             }
+            msd_read_ahead_drop(dev_fd);
             break;
         }
     }
+    //预取块之后的缓冲留给下一条命令
+    msd_handle->buf_slot = MSD_BUF_NEXT(slot);
 }
 #endif
 static u32 read_32(u8 *p)
@@ -694,6 +807,8 @@ static void write_10(const struct usb_device_t *usb_device)
     lba_num = ((u16)(msd_handle->cbw.LengthH) << 8) | (msd_handle->cbw.LengthL);
     u8 cur_lun = msd_handle->cbw.bCBWLUN;
     void *dev_fd = msd_handle->info.dev_handle[cur_lun];
+    u32 start_ms = sys_timer_get_ms();
+    u16 cmd_lba_num = lba_num;
 
     /* app_status_handler(APP_STATUS_PC_COPY); */
 
@@ -748,6 +863,7 @@ static void write_10(const struct usb_device_t *usb_device)
         }
     }
 #endif
+    msd_stat_update(1, start_ms, cmd_lba_num);
 }
 static void read_10(const struct usb_device_t *usb_device)
 {
@@ -759,6 +875,8 @@ static void read_10(const struct usb_device_t *usb_device)
     lba_num = ((u16)(msd_handle->cbw.LengthH) << 8) | (msd_handle->cbw.LengthL);
     u8 cur_lun = msd_handle->cbw.bCBWLUN;
     void *dev_fd = msd_handle->info.dev_handle[cur_lun];
+    u32 start_ms = sys_timer_get_ms();
+    u16 cmd_lba_num = lba_num;
 
 #if USB_MSD_BULK_DEV_USE_ASYNC
     msd_read_10_async(usb_device, cur_lun, lba, lba_num);
@@ -799,6 +917,7 @@ static void read_10(const struct usb_device_t *usb_device)
         lba_num -= num;
     }
 #endif
+    msd_stat_update(0, start_ms, cmd_lba_num);
 }
 static void read_capacity(const struct usb_device_t *usb_device)
 {
@@ -812,6 +931,10 @@ static void read_capacity(const struct usb_device_t *usb_device)
         return;
     }
     dev_ioctl(dev_fd, IOCTL_GET_CAPACITY, (u32)&capacity_temp);
+#if USB_MSD_BULK_DEV_USE_ASYNC
+    //预取不越过磁盘末尾
+    msd_handle->capacity[cur_lun] = capacity_temp;
+#endif
     capacity_temp = cpu_to_be32(capacity_temp - 1);
     memcpy(capacity, &capacity_temp, 4);
     dev_ioctl(dev_fd, IOCTL_GET_BLOCK_SIZE, (u32)&capacity_temp);
@@ -887,6 +1010,11 @@ void USB_MassStorage(const struct usb_device_t *usb_device)
         return;
     }
     /* log_debug("opcode %x", msd_handle->cbw.operationCode); */
+#if USB_MSD_BULK_DEV_USE_ASYNC
+    if (msd_handle->cbw.operationCode != READ_10) {
+        msd_read_ahead_drop(msd_handle->info.dev_handle[msd_handle->ra_lun]);
+    }
+#endif
     if (private_scsi_cmd(usb_device, &(msd_handle->cbw))) {
         msd_handle->info.bError = 0;
         msd_handle->csw.uCSWDataResidue = 0;
@@ -1008,6 +1136,9 @@ u32 msd_unregister_all()
     u32 err;
     int i;
     if (msd_handle) {
+#if USB_MSD_BULK_DEV_USE_ASYNC
+        msd_read_ahead_drop(msd_handle->info.dev_handle[msd_handle->ra_lun]);
+#endif
         for (i = 0; i < __get_max_msd_dev(); i++) {
             if (msd_handle->info.dev_handle[i]) {
                 err = dev_close(msd_handle->info.dev_handle[i]);
@@ -1028,7 +1159,7 @@ u32 msd_register(const usb_dev usb_id)
             return -1;
         }
 #if USB_MSD_BULK_DEV_USE_ASYNC
-        msd_handle->msd_buf = (u8 *)malloc(MSD_BUFFER_SIZE * 2);
+        msd_handle->msd_buf = (u8 *)malloc(MSD_BUFFER_SIZE * MSD_BUF_NUM);
 #else
         msd_handle->msd_buf = (u8 *)malloc(MSD_BUFFER_SIZE);
 #endif
@@ -1042,6 +1173,9 @@ u32 msd_register(const usb_dev usb_id)
         msd_handle = &_msd_handle;
 #endif
         log_info("msd_handle = %x", msd_handle);
+#if USB_MSD_BULK_DEV_USE_ASYNC
+        msd_handle->next_lba = (u32) - 1;
+#endif
 
         msd_handle->ep_out_dmabuffer = usb_alloc_ep_dmabuffer(usb_id, MSD_BULK_EP_OUT, MAXP_SIZE_BULKIN + MAXP_SIZE_BULKOUT);
 
@@ -1051,6 +1185,9 @@ u32 msd_register(const usb_dev usb_id)
 u32 msd_release()
 {
     if (msd_handle) {
+#if USB_MSD_BULK_DEV_USE_ASYNC
+        msd_read_ahead_drop(msd_handle->info.dev_handle[msd_handle->ra_lun]);
+#endif
         for (int i = 0; i < __get_max_msd_dev(); i++) {
             void *dev_fd = msd_handle->info.dev_handle[i] ;
             if (dev_fd) {
@@ -27,12 +27,13 @@
 
 static volatile u8 speaker_stream_is_open = 0;
 struct uac_speaker_handle {
-    cbuffer_t cbuf;
+    spsc_buf_t cbuf;    //USB中断写, 音频任务读
     volatile u8 need_resume;
     u8 channel;
     u8 alive;
     void *buffer;
     void *audio_track;
+    struct uac_spk_stat stat;
     //void (*rx_handler)(int, void *, int);
 };
 
@@ -45,9 +46,20 @@ static void (*uac_rx_handler)(int, void *, int) = NULL;
 #endif
 
 #define UAC_BUFFER_MAX		(UAC_BUFFER_SIZE * 50 / 100)
+SPSC_BUF_SIZE_CHECK(uac_rx_buffer, UAC_BUFFER_SIZE);
 
 static struct uac_speaker_handle *uac_speaker = NULL;
 
+#if USB_MALLOC_ENABLE
+//handle动态申请,关闭时会被释放,读取期间需要关中断
+#define UAC_SPK_LOCK()      local_irq_disable()
+#define UAC_SPK_UNLOCK()    local_irq_enable()
+#else
+//handle及buffer为静态内存,与USB中断之间通过spsc_buf无锁交接
+#define UAC_SPK_LOCK()
+#define UAC_SPK_UNLOCK()
+#endif
+
 #if USB_MALLOC_ENABLE
 #else
 static struct uac_speaker_handle uac_speaker_handle SEC(.uac_var);
@@ -64,7 +76,7 @@ u32 uac_speaker_stream_size()
     }
 
     if (uac_speaker) {
-        return cbuf_get_data_size(&uac_speaker->cbuf);
+        return spsc_buf_get_data_len(&uac_speaker->cbuf);
     }
 
     return 0;
@@ -89,8 +101,26 @@ void uac_speaker_set_alive(u8 alive)
 void uac_speaker_stream_buf_clear(void)
 {
     if (speaker_stream_is_open) {
-        cbuf_clear(&uac_speaker->cbuf);
+        local_irq_disable();
+        spsc_buf_clear(&uac_speaker->cbuf);
+        local_irq_enable();
+    }
+}
+
+int uac_speaker_stream_stat(struct uac_spk_stat *stat, u8 reset)
+{
+    local_irq_disable();
+    if (!speaker_stream_is_open || !uac_speaker) {
+        local_irq_enable();
+        return -1;
+    }
+    memcpy(stat, &uac_speaker->stat, sizeof(*stat));
+    stat->level = spsc_buf_get_data_len(&uac_speaker->cbuf);
+    if (reset) {
+        memset(&uac_speaker->stat, 0, sizeof(uac_speaker->stat));
     }
+    local_irq_enable();
+    return 0;
 }
 
 void set_uac_speaker_rx_handler(void *priv, void (*rx_handler)(int, void *, int))
@@ -128,9 +158,11 @@ void uac_speaker_stream_write(const u8 *obuf, u32 len)
             audio_local_sample_track_in_period(uac_speaker->audio_track, (len >> 1) / uac_speaker->channel);
         }
         /* #endif */
-        int wlen = cbuf_write(&uac_speaker->cbuf, (void *)obuf, len);
+        int wlen = spsc_buf_write(&uac_speaker->cbuf, obuf, len);
         if (wlen != len) {
             //putchar('W');
+            uac_speaker->stat.overrun++;
+            uac_speaker->stat.drop_bytes += len - wlen;
         }
         //if (uac_speaker->rx_handler) {
         if (uac_rx_handler) {
@@ -150,28 +182,25 @@ void uac_speaker_stream_write(const u8 *obuf, u32 len)
 
 int uac_speaker_read(void *priv, void *data, u32 len)
 {
+    struct uac_speaker_handle *spk;
     int r_len;
-    int err = 0;
 
-    local_irq_disable();
-    if (!speaker_stream_is_open) {
-        local_irq_enable();
+    UAC_SPK_LOCK();
+    spk = uac_speaker;
+    if (!speaker_stream_is_open || !spk) {
+        UAC_SPK_UNLOCK();
         return 0;
     }
 
-    r_len = cbuf_get_data_size(&uac_speaker->cbuf);
-    if (r_len) {
-        r_len = r_len > len ? len : r_len;
-        r_len = cbuf_read(&uac_speaker->cbuf, data, r_len);
-        if (!r_len) {
-            putchar('U');
-        }
-    }
+    r_len = spsc_buf_read(&spk->cbuf, data, len);
 
     if (r_len == 0) {
-        uac_speaker->need_resume = 1;
+        spk->need_resume = 1;
     }
-    local_irq_enable();
+    if (r_len < len) {
+        spk->stat.underrun++;
+    }
+    UAC_SPK_UNLOCK();
     return r_len;
 }
 
@@ -215,7 +244,8 @@ void uac_speaker_stream_open(u32 samplerate, u32 ch)
 
     //uac_speaker->rx_handler = NULL;
 
-    cbuf_init(&uac_speaker->cbuf, uac_speaker->buffer, UAC_BUFFER_SIZE);
+    spsc_buf_init(&uac_speaker->cbuf, uac_speaker->buffer, UAC_BUFFER_SIZE);
+    memset(&uac_speaker->stat, 0, sizeof(uac_speaker->stat));
     speaker_stream_is_open = 1;
     struct sys_event event;
     event.type = SYS_DEVICE_EVENT;
@@ -335,6 +365,7 @@ void uac_mute_volume(u32 type, u32 l_vol, u32 r_vol)
 
 
 static int (*mic_tx_handler)(int, void *, int) = NULL;
+//由ISO IN中断调用, buf就是端点的DMA buffer, tx_handler直接把数据填进去, 中间没有再缓存一次
 int uac_mic_stream_read(u8 *buf, u32 len)
 {
     if (mic_stream_is_open == 0) {
@@ -17,6 +17,13 @@ enum uac_event {
     USB_AUDIO_SET_MIC_VOL,
 };
 
+//speaker缓存统计, 本SDK里没有speaker的播放消费者, 只做观测, 不做时钟漂移补偿
+struct uac_spk_stat {
+    u32 overrun;    //缓存满,丢弃主机数据次数
+    u32 underrun;   //uac_speaker_read()取数不足次数, 消费者不经过该接口取数时不计数
+    u32 drop_bytes; //丢弃的字节数
+    u32 level;      //当前缓存水位(byte)
+};
 
 void uac_speaker_stream_buf_clear(void);
 u32 uac_speaker_stream_length();
@@ -24,6 +31,7 @@ u32 uac_speaker_stream_size();
 void set_uac_speaker_rx_handler(void *priv, void (*rx_handler)(int, void *, int));
 void set_uac_mic_tx_handler(void *priv, int (*tx_handler)(int, void *, int));
 int uac_speaker_stream_sample_rate(void);
+int uac_speaker_stream_stat(struct uac_spk_stat *stat, u8 reset);
 
 int uac_speaker_read(void *priv, void *data, u32 len);
 u32 uac_speaker_get_alive();
@@ -1017,71 +1017,78 @@ __exit:
 }
 #endif
 #if UDISK_READ_512_ASYNC_ENABLE
-static int _usb_stro_read_async(struct device *device, void *pBuf, u32 num_lba, u32 lba)
+/*
+ * 结束当前预读流: 丢弃cbw剩余未取的data并收取csw
+ * BOT协议同一时刻只允许一条cbw在途,切换地址/读写方向前必须先调用
+ */
+static int _usb_stor_async_stream_flush(struct device *device)
 {
     struct usb_host_device *host_dev = device_to_usbdev(device);
     struct mass_storage *disk = host_device2disk(host_dev);
-    const usb_dev usb_id = host_device2id(host_dev);
-
-    const u32 txmaxp = usb_stor_txmaxp(disk);
     const u32 rxmaxp = usb_stor_rxmaxp(disk);
-    int ret = 0;
-    u32 rx_len = num_lba * 512;  //filesystem uses the fixed BLOCK_SIZE
-    u8 read_block_num = UDISK_READ_ASYNC_BLOCK_NUM;
-    /* r_printf("lba : %d %d\n",lba,disk->remain_len); */
-    if (_usb_stor_async_wait_sem(host_dev)) {
-        goto __exit;
+    int ret = DEV_ERR_NONE;
+
+    if (disk->remain_len == 0) {
+        if (disk->need_send_csw) {
+            //已取完data,需要发csw
+            ret = _usb_stro_read_csw(device);
+            disk->need_send_csw = 0;
+        }
+        return ret;
+    }
+    //这里要确保上次cbw 请求的数据读取完毕
+    //data
+    while (disk->remain_len) {
+        ret = usb_bulk_only_receive(device,
+                                    udisk_ep.host_epin,
+                                    rxmaxp,
+                                    udisk_ep.target_epin,
+                                    NULL,
+                                    512);
+        disk->remain_len -= 512;
+        disk->rd_stat.drop_sectors++;
+        if (ret != 512) {
+            log_error("%s:%d %d\n", __func__, __LINE__, ret);
+            disk->remain_len = 0; //data 接收错误直接发csw
+            break;
+        }
     }
+    //csw
+    ret = _usb_stro_read_csw(device);
+    disk->need_send_csw = 0;
+    return ret;
+}
+
+/*
+ * 从当前预读流中连续取num_lba个扇区,直接收到调用者buffer(不经过bounce buffer)
+ * 流读空时在lba处重新发起一个窗口大小的cbw
+ */
+static int _usb_stor_async_stream_rx(struct device *device, u8 *pBuf, u32 num_lba, u32 lba)
+{
+    struct usb_host_device *host_dev = device_to_usbdev(device);
+    struct mass_storage *disk = host_device2disk(host_dev);
+    const u32 rxmaxp = usb_stor_rxmaxp(disk);
+    const u32 curlun = usb_stor_get_curlun(disk);
+    const u32 block_num = disk->capacity[curlun].block_num;
+    u32 read_block_num;
+    u32 rx_len;
+    int ret;
 
-    if ((lba != disk->async_prev_lba + 1)) {
+    while (num_lba) {
         if (disk->remain_len == 0) {
-            if (disk->need_send_csw) {
-                //已取完data,需要发csw
-                ret = _usb_stro_read_csw(device);
-                if (ret < DEV_ERR_NONE) {
-                    log_error("%s:%d %d\n", __func__, __LINE__, ret);
-                    goto __exit;
-                }
-                disk->need_send_csw = 0;
-            }
-        }
-        //这里要确保上次cbw 请求的数据读取完毕
-        //data
-        while (disk->remain_len) {
-            ret = usb_bulk_only_receive(device,
-                                        udisk_ep.host_epin,
-                                        rxmaxp,
-                                        udisk_ep.target_epin,
-                                        NULL,
-                                        rx_len);
-            disk->remain_len -= rx_len;
-            if (ret != rx_len) {
-                log_error("%s:%d %d\n", __func__, __LINE__, ret);
-                disk->remain_len = 0; //data 接收错误直接发csw
-                goto __exit;
+            read_block_num = MAX(disk->ra_window, num_lba);
+            if (lba + read_block_num > block_num) {
+                read_block_num = block_num - lba;
             }
-            if (disk->remain_len == 0) {
-                //csw
-                ret = usb_bulk_only_receive(device,
-                                            udisk_ep.host_epin,
-                                            rxmaxp,
-                                            udisk_ep.target_epin,
-                                            (u8 *)&disk->csw,
-                                            sizeof(struct usb_scsi_csw));
-                if (ret != sizeof(struct usb_scsi_csw)) {
-                    ret = -DEV_ERR_UNKNOW;
-                    log_error("%s:%d\n", __func__, __LINE__);
-                    goto __exit;
-                }
-                break;
+            ret = _usb_stro_read_cbw_request(device, read_block_num, lba); //cbw
+            if (ret < DEV_ERR_NONE) {
+                log_error("%s:%d\n", __func__, __LINE__);
+                return ret;
             }
+            disk->remain_len = read_block_num * 512;
+            disk->rd_stat.cbw_cnt++;
         }
-        ret = _usb_stro_read_cbw_request(device, read_block_num, lba); //cbw
-        if (ret < DEV_ERR_NONE) {
-            log_error("%s:%d\n", __func__, __LINE__);
-            goto __exit;
-        }
-        disk->remain_len = read_block_num * 512;
+        rx_len = MIN(num_lba * 512, disk->remain_len);
         //data
         ret = usb_bulk_only_receive(device,
                                     udisk_ep.host_epin,
@@ -1089,66 +1096,155 @@ static int _usb_stro_read_async(struct device *device, void *pBuf, u32 num_lba,
                                     udisk_ep.target_epin,
                                     pBuf,
                                     rx_len);
-        if (ret < DEV_ERR_NONE) {
-            log_error("%s:%d\n", __func__, __LINE__);
-            goto __exit;
+        if (ret != rx_len) {
+            log_error("%s:%d %d\n", __func__, __LINE__, ret);
+            disk->remain_len = 0;
+            return ret < DEV_ERR_NONE ? ret : -DEV_ERR_UNKNOW;
         }
         disk->remain_len -= rx_len;
+        pBuf += rx_len;
+        lba += rx_len / 512;
+        num_lba -= rx_len / 512;
         if (disk->remain_len == 0) {
+            //csw
             ret = _usb_stro_read_csw(device);
             if (ret != sizeof(struct usb_scsi_csw)) {
-                ret = -DEV_ERR_UNKNOW;
-                log_error("%s:%d\n", __func__, __LINE__);
-                goto __exit;
+                return -DEV_ERR_UNKNOW;
             }
         }
-    } else {
-        memcpy(pBuf, disk->udisk_512_buf, rx_len);
-        if (disk->remain_len == 0) {
+    }
+    return DEV_ERR_NONE;
+}
+
+static int _usb_stro_read_async(struct device *device, void *pBuf, u32 num_lba, u32 lba)
+{
+    struct usb_host_device *host_dev = device_to_usbdev(device);
+    struct mass_storage *disk = host_device2disk(host_dev);
+    const u32 curlun = usb_stor_get_curlun(disk);
+    const u32 first_lba = lba;
+    const u32 next_lba = lba + num_lba;
+    u8 *buf = pBuf;
+    u32 read_block_num;
+    u8 hit = 0;
+    int ret = 0;
+    /* r_printf("lba : %d %d %d\n",lba,num_lba,disk->remain_len); */
+    if (_usb_stor_async_wait_sem(host_dev)) {
+        goto __exit;
+    }
+
+    disk->rd_stat.read_cnt++;
+    disk->rd_stat.sectors += num_lba;
+
+    if (lba == disk->async_prev_lba + 1) {
+        //地址连续,首扇区已异步预读到udisk_512_buf
+        memcpy(buf, disk->udisk_512_buf, 512);
+        buf += 512;
+        lba++;
+        num_lba--;
+        if (disk->remain_len == 0 && disk->need_send_csw) {
             ret = _usb_stro_read_csw(device);
+            disk->need_send_csw = 0;
             if (ret != sizeof(struct usb_scsi_csw)) {
                 ret = -DEV_ERR_UNKNOW;
                 log_error("%s:%d\n", __func__, __LINE__);
                 goto __exit;
             }
         }
+        hit = 1;
+        disk->rd_stat.ra_hit++;
+    } else {
+        ret = _usb_stor_async_stream_flush(device);
+        if (ret < DEV_ERR_NONE) {
+            log_error("%s:%d %d\n", __func__, __LINE__, ret);
+            goto __exit;
+        }
+        //随机访问,预读窗口回到最小值
+        disk->ra_window = UDISK_READ_ASYNC_BLOCK_NUM;
+        disk->rd_stat.ra_miss++;
     }
-    disk->async_prev_lba = lba;
+
+    //剩余扇区直接从预读流收到调用者buffer
+    ret = _usb_stor_async_stream_rx(device, buf, num_lba, lba);
+    if (ret < DEV_ERR_NONE) {
+        goto __exit;
+    }
+    disk->async_prev_lba = next_lba - 1;
+
     //异步预读
     if (disk->remain_len == 0) {
-        ret = _usb_stro_read_cbw_request(device, read_block_num, lba + 1); //cbw
+        if (next_lba >= disk->capacity[curlun].block_num) {
+            //已到盘尾,不再预读
+            disk->async_prev_lba = MASS_LBA_INIT;
+            goto __done;
+        }
+        //上一个预读命令在顺序读中读完才放大窗口: 每个命令最多翻倍一次,
+        //随机访问时要丢弃的预读扇区不会超过当前窗口
+        if (hit && disk->ra_window < UDISK_READ_ASYNC_BLOCK_NUM_MAX) {
+            disk->ra_window <<= 1;
+        }
+        read_block_num = MIN(disk->ra_window, disk->capacity[curlun].block_num - next_lba);
+        ret = _usb_stro_read_cbw_request(device, read_block_num, next_lba); //cbw
         if (ret < DEV_ERR_NONE) {
             log_error("%s:%d\n", __func__, __LINE__);
             goto __exit;
         }
         disk->remain_len = read_block_num * 512;
+        disk->rd_stat.cbw_cnt++;
     }
     //data
     ret = usb_bulk_receive_async_no_wait(device,
                                          udisk_ep.host_epin,
-                                         rxmaxp,
+                                         usb_stor_rxmaxp(disk),
                                          udisk_ep.target_epin,
                                          disk->udisk_512_buf,
-                                         rx_len);
+                                         512);
     if (ret < DEV_ERR_NONE) {
         log_error("%s:%d\n", __func__, __LINE__);
         goto __exit;
     }
-    disk->remain_len -= rx_len;
+    disk->remain_len -= 512;
     if (disk->remain_len == 0) {
         //data请求完,等待发送csw
         disk->need_send_csw = 1;
     }
 
+__done:
     disk->dev_status = DEV_OPEN;
-    return num_lba;
+    return next_lba - first_lba;
 __exit:
+    disk->async_prev_lba = MASS_LBA_INIT;
     if (disk->dev_status != DEV_CLOSE) {
         disk->dev_status = DEV_OPEN;
     }
     log_error("%s---%d", __func__, __LINE__);
     return 0;
 }
+
+int usb_stor_read_stat_get(struct udisk_read_stat *stat, u8 reset)
+{
+    struct mass_storage *disk = udisk_inf.dev.disk;
+
+    if (!disk || !stat) {
+        return -EINVAL;
+    }
+    memcpy(stat, &disk->rd_stat, sizeof(*stat));
+    if (reset) {
+        memset(&disk->rd_stat, 0, sizeof(disk->rd_stat));
+    }
+    return 0;
+}
+
+void usb_stor_read_stat_dump(void)
+{
+    struct udisk_read_stat stat;
+
+    if (usb_stor_read_stat_get(&stat, 0)) {
+        return;
+    }
+    log_info("udisk read:%d sectors:%d hit:%d miss:%d cbw:%d drop:%d",
+             stat.read_cnt, stat.sectors, stat.ra_hit, stat.ra_miss,
+             stat.cbw_cnt, stat.drop_sectors);
+}
 #endif
 /**
  * @brief usb_stor_read 从U盘的lba扇区读取num_lba个扇区
@@ -1304,12 +1400,12 @@ static int _usb_stor_write(struct device *device, void *pBuf,  u32 num_lba, u32
                                     rxmaxp,
                                     udisk_ep.target_epin,
                                     NULL,
-                                    tx_len);
+                                    512);
         if (ret < DEV_ERR_NONE) {
             log_error("%s:%d\n", __func__, __LINE__);
             goto __exit;
         }
-        disk->remain_len -= tx_len;
+        disk->remain_len -= 512;
         disk->need_send_csw = 1;
     }
     if (disk->remain_len == 0) {
@@ -1326,7 +1422,7 @@ static int _usb_stor_write(struct device *device, void *pBuf,  u32 num_lba, u32
             }
         }
         disk->need_send_csw = 0;
-        disk->async_prev_lba = 0;
+        disk->async_prev_lba = MASS_LBA_INIT;
     }
 #endif
 
@@ -1778,6 +1874,9 @@ static int usb_stor_ioctrl(struct device *device, u32 cmd, u32 arg)
         }
         disk->async_en = arg;
         disk->async_prev_lba = MASS_LBA_INIT;
+#if UDISK_READ_512_ASYNC_ENABLE
+        disk->ra_window = UDISK_READ_ASYNC_BLOCK_NUM;
+#endif
         disk->need_send_csw = 0;
         set_async_mode(BULK_ASYNC_MODE_EXIT);
         usb_h_mutex_post(host_dev);
@@ -1886,6 +1985,8 @@ static int usb_stor_open(const char *name, struct device **device, void *arg)
     if (!disk->udisk_512_buf) {
         disk->udisk_512_buf = zalloc(512);
     }
+    disk->ra_window = UDISK_READ_ASYNC_BLOCK_NUM;
+    memset(&disk->rd_stat, 0, sizeof(disk->rd_stat));
 #endif
 #endif
     ret = usb_stor_init(*device);
@@ -32,7 +32,20 @@
 #define  UDISK_READ_512_ASYNC_ENABLE         1   //使能512Byte预读方式(需要额外的512byte buffer,速度比大扇区预读快10%)
 /****************************/
 
-#define UDISK_READ_ASYNC_BLOCK_NUM  (16) //预读扇区数
+#define UDISK_READ_ASYNC_BLOCK_NUM  (16) //预读扇区数(随机访问时的最小预读窗口)
+#define UDISK_READ_ASYNC_BLOCK_NUM_MAX  (128) //顺序读时预读窗口最大扇区数,顺序读完一个预读命令后窗口翻倍
+
+/**@struct  udisk_read_stat
+  * @brief  U盘预读统计
+  */
+struct udisk_read_stat {
+    u32 read_cnt; ///<读请求次数
+    u32 sectors; ///<读取的扇区总数
+    u32 ra_hit; ///<顺序读命中预读次数
+    u32 ra_miss; ///<非顺序读次数(需重新发cbw)
+    u32 cbw_cnt; ///<发出的READ_10 cbw次数
+    u32 drop_sectors; ///<预读后被丢弃的扇区数
+};
 
 /**@enum    usb_sta
   * @brief  USB设备当前状态
@@ -90,6 +103,10 @@ struct mass_storage {
     u8 need_send_csw; ///<需要发送csw标志位
     u8 *udisk_512_buf; ///<U盘512K大小BUFFER指针
     u32 async_prev_lba; ///<异步模式上一次地址
+#if UDISK_READ_512_ASYNC_ENABLE
+    u16 ra_window; ///<当前预读窗口扇区数
+    struct udisk_read_stat rd_stat; ///<预读统计
+#endif
 #endif
 #if ENABLE_DISK_HOTPLUG
     u8 media_sta_cur; ///<当前媒介状态                //for card reader, card removable
@@ -128,4 +145,23 @@ int usb_msd_parser(struct usb_host_device *host_dev, u8 interface_num, const u8
   */
 int _usb_stor_async_wait_sem(struct usb_host_device *host_dev);
 
+/**@brief   获取U盘预读统计信息
+  * @param[out] stat 统计信息
+  * @param[in]  reset 读取后清零
+  * @return     0:成功
+  * @par    示例：
+  * @code
+  * usb_stor_read_stat_get(&stat, 0);
+  * @encode
+  */
+int usb_stor_read_stat_get(struct udisk_read_stat *stat, u8 reset);
+
+/**@brief   打印U盘预读统计信息
+  * @par    示例：
+  * @code
+  * usb_stor_read_stat_dump();
+  * @encode
+  */
+void usb_stor_read_stat_dump(void);
+
 #endif
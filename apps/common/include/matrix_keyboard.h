@@ -26,6 +26,14 @@ typedef struct _matrix_key_st {
 } matrix_key_st;
 
 
+struct matrix_key_stat {
+    u32 scan;           //扫描次数
+    u32 wakeup;         //row边沿唤醒次数
+    u32 ghost;          //检测到鬼键风险的扫描次数
+    u32 last_cost;      //最近一次扫描耗时(TICK_CNT计数)
+    u32 max_cost;       //单次扫描最大耗时(TICK_CNT计数)
+};
+
 typedef struct _matrix_key_param {
     u32 *row_pin_list;      //row线IO口列表
     u32 *col_pin_list;      //col线IO口列表
@@ -70,6 +78,8 @@ void matrix_key_wakeup_timeout_handler(void *arg);
 void matrix_key_wakeup_keep();
 void matrix_key_wakeup(u8 idx, u32 gpio);
 int matrix_key_init(matrix_key_param *param);
+void matrix_key_stat_get(struct matrix_key_stat *stat);
+void matrix_key_stat_dump(void);
 
 #define EX_MCU_ENTER_POWERDOWN()
 #define EX_MCU_EXIT_POWERDOWN(a)
@@ -10,7 +10,14 @@
 #define ADC_DEMO_BUF_NUM        2
 #define ADC_DEMO_IRQ_POINTS     256
 #define ADC_DEMO_BUFS_SIZE      (ADC_DEMO_BUF_NUM * ADC_DEMO_IRQ_POINTS)
+//kws_cbuf为无锁spsc_buf, 大小必须为2的幂
+#if KWS_VAD_ENABLE
+//VAD起点判定前的数据留在cbuf里回放给识别算法(1K ADC缓存 + 20帧预录)
+#define KWS_CBUF_SIZE 	(8 * 1024)
+#else
 #define KWS_CBUF_SIZE 	(ADC_DEMO_BUFS_SIZE * sizeof(s16))
+#endif
+SPSC_BUF_SIZE_CHECK(kws_cbuf, KWS_CBUF_SIZE);
 
 
 //==============================================//
@@ -49,7 +56,7 @@ struct jl_kws_audio {
     u8 kws_audio_state;
     OS_SEM rx_sem;
     struct kws_adc_mic *kws_adc;
-    cbuffer_t kws_cbuf;
+    spsc_buf_t kws_cbuf;
     u32 cbuf[KWS_CBUF_SIZE / 4];
 };
 
@@ -57,30 +64,33 @@ static struct jl_kws_audio *__kws_audio = NULL;
 
 extern struct audio_adc_hdl adc_hdl;
 
+//kws_cbuf水位达到一帧时唤醒kws任务, 不再每包post一次
+static void kws_cbuf_watermark(void *priv)
+{
+    os_sem_post((OS_SEM *)priv);
+}
+
+/*
+ * ADC中断里调用, 与kws任务之间通过spsc_buf无锁交接, 不需要关中断
+ */
 static void kws_adc_mic_output(void *priv, s16 *data, int len)
 {
     int wlen = 0;
 
-    local_irq_disable();/*防止关闭kws时，kws任务和aec任务互相打断导致释放信号量错误死机的问题*/
     if (__kws_audio == NULL) {
-        local_irq_enable();
         return;
     }
     if (__kws_audio->kws_audio_state != KWS_AUDIO_STATE_RUN) {
-        local_irq_enable();
         return;
     }
 
     /* kws_putchar('w'); */
-    wlen = cbuf_write(&(__kws_audio->kws_cbuf), data, len);
+    wlen = spsc_buf_write(&(__kws_audio->kws_cbuf), data, len);
     if (wlen < len) {
         kws_info("kws cbuf full");
     } else {
         //kws_debug("wlen: %d", wlen);
     }
-
-    os_sem_post(&(__kws_audio->rx_sem));
-    local_irq_enable();
 }
 
 
@@ -141,7 +151,9 @@ int jl_kws_audio_init(void)
 
     os_sem_create(&(__kws_audio->rx_sem), 0);
 
-    cbuf_init(&(__kws_audio->kws_cbuf), __kws_audio->cbuf, KWS_CBUF_SIZE);
+    spsc_buf_init(&(__kws_audio->kws_cbuf), __kws_audio->cbuf, KWS_CBUF_SIZE);
+    spsc_buf_set_watermark(&(__kws_audio->kws_cbuf), KWS_AUDIO_FRAME_BYTES,
+                           kws_cbuf_watermark, &(__kws_audio->rx_sem));
 
     audio_codec_clock_set(AUDIO_KWS_MODE, AUDIO_CODING_MSBC, 0);
     return ret;
@@ -159,7 +171,7 @@ u8 kws_aec_get_state(void)
             free(__kws_audio->kws_adc);
             __kws_audio->kws_adc = NULL;
 
-            cbuf_clear(&(__kws_audio->kws_cbuf));
+            spsc_buf_clear(&(__kws_audio->kws_cbuf));
             os_sem_set(&(__kws_audio->rx_sem), 0);
         }
     }
@@ -202,7 +214,10 @@ void kws_aec_data_output(void *priv, s16 *data, int len)
         __kws_audio->kws_adc = NULL;
     }
 
+    //aec任务调用, 关中断防止与kws任务关闭释放__kws_audio互相打断
+    local_irq_disable();
     kws_adc_mic_output(priv, data, len);
+    local_irq_enable();
 }
 
 
@@ -216,13 +231,13 @@ int jl_kws_audio_get_data(void *buf, u32 len)
         return 0;
     }
 
-    data_len = cbuf_get_data_len(&(__kws_audio->kws_cbuf));
+    data_len = spsc_buf_get_data_len(&(__kws_audio->kws_cbuf));
 
     if (data_len >= len) {
-        cbuf_read(&(__kws_audio->kws_cbuf), buf, len);
+        spsc_buf_read(&(__kws_audio->kws_cbuf), buf, len);
         rlen = len;
     } else {
-        os_sem_set(&(__kws_audio->rx_sem), 0);
+        //水位回调是边沿触发, 这里不能清信号量, 否则会丢掉已到达的唤醒
 #if TCFG_JL_KWS_AUDIO_DATA_FROM_EXTERN
         ret = os_sem_pend(&(__kws_audio->rx_sem), 100);
         if (ret == OS_TIMEOUT) {
@@ -236,6 +251,22 @@ int jl_kws_audio_get_data(void *buf, u32 len)
     return rlen;
 }
 
+/*
+ * 读指针回退len字节,把已读过的数据重新交给识别算法(VAD预录)
+ * 只回退没有被新数据覆盖的部分,返回实际回退的字节数
+ */
+u32 jl_kws_audio_rewind(u32 len)
+{
+    u32 rlen;
+
+    if (__kws_audio == NULL) {
+        return 0;
+    }
+    //给ADC中断保留一包的空间, 避免回退到正在写入的区域
+    rlen = spsc_buf_read_goback(&(__kws_audio->kws_cbuf), len, ADC_DEMO_IRQ_POINTS * sizeof(s16));
+
+    return rlen;
+}
 
 int jl_kws_audio_start(void)
 {
@@ -268,7 +299,7 @@ void jl_kws_audio_stop(void)
             __kws_audio->kws_adc = NULL;
         }
 
-        cbuf_clear(&(__kws_audio->kws_cbuf));
+        spsc_buf_clear(&(__kws_audio->kws_cbuf));
         os_sem_set(&(__kws_audio->rx_sem), 0);
     }
 }
@@ -24,6 +24,19 @@
 #endif /* #define KWS_DEBUG_ENABLE */
 
 
+//========================================//
+//        VAD门控: 静音时不跑识别算法     //
+//========================================//
+#define KWS_AUDIO_FRAME_BYTES 		320 	//与算法帧长一致, 16k 10ms
+
+#define KWS_VAD_ENABLE 				1
+#define KWS_VAD_PREROLL_FRAMES 		20 		//语音起点前回放的帧数(200ms)
+#define KWS_VAD_HANGOVER_FRAMES 	60 		//语音结束后继续识别的帧数, 需覆盖算法平滑窗
+#define KWS_VAD_ONSET_FRAMES 		2 		//连续多少帧判为语音才触发
+#define KWS_VAD_ENERGY_RATIO 		3 		//能量超过底噪多少倍判为语音
+#define KWS_VAD_ENERGY_MIN 			200 	//能量判决下限(平均绝对幅度)
+#define KWS_VAD_ZCR_MAX 			(KWS_AUDIO_FRAME_BYTES / 2 / 2) //过零率上限, 用于排除白噪声
+
 enum JL_KWS_ERR {
     JL_KWS_ERR_NONE = 0,
     JL_KWS_ERR_AUDIO_MIC_NO_BUF = -400,
@@ -58,6 +71,7 @@ extern int jl_kws_audio_start(void);
 extern void jl_kws_audio_stop(void);
 extern void jl_kws_audio_close(void);
 extern int jl_kws_audio_get_data(void *buf, u32 len);
+extern u32 jl_kws_audio_rewind(u32 len);
 
 //========================================//
 //            jl_kws_event API            //
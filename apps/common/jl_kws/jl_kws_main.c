@@ -6,10 +6,31 @@
 //==========================================================//
 // 					  KWS 语音识别                          //
 //==========================================================//
+#if KWS_VAD_ENABLE
+struct kws_vad {
+    u8 active; 			//当前处于语音段
+    u8 onset_cnt; 		//连续语音帧计数
+    u16 hangover; 		//语音段剩余拖尾帧数
+    u32 noise; 			//底噪估计(Q4, 平均绝对幅度)
+};
+#endif /* #if KWS_VAD_ENABLE */
+
+struct kws_stat {
+    u32 start_ms; 		//本统计周期起始时间
+    u32 frames; 		//收到的音频帧数
+    u32 detect_frames; 	//送入识别算法的帧数
+    u32 detect_ms; 		//识别算法累计耗时
+    u32 vad_onsets; 	//VAD语音起点次数
+};
+
 struct kws_speech_recognition {
     u8 task_init;
     u8 kws_state;
     u8 kws_task_state;
+#if KWS_VAD_ENABLE
+    struct kws_vad vad;
+#endif /* #if KWS_VAD_ENABLE */
+    struct kws_stat stat;
 };
 
 static struct kws_speech_recognition jl_kws = {0};
@@ -48,6 +69,89 @@ enum KWS_TASK_STATE {
 //=========== 线程名称
 #define THIS_TASK_NAME 		"kws"
 
+#define KWS_STAT_PERIOD_MS 	(60 * 1000)
+
+#if KWS_VAD_ENABLE
+static void kws_vad_reset(struct kws_vad *vad)
+{
+    vad->active = 0;
+    vad->onset_cnt = 0;
+    vad->hangover = 0;
+    vad->noise = KWS_VAD_ENERGY_MIN << 4;
+}
+
+/*
+ * 能量+过零率VAD, 每帧只做一次累加, 代价远小于识别算法
+ * 返回: 0-静音, 1-语音段内, 2-语音起点(需要回放预录数据)
+ */
+static int kws_vad_run(struct kws_vad *vad, const s16 *pcm, u32 points)
+{
+    u32 energy = 0;
+    u32 zcr = 0;
+    u32 thr;
+    u8 speech;
+
+    for (int i = 0; i < points; i++) {
+        energy += (pcm[i] < 0) ? -pcm[i] : pcm[i];
+        if (i && ((pcm[i] ^ pcm[i - 1]) < 0)) {
+            zcr++;
+        }
+    }
+    energy /= points;
+
+    thr = (vad->noise >> 4) * KWS_VAD_ENERGY_RATIO;
+    if (thr < KWS_VAD_ENERGY_MIN) {
+        thr = KWS_VAD_ENERGY_MIN;
+    }
+    speech = (energy > thr) && (zcr < KWS_VAD_ZCR_MAX);
+
+    if (!vad->active) {
+        //底噪跟踪: 下降快, 上升慢
+        if ((energy << 4) < vad->noise) {
+            vad->noise = energy << 4;
+        } else {
+            vad->noise += ((energy << 4) - vad->noise) >> 6;
+        }
+        if (!speech) {
+            vad->onset_cnt = 0;
+            return 0;
+        }
+        if (++vad->onset_cnt < KWS_VAD_ONSET_FRAMES) {
+            return 0;
+        }
+        vad->active = 1;
+        vad->hangover = KWS_VAD_HANGOVER_FRAMES;
+        return 2;
+    }
+
+    if (speech) {
+        vad->hangover = KWS_VAD_HANGOVER_FRAMES;
+    } else if (--vad->hangover == 0) {
+        vad->active = 0;
+        vad->onset_cnt = 0;
+        return 0;
+    }
+    return 1;
+}
+#endif /* #if KWS_VAD_ENABLE */
+
+static void kws_stat_dump(struct kws_stat *stat, u32 now)
+{
+    u32 period = now - stat->start_ms;
+
+    if (period < KWS_STAT_PERIOD_MS) {
+        return;
+    }
+    //算法占空比可用来估算平均电流: I_avg ≈ I_idle + duty * (I_kws - I_idle)
+    kws_info("kws stat %dms: frames %d, detect %d (%d/min), duty %d%%, cpu %dms, vad onset %d",
+             period, stat->frames, stat->detect_frames,
+             stat->detect_frames * 60 / (period / 1000),
+             stat->frames ? stat->detect_frames * 100 / stat->frames : 0,
+             stat->detect_ms, stat->vad_onsets);
+    memset(stat, 0, sizeof(*stat));
+    stat->start_ms = now;
+}
+
 static int kws_speech_recognition_run(void)
 {
     void *rbuf = 0;
@@ -55,6 +159,10 @@ static int kws_speech_recognition_run(void)
     u32 audio_data_len = 0;
     int ret = JL_KWS_ERR_NONE;
     int event = KWS_VOICE_EVENT_NONE;
+#if KWS_VAD_ENABLE
+    int vad_ret;
+#endif /* #if KWS_VAD_ENABLE */
+    u32 t;
 
     kws_info("%s", __func__);
 
@@ -69,6 +177,11 @@ static int kws_speech_recognition_run(void)
     }
 
     __this->kws_task_state = KWS_TASK_STATE_RUN;
+#if KWS_VAD_ENABLE
+    kws_vad_reset(&__this->vad);
+#endif /* #if KWS_VAD_ENABLE */
+    memset(&__this->stat, 0, sizeof(__this->stat));
+    __this->stat.start_ms = sys_timer_get_ms();
 
     while (1) {
         if (__this->kws_state != KWS_STATE_RUN) {
@@ -84,11 +197,31 @@ static int kws_speech_recognition_run(void)
         audio_data_len = jl_kws_audio_get_data(rbuf, rbuf_len);
 
         if (audio_data_len == rbuf_len) {
+            __this->stat.frames++;
+#if KWS_VAD_ENABLE
+            vad_ret = kws_vad_run(&__this->vad, (s16 *)rbuf, rbuf_len / sizeof(s16));
+            if (vad_ret == 0) {
+                kws_stat_dump(&__this->stat, sys_timer_get_ms());
+                continue;
+            }
+            if (vad_ret == 2) {
+                //语音起点: 回退读指针, 把起点前的数据连同当前帧一起送识别
+                __this->stat.vad_onsets++;
+                if (jl_kws_audio_rewind(KWS_VAD_PREROLL_FRAMES * rbuf_len)) {
+                    continue;
+                }
+            }
+#endif /* #if KWS_VAD_ENABLE */
             /* kws_putchar('r'); */
+            t = sys_timer_get_ms();
             event = jl_kws_algo_detect_run(rbuf, rbuf_len);
+            t = sys_timer_get_ms() - t;
+            __this->stat.detect_ms += t;
+            __this->stat.detect_frames++;
             if (event != KWS_VOICE_EVENT_NONE) {
                 jl_kws_event_state_update(event);
             }
+            kws_stat_dump(&__this->stat, sys_timer_get_ms());
         }
     }
 
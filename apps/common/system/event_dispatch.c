@@ -0,0 +1,338 @@
+#include "system/includes.h"
+#include "generic/jiffies.h"
+#include "app_config.h"
+
+/*
+ * 按事件类型分表分发 + 可合并的有界事件队列
+ *
+ * sys_event_notify()/register_sys_event_handler()在库里实现, 每个事件都要
+ * 遍历全部处理函数比较event_type/from. 这里挂一个SYS_ALL_EVENT的静态处理函数,
+ * 再按类型bit位直接取表分发.
+ *
+ * 鼠标位移等高频事件每次都走sys_event_notify()会把app_core的queue塞满,
+ * 这里先放入固定长度的队列, 同一key的未处理事件直接合并,
+ * 队列由空变非空时才发一个DEVICE_EVENT_FROM_EVENT_QUEUE事件唤醒app_core取出.
+ * 队列用关中断保护, 只包住slot的拷贝.
+ *
+ * 取出的事件没有分表处理函数时用sys_event_notify()转发, 要在app_core的queue里
+ * 再排一次, 转发后也不会再合并. 目前鼠标位移(omsensor_axis)的接收方不在本SDK里,
+ * 就走这条路径; 接收方用sys_event_table_register()注册后不再有这一次转发.
+ */
+
+#define LOG_TAG             "[EVENT_DISPATCH]"
+#define LOG_ERROR_ENABLE
+#define LOG_INFO_ENABLE
+#include "debug.h"
+
+#ifndef SYS_EVENT_TABLE_HANDLER_NUM
+#define SYS_EVENT_TABLE_HANDLER_NUM     16
+#endif
+#ifndef SYS_EVENT_QUEUE_LEN
+#define SYS_EVENT_QUEUE_LEN             8
+#endif
+
+#define SYS_EVENT_TYPE_NUM              16
+/*唤醒事件发出后超过该时间还未取队列, 认为唤醒事件丢失, 重发*/
+#define SYS_EVENT_KICK_TIMEOUT          100
+
+struct event_table_entry {
+    struct event_table_entry *next;
+    u32 from;
+    u8 priority;
+    void (*handler)(struct sys_event *);
+};
+
+struct event_queue_slot {
+    u32 key;
+    u32 post_ms;        /*第一次入队的时间, 合并不更新*/
+    sys_event_merge_t merge;
+    struct sys_event event;
+};
+
+struct event_queue_stat {
+    u32 post;           /*入队成功次数(含合并)*/
+    u32 merge;          /*合并次数*/
+    u32 drop;           /*队列满丢弃次数*/
+    u32 kick;           /*唤醒事件次数*/
+    u32 kick_retry;     /*唤醒事件超时重发次数*/
+    u32 dispatch;       /*取出分发的事件数*/
+    u32 lat_sum;        /*入队到分发的延时累计, ms*/
+    u16 lat_max;
+    u8 max_depth;
+};
+
+static struct event_table_entry table_entry[SYS_EVENT_TABLE_HANDLER_NUM];
+static struct event_table_entry *event_table[SYS_EVENT_TYPE_NUM];
+static u32 table_dispatch_cnt[SYS_EVENT_TYPE_NUM];
+
+static struct event_queue_slot queue_slot[SYS_EVENT_QUEUE_LEN];
+static u8 queue_order[SYS_EVENT_QUEUE_LEN];     /*按入队顺序记录slot下标*/
+static u8 queue_head;
+static u8 queue_num;
+static u8 queue_kick;
+static u32 queue_kick_ms;
+static struct event_queue_stat queue_stat;
+
+static inline int event_type_index(u32 type)
+{
+    if (!type || type >= BIT(SYS_EVENT_TYPE_NUM)) {
+        return -1;
+    }
+    return __builtin_ctz(type);
+}
+
+int sys_event_table_register(int event_type, int from, u8 priority,
+                             void (*handler)(struct sys_event *))
+{
+    struct event_table_entry *entry;
+    struct event_table_entry **pp;
+    u32 type = event_type & (BIT(SYS_EVENT_TYPE_NUM) - 1);
+    int n = 0;
+    int i;
+
+    while (type) {
+        int idx = __builtin_ctz(type);
+        type &= type - 1;
+
+        entry = NULL;
+        local_irq_disable();
+        for (i = 0; i < SYS_EVENT_TABLE_HANDLER_NUM; i++) {
+            if (!table_entry[i].handler) {
+                entry = &table_entry[i];
+                break;
+            }
+        }
+        if (!entry) {
+            local_irq_enable();
+            log_error("table full, type 0x%x", (u32)BIT(idx));
+            break;
+        }
+        entry->from = from;
+        entry->priority = priority;
+        entry->handler = handler;
+        /*priority相同时先注册的在前*/
+        for (pp = &event_table[idx]; *pp; pp = &(*pp)->next) {
+            if ((*pp)->priority < priority) {
+                break;
+            }
+        }
+        entry->next = *pp;
+        *pp = entry;
+        local_irq_enable();
+        n++;
+    }
+
+    return n ? 0 : -1;
+}
+
+void sys_event_table_unregister(void (*handler)(struct sys_event *))
+{
+    struct event_table_entry **pp;
+    struct event_table_entry *entry;
+    int i;
+
+    local_irq_disable();
+    for (i = 0; i < SYS_EVENT_TYPE_NUM; i++) {
+        pp = &event_table[i];
+        while (*pp) {
+            entry = *pp;
+            if (entry->handler == handler) {
+                *pp = entry->next;
+                memset(entry, 0, sizeof(*entry));
+            } else {
+                pp = &entry->next;
+            }
+        }
+    }
+    local_irq_enable();
+}
+
+static int __sys_event_table_dispatch(struct sys_event *e)
+{
+    struct event_table_entry *entry;
+    int idx = event_type_index(e->type);
+
+    if (idx < 0 || !event_table[idx]) {
+        return 0;
+    }
+    table_dispatch_cnt[idx]++;
+    /*注册/注销只在线程中做, 这里与其在同一线程, 不需要关中断*/
+    for (entry = event_table[idx]; entry; entry = entry->next) {
+        if (entry->from && entry->from != (u32)e->arg) {
+            continue;
+        }
+        entry->handler(e);
+        if (e->consumed) {
+            break;
+        }
+    }
+    return 1;
+}
+
+void sys_event_table_dispatch(struct sys_event *e)
+{
+    __sys_event_table_dispatch(e);
+}
+
+static void sys_event_queue_kick(void)
+{
+    struct sys_event e;
+
+    e.type = SYS_DEVICE_EVENT;
+    e.arg = (void *)DEVICE_EVENT_FROM_EVENT_QUEUE;
+    e.u.dev.event = 0;
+    e.u.dev.value = 0;
+    sys_event_notify(&e);
+}
+
+int sys_event_post_merge(struct sys_event *e, u32 key, sys_event_merge_t merge)
+{
+    struct event_queue_slot *slot = NULL;
+    u32 now = jiffies_msec();
+    u8 kick = 0;
+    int ret = 0;
+    int i;
+
+    if (!e->type) {
+        return -1;
+    }
+
+    local_irq_disable();
+    if (key) {
+        for (i = 0; i < queue_num; i++) {
+            slot = &queue_slot[queue_order[(queue_head + i) % SYS_EVENT_QUEUE_LEN]];
+            if (slot->key == key && slot->event.type == e->type) {
+                break;
+            }
+            slot = NULL;
+        }
+    }
+    if (slot) {
+        if (slot->merge) {
+            slot->merge(&slot->event, e);
+        } else {
+            memcpy(&slot->event, e, sizeof(*e));
+        }
+        queue_stat.merge++;
+    } else {
+        if (queue_num >= SYS_EVENT_QUEUE_LEN) {
+            queue_stat.drop++;
+            ret = -1;
+            goto __kick;
+        }
+        /*空闲slot: event.type为0*/
+        for (i = 0; i < SYS_EVENT_QUEUE_LEN; i++) {
+            if (!queue_slot[i].event.type) {
+                break;
+            }
+        }
+        slot = &queue_slot[i];
+        memcpy(&slot->event, e, sizeof(*e));
+        slot->event.consumed = 0;
+        slot->key = key;
+        slot->merge = merge;
+        slot->post_ms = now;
+        queue_order[(queue_head + queue_num) % SYS_EVENT_QUEUE_LEN] = i;
+        queue_num++;
+        if (queue_num > queue_stat.max_depth) {
+            queue_stat.max_depth = queue_num;
+        }
+    }
+    queue_stat.post++;
+
+__kick:
+    /*队列满也要检查, 唤醒事件丢失时靠这里恢复*/
+    if (!queue_kick) {
+        kick = 1;
+    } else if (now - queue_kick_ms > SYS_EVENT_KICK_TIMEOUT) {
+        queue_stat.kick_retry++;
+        kick = 1;
+    }
+    if (kick) {
+        queue_kick = 1;
+        queue_kick_ms = now;
+        queue_stat.kick++;
+    }
+    local_irq_enable();
+
+    if (kick) {
+        sys_event_queue_kick();
+    }
+    return ret;
+}
+
+static void sys_event_queue_drain(void)
+{
+    struct event_queue_slot *slot;
+    struct sys_event e;
+    u32 lat;
+
+    local_irq_disable();
+    /*先清标志, 取队列期间新入队的事件会再发唤醒事件*/
+    queue_kick = 0;
+    while (queue_num) {
+        slot = &queue_slot[queue_order[queue_head]];
+        memcpy(&e, &slot->event, sizeof(e));
+        lat = jiffies_msec() - slot->post_ms;
+        slot->event.type = 0;
+        queue_head = (queue_head + 1) % SYS_EVENT_QUEUE_LEN;
+        queue_num--;
+
+        queue_stat.dispatch++;
+        queue_stat.lat_sum += lat;
+        if (lat > queue_stat.lat_max) {
+            queue_stat.lat_max = lat > 0xffff ? 0xffff : lat;
+        }
+        local_irq_enable();
+
+        if (!__sys_event_table_dispatch(&e)) {
+            //没有分表处理函数, 再走一次app_core的queue交给旧的处理函数
+            sys_event_notify(&e);
+        }
+
+        local_irq_disable();
+    }
+    local_irq_enable();
+}
+
+void sys_event_axis_merge(struct sys_event *dst, const struct sys_event *src)
+{
+    s32 x = dst->u.axis.x + src->u.axis.x;
+    s32 y = dst->u.axis.y + src->u.axis.y;
+
+    dst->u.axis.event = src->u.axis.event;
+    dst->u.axis.x = x > 32767 ? 32767 : (x < -32768 ? -32768 : x);
+    dst->u.axis.y = y > 32767 ? 32767 : (y < -32768 ? -32768 : y);
+}
+
+static void sys_event_dispatch_handler(struct sys_event *e)
+{
+    if (e->type == SYS_DEVICE_EVENT && (u32)e->arg == DEVICE_EVENT_FROM_EVENT_QUEUE) {
+        sys_event_queue_drain();
+        sys_event_consume(e);
+        return;
+    }
+    __sys_event_table_dispatch(e);
+}
+SYS_EVENT_HANDLER(SYS_ALL_EVENT, sys_event_dispatch_handler, 4);
+
+void sys_event_dispatch_stat_dump(void)
+{
+    struct event_queue_stat s;
+    int i;
+
+    for (i = 0; i < SYS_EVENT_TYPE_NUM; i++) {
+        if (table_dispatch_cnt[i]) {
+            log_info("type 0x%x: dispatch %d", BIT(i), table_dispatch_cnt[i]);
+        }
+    }
+
+    local_irq_disable();
+    memcpy(&s, &queue_stat, sizeof(s));
+    local_irq_enable();
+    log_info("queue: post %d, merge %d, drop %d, max_depth %d/%d",
+             s.post, s.merge, s.drop, s.max_depth, SYS_EVENT_QUEUE_LEN);
+    log_info("queue: kick %d, kick_retry %d, dispatch %d, latency avg %d max %d ms",
+             s.kick, s.kick_retry, s.dispatch,
+             s.dispatch ? s.lat_sum / s.dispatch : 0, s.lat_max);
+}
@@ -0,0 +1,190 @@
+#include "system/includes.h"
+#include "app_config.h"
+
+/*
+ * slab内存池
+ *
+ * 协议栈/profile按包申请的小块内存(几十到几百字节)如果都走malloc,
+ * 长时间运行后堆会被打碎, 申请耗时也不确定.
+ * 这里按固定尺寸档预留内存池, 块在池内用单链表回收, 不再回到堆里.
+ */
+
+#define LOG_TAG             "[MEM_SLAB]"
+#define LOG_ERROR_ENABLE
+#define LOG_INFO_ENABLE
+#include "debug.h"
+
+/*各尺寸档的块数, 在app_config.h中配置, 为0则不使用该档*/
+#ifndef MEM_SLAB_32_NUM
+#define MEM_SLAB_32_NUM         0
+#endif
+#ifndef MEM_SLAB_64_NUM
+#define MEM_SLAB_64_NUM         0
+#endif
+#ifndef MEM_SLAB_128_NUM
+#define MEM_SLAB_128_NUM        0
+#endif
+#ifndef MEM_SLAB_256_NUM
+#define MEM_SLAB_256_NUM        0
+#endif
+
+#if MEM_SLAB_32_NUM
+MEM_SLAB_DEFINE(mem_slab_32, 32, MEM_SLAB_32_NUM);
+#endif
+#if MEM_SLAB_64_NUM
+MEM_SLAB_DEFINE(mem_slab_64, 64, MEM_SLAB_64_NUM);
+#endif
+#if MEM_SLAB_128_NUM
+MEM_SLAB_DEFINE(mem_slab_128, 128, MEM_SLAB_128_NUM);
+#endif
+#if MEM_SLAB_256_NUM
+MEM_SLAB_DEFINE(mem_slab_256, 256, MEM_SLAB_256_NUM);
+#endif
+
+/*按块大小从小到大排列*/
+static struct mem_slab *const slab_class[] = {
+#if MEM_SLAB_32_NUM
+    &mem_slab_32,
+#endif
+#if MEM_SLAB_64_NUM
+    &mem_slab_64,
+#endif
+#if MEM_SLAB_128_NUM
+    &mem_slab_128,
+#endif
+#if MEM_SLAB_256_NUM
+    &mem_slab_256,
+#endif
+    NULL,
+};
+
+static u32 slab_heap_big;       /*超过最大档, 退回堆的次数*/
+static u32 slab_heap_full;      /*各档都用完, 退回堆的次数*/
+
+void *mem_slab_alloc(struct mem_slab *slab)
+{
+    void *p;
+
+    local_irq_disable();
+    p = slab->free_list;
+    if (p) {
+        slab->free_list = *(void **)p;
+    } else if (slab->uninit < slab->blk_num) {
+        p = slab->buf + slab->blk_size * slab->uninit;
+        slab->uninit++;
+    } else {
+        slab->fail++;
+        local_irq_enable();
+        return NULL;
+    }
+    slab->alloc++;
+    slab->used++;
+    if (slab->used > slab->max_used) {
+        slab->max_used = slab->used;
+    }
+    local_irq_enable();
+
+    return p;
+}
+
+void mem_slab_free(struct mem_slab *slab, void *p)
+{
+    if (!p) {
+        return;
+    }
+    ASSERT(mem_slab_contain(slab, p), "%s free 0x%x\n", slab->name, (u32)p);
+
+    local_irq_disable();
+    *(void **)p = slab->free_list;
+    slab->free_list = p;
+    slab->used--;
+    local_irq_enable();
+}
+
+void *slab_try_alloc(size_t size)
+{
+    struct mem_slab *const *c;
+    u8 big = 1;
+    void *p;
+
+    for (c = slab_class; *c; c++) {
+        if ((*c)->blk_size >= size) {
+            break;
+        }
+    }
+    /*本档用完时借用更大的档*/
+    for (; *c; c++) {
+        big = 0;
+        p = mem_slab_alloc(*c);
+        if (p) {
+            return p;
+        }
+    }
+
+    local_irq_disable();
+    if (big) {
+        slab_heap_big++;
+    } else {
+        slab_heap_full++;
+    }
+    local_irq_enable();
+
+    return NULL;
+}
+
+int slab_try_free(void *p)
+{
+    struct mem_slab *const *c;
+
+    for (c = slab_class; *c; c++) {
+        if (mem_slab_contain(*c, p)) {
+            mem_slab_free(*c, p);
+            return 1;
+        }
+    }
+    return 0;
+}
+
+void *slab_malloc(size_t size)
+{
+    void *p = slab_try_alloc(size);
+
+    /*堆不能在中断里操作*/
+    if (!p && !cpu_in_irq()) {
+        p = malloc(size);
+    }
+    return p;
+}
+
+void *slab_zalloc(size_t size)
+{
+    void *p = slab_malloc(size);
+
+    if (p) {
+        memset(p, 0, size);
+    }
+    return p;
+}
+
+void slab_free(void *p)
+{
+    if (p && !slab_try_free(p)) {
+        free(p);
+    }
+}
+
+void mem_slab_stats(void)
+{
+    struct mem_slab *slab;
+    struct mem_slab s;
+
+    log_info("name: blk_size x blk_num, used, max_used, alloc, fail");
+    list_for_each_mem_slab(slab) {
+        local_irq_disable();
+        memcpy(&s, slab, sizeof(s));
+        local_irq_enable();
+        log_info("%s: %d x %d, %d, %d, %d, %d", s.name, s.blk_size, s.blk_num,
+                 s.used, s.max_used, s.alloc, s.fail);
+    }
+    log_info("to heap: big %d, full %d", slab_heap_big, slab_heap_full);
+}
@@ -0,0 +1,535 @@
+#include "system/includes.h"
+#include "system/timer.h"
+#include "os/os_api.h"
+#include "app_config.h"
+
+/*
+ * 可合并定时器(slack timer)
+ *
+ * 两级时间轮 + 远期链表, 插入/删除O(1):
+ *   lvl0: 64槽, 每槽1 tick       (0 ~ 640ms)
+ *   lvl1: 64槽, 每槽64 tick      (~ 40.96s)
+ *   far : 更远的定时器, lvl1每转一圈重新分配一次
+ * 所有定时器共用一个sys_timeout, 只在最近一个非空槽的时刻唤醒(tickless),
+ * 低功耗时由sys_timer负责唤醒系统. 到期时刻按slack对齐到粗边界, 让不同模块的定时器
+ * 落在同一个tick上, 一次唤醒处理多个.
+ *
+ * 回调统一在app_core线程中执行, 底层sys_timeout也只在app_core中添加/删除,
+ * 其它线程修改定时器后通过taskq通知app_core重新设置.
+ */
+
+#define LOG_TAG             "[TW]"
+#define LOG_ERROR_ENABLE
+#define LOG_INFO_ENABLE
+#include "debug.h"
+
+#define TW_TICK_MS          10
+#define TW_TIMER_NUM        24
+#define TW_LVL_BITS         6
+#define TW_LVL_SIZE         (1 << TW_LVL_BITS)
+#define TW_LVL_MASK         (TW_LVL_SIZE - 1)
+#define TW_LVL1_SPAN        (TW_LVL_SIZE * TW_LVL_SIZE)
+
+#define TW_CORE_TASK        "app_core"
+
+enum {
+    TW_LVL0 = 0,
+    TW_LVL1,
+    TW_FAR,
+    TW_FIRE,
+};
+
+struct tw_timer {
+    struct list_head entry;
+    void (*func)(void *priv);
+    void *priv;
+    const char *owner;
+    u32 period;         //tick, 0:timeout
+    u32 slack;          //tick
+    u32 deadline;       //最早到期时刻
+    u32 expires;        //对齐后的到期时刻, deadline <= expires <= deadline + slack
+    u32 fire_cnt;
+    u8 used;
+    u8 pending;         //在时间轮或待执行链表中
+    u8 lvl;             //所在的链表: TW_LVL0/TW_LVL1/TW_FAR/TW_FIRE
+    u8 idx;
+};
+
+struct tw_base {
+    u32 clk;            //下一个要处理的tick
+    u32 now;            //单调tick, 不受ms计数回绕影响
+    u32 last_ms;
+    struct list_head lvl0[TW_LVL_SIZE];
+    struct list_head lvl1[TW_LVL_SIZE];
+    struct list_head far;
+    u32 bitmap0[TW_LVL_SIZE / 32];
+    u32 bitmap1[TW_LVL_SIZE / 32];
+    u16 pending;        //时间轮中的定时器个数
+    u16 hw_timer;       //底层sys_timeout
+    u8 hw_armed;
+    u8 arm_post;        //已通知app_core重新设置
+    u32 hw_expires;
+    u32 wakeups;
+    u32 stat_begin;
+    os_taskq_t core_q;
+    u8 init;
+};
+
+static struct tw_timer tw_timer_tab[TW_TIMER_NUM];
+static struct tw_base tw;
+
+static void tw_arm(void);
+
+#define tw_bit_set(map, idx)    ((map)[(idx) >> 5] |= BIT((idx) & 31))
+#define tw_bit_clr(map, idx)    ((map)[(idx) >> 5] &= ~BIT((idx) & 31))
+#define tw_bit_test(map, idx)   ((map)[(idx) >> 5] & BIT((idx) & 31))
+
+static u32 tw_now(void)
+{
+    u32 ms = sys_timer_get_ms();
+    u32 ticks = (ms - tw.last_ms) / TW_TICK_MS;
+
+    tw.now += ticks;
+    tw.last_ms += ticks * TW_TICK_MS;
+    return tw.now;
+}
+
+/*
+ * 时间轮为空时clk可能落后很多, 添加前直接追上当前时刻
+ */
+static void tw_sync_clk(void)
+{
+    if (tw.pending == 0 && (s32)(tw.now - tw.clk) > 0) {
+        tw.clk = tw.now;
+    }
+}
+
+static void tw_init(void)
+{
+    int i;
+
+    for (i = 0; i < TW_LVL_SIZE; i++) {
+        INIT_LIST_HEAD(&tw.lvl0[i]);
+        INIT_LIST_HEAD(&tw.lvl1[i]);
+    }
+    INIT_LIST_HEAD(&tw.far);
+    tw.last_ms = sys_timer_get_ms();
+    tw.now = 0;
+    tw.clk = 0;
+    tw.stat_begin = 0;
+    tw.init = 1;
+}
+
+/*
+ * 在[deadline, deadline + slack]内选一个低位尽量多为0的时刻:
+ * 取不超过slack + 1的最大2的幂g, 向下对齐deadline + slack, 结果不会早于deadline
+ */
+static u32 tw_round(u32 deadline, u32 slack)
+{
+    u32 g;
+
+    if (slack == 0) {
+        return deadline;
+    }
+    g = 1 << (31 - __builtin_clz(slack + 1));
+    return (deadline + slack) & ~(g - 1);
+}
+
+static void tw_enqueue(struct tw_timer *t)
+{
+    u32 delta;
+    u32 idx;
+
+    if ((s32)(t->expires - tw.clk) < 0) {
+        t->expires = tw.clk;
+    }
+    delta = t->expires - tw.clk;
+
+    if (delta < TW_LVL_SIZE) {
+        idx = t->expires & TW_LVL_MASK;
+        list_add_tail(&t->entry, &tw.lvl0[idx]);
+        tw_bit_set(tw.bitmap0, idx);
+        t->lvl = TW_LVL0;
+    } else if (delta < TW_LVL1_SPAN) {
+        idx = (t->expires >> TW_LVL_BITS) & TW_LVL_MASK;
+        list_add_tail(&t->entry, &tw.lvl1[idx]);
+        tw_bit_set(tw.bitmap1, idx);
+        t->lvl = TW_LVL1;
+    } else {
+        idx = 0;
+        list_add_tail(&t->entry, &tw.far);
+        t->lvl = TW_FAR;
+    }
+    t->idx = idx;
+    t->pending = 1;
+    tw.pending++;
+}
+
+static void tw_dequeue(struct tw_timer *t)
+{
+    if (!t->pending) {
+        return;
+    }
+    list_del(&t->entry);
+    t->pending = 0;
+    if (t->lvl == TW_FIRE) {
+        return;
+    }
+    tw.pending--;
+
+    //删除的是槽里最后一个定时器时清掉对应位
+    if (t->lvl == TW_LVL0 && list_empty(&tw.lvl0[t->idx])) {
+        tw_bit_clr(tw.bitmap0, t->idx);
+    } else if (t->lvl == TW_LVL1 && list_empty(&tw.lvl1[t->idx])) {
+        tw_bit_clr(tw.bitmap1, t->idx);
+    }
+}
+
+static void tw_requeue_list(struct list_head *head)
+{
+    struct tw_timer *t, *n;
+    LIST_HEAD(tmp);
+
+    //先整体移走, 重新分配时可能又落回同一个槽
+    list_for_each_entry_safe(t, n, head, entry) {
+        list_move_tail(&t->entry, &tmp);
+    }
+    list_for_each_entry_safe(t, n, &tmp, entry) {
+        list_del(&t->entry);
+        t->pending = 0;
+        tw.pending--;
+        tw_enqueue(t);
+    }
+}
+
+/*
+ * 处理到now为止所有到期的槽, 到期的定时器移到fire链表
+ */
+static void tw_collect(u32 now, struct list_head *fire)
+{
+    struct tw_timer *t, *n;
+    u32 idx, idx1;
+
+    while ((s32)(now - tw.clk) >= 0) {
+        idx = tw.clk & TW_LVL_MASK;
+        if (idx == 0) {
+            idx1 = (tw.clk >> TW_LVL_BITS) & TW_LVL_MASK;
+            if (idx1 == 0) {
+                tw_requeue_list(&tw.far);
+            }
+            tw_bit_clr(tw.bitmap1, idx1);
+            tw_requeue_list(&tw.lvl1[idx1]);
+        }
+        if (tw_bit_test(tw.bitmap0, idx)) {
+            tw_bit_clr(tw.bitmap0, idx);
+            list_for_each_entry_safe(t, n, &tw.lvl0[idx], entry) {
+                list_del(&t->entry);
+                list_add_tail(&t->entry, fire);
+                t->lvl = TW_FIRE;
+                tw.pending--;
+            }
+        }
+        tw.clk++;
+
+        //lvl0全空时直接跳到下一个需要搬移lvl1的边界
+        if (!tw.bitmap0[0] && !tw.bitmap0[1]) {
+            u32 next = (tw.clk + TW_LVL_MASK) & ~TW_LVL_MASK;
+            if ((s32)(next - now) > 0) {
+                next = now + 1;
+            }
+            tw.clk = next;
+        }
+    }
+}
+
+static int tw_bitmap_next(const u32 *map, u32 from, u32 *dist)
+{
+    u32 i, idx;
+
+    if (!map[0] && !map[1]) {
+        return 0;
+    }
+    for (i = 0; i < TW_LVL_SIZE; i++) {
+        idx = (from + i) & TW_LVL_MASK;
+        if (tw_bit_test(map, idx)) {
+            *dist = i;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/*
+ * 最近一次需要处理时间轮的时刻, 返回0表示没有定时器
+ */
+static int tw_next_event(u32 *next)
+{
+    u32 dist;
+    u32 blk;
+    u32 t;
+    int found = 0;
+
+    if (tw_bitmap_next(tw.bitmap0, tw.clk, &dist)) {
+        *next = tw.clk + dist;
+        found = 1;
+    }
+    //clk不在块边界时当前块的lvl1槽已搬移过, 从下一块开始找
+    blk = (tw.clk + TW_LVL_MASK) >> TW_LVL_BITS;
+    if (tw_bitmap_next(tw.bitmap1, blk, &dist)) {
+        t = (blk + dist) << TW_LVL_BITS;
+        if (!found || (s32)(t - *next) < 0) {
+            *next = t;
+        }
+        found = 1;
+    }
+    if (!list_empty(&tw.far)) {
+        t = (tw.clk + TW_LVL1_SPAN - 1) & ~(TW_LVL1_SPAN - 1);
+        if (!found || (s32)(t - *next) < 0) {
+            *next = t;
+        }
+        found = 1;
+    }
+    return found;
+}
+
+static void tw_hw_timeout(void *priv)
+{
+    struct tw_timer *t;
+    void (*func)(void *priv);
+    void *arg;
+    LIST_HEAD(fire);
+    u32 now;
+
+    tw.hw_armed = 0;
+    tw.hw_timer = 0;
+    tw.wakeups++;
+
+    local_irq_disable();
+    now = tw_now();
+    tw_collect(now, &fire);
+    local_irq_enable();
+
+    //逐个取出执行, 回调里可以删除/修改任意定时器
+    while (1) {
+        local_irq_disable();
+        if (list_empty(&fire)) {
+            local_irq_enable();
+            break;
+        }
+        t = list_first_entry(&fire, struct tw_timer, entry);
+        list_del(&t->entry);
+        t->pending = 0;
+        t->fire_cnt++;
+        func = t->func;
+        arg = t->priv;
+        if (t->period) {
+            t->deadline += t->period;
+            if ((s32)(t->deadline - now) <= 0) {
+                t->deadline = now + t->period;
+            }
+            t->expires = tw_round(t->deadline, t->slack);
+            tw_enqueue(t);
+        } else {
+            t->used = 0;
+        }
+        local_irq_enable();
+
+        func(arg);
+    }
+
+    tw_arm();
+}
+
+/*
+ * 只在app_core中调用
+ */
+static void tw_arm(void)
+{
+    u32 next;
+    u32 now;
+    int found;
+
+    local_irq_disable();
+    tw.arm_post = 0;
+    now = tw_now();
+    found = tw_next_event(&next);
+    if (found && tw.hw_armed && tw.hw_expires == next) {
+        local_irq_enable();
+        return;
+    }
+    local_irq_enable();
+
+    if (tw.hw_armed) {
+        sys_timeout_del(tw.hw_timer);
+        tw.hw_armed = 0;
+        tw.hw_timer = 0;
+    }
+    if (!found) {
+        return;
+    }
+    if ((s32)(next - now) <= 0) {
+        next = now + 1;
+    }
+    tw.hw_expires = next;
+    tw.hw_timer = sys_timeout_add(NULL, tw_hw_timeout, (next - now) * TW_TICK_MS);
+    tw.hw_armed = 1;
+}
+
+/*
+ * 新的定时器比底层定时器更早到期时才需要重新设置
+ */
+static void tw_arm_update(void)
+{
+    int argv[2];
+    u32 next;
+    int need;
+
+    local_irq_disable();
+    need = tw_next_event(&next) && (!tw.hw_armed || (s32)(next - tw.hw_expires) < 0);
+    if (need && !cpu_in_irq() && !strcmp(os_current_task(), TW_CORE_TASK)) {
+        local_irq_enable();
+        tw_arm();
+        return;
+    }
+    if (need && !tw.arm_post) {
+        tw.arm_post = 1;
+    } else {
+        need = 0;
+    }
+    local_irq_enable();
+
+    if (need) {
+        if (!tw.core_q) {
+            tw.core_q = os_taskq_get_handle(TW_CORE_TASK);
+        }
+        argv[0] = (int)tw_arm;
+        argv[1] = 0;
+        if (os_taskq_post_h(tw.core_q, Q_CALLBACK, ARRAY_SIZE(argv), argv)) {
+            tw.arm_post = 0;
+            log_error("arm post fail");
+        }
+    }
+}
+
+u16 __sys_slack_timer_add(void *priv, void (*func)(void *priv), u32 msec, u32 slack,
+                          u8 periodic, const char *owner)
+{
+    struct tw_timer *t = NULL;
+    u32 ticks;
+    int i;
+
+    ticks = (msec + TW_TICK_MS - 1) / TW_TICK_MS;
+    if (ticks == 0) {
+        ticks = 1;
+    }
+
+    local_irq_disable();
+    if (!tw.init) {
+        tw_init();
+    }
+    for (i = 0; i < TW_TIMER_NUM; i++) {
+        if (!tw_timer_tab[i].used) {
+            t = &tw_timer_tab[i];
+            break;
+        }
+    }
+    if (!t) {
+        local_irq_enable();
+        log_error("no timer for %s", owner);
+        return 0;
+    }
+    memset(t, 0, sizeof(*t));
+    t->used = 1;
+    t->func = func;
+    t->priv = priv;
+    t->owner = owner;
+    t->period = periodic ? ticks : 0;
+    t->slack = slack / TW_TICK_MS;
+    t->deadline = tw_now() + ticks;
+    t->expires = tw_round(t->deadline, t->slack);
+    tw_sync_clk();
+    tw_enqueue(t);
+    local_irq_enable();
+
+    tw_arm_update();
+    return i + 1;
+}
+
+void sys_slack_timer_del(u16 id)
+{
+    struct tw_timer *t;
+
+    if (id == 0 || id > TW_TIMER_NUM) {
+        return;
+    }
+    t = &tw_timer_tab[id - 1];
+
+    //提前到期的唤醒不需要撤销, 到时只会重新设置一次
+    local_irq_disable();
+    tw_dequeue(t);
+    t->used = 0;
+    local_irq_enable();
+}
+
+int sys_slack_timer_modify(u16 id, u32 msec)
+{
+    struct tw_timer *t;
+    u32 ticks;
+
+    if (id == 0 || id > TW_TIMER_NUM) {
+        return -EINVAL;
+    }
+    t = &tw_timer_tab[id - 1];
+    ticks = (msec + TW_TICK_MS - 1) / TW_TICK_MS;
+    if (ticks == 0) {
+        ticks = 1;
+    }
+
+    local_irq_disable();
+    if (!t->used) {
+        local_irq_enable();
+        return -EINVAL;
+    }
+    tw_dequeue(t);
+    if (t->period) {
+        t->period = ticks;
+    }
+    t->deadline = tw_now() + ticks;
+    t->expires = tw_round(t->deadline, t->slack);
+    tw_sync_clk();
+    tw_enqueue(t);
+    local_irq_enable();
+
+    tw_arm_update();
+    return 0;
+}
+
+void sys_slack_timer_dump(void)
+{
+    u32 elapsed_ms;
+    u32 fires = 0;
+    int i;
+
+    local_irq_disable();
+    elapsed_ms = (tw_now() - tw.stat_begin) * TW_TICK_MS;
+    local_irq_enable();
+    if (elapsed_ms == 0) {
+        return;
+    }
+
+    /*每秒次数放大100倍打印*/
+    for (i = 0; i < TW_TIMER_NUM; i++) {
+        struct tw_timer *t = &tw_timer_tab[i];
+        if (!t->used) {
+            continue;
+        }
+        fires += t->fire_cnt;
+        log_info("%d %s: period %d ms, slack %d ms, fire %d, %d.%02d/s", i + 1, t->owner,
+                 t->period * TW_TICK_MS, t->slack * TW_TICK_MS, t->fire_cnt,
+                 (u32)((u64)t->fire_cnt * 100000 / elapsed_ms) / 100,
+                 (u32)((u64)t->fire_cnt * 100000 / elapsed_ms) % 100);
+    }
+    log_info("wakeups %d, %d.%02d/s, callbacks %d", tw.wakeups,
+             (u32)((u64)tw.wakeups * 100000 / elapsed_ms) / 100,
+             (u32)((u64)tw.wakeups * 100000 / elapsed_ms) % 100, fires);
+}
@@ -391,7 +391,7 @@ static void hilink_netcfgver(uint8_t msg_id)
     hilink_data_rsp(msg_id, payload, payload_len, CMD_TYPE_RSP, MSG_WITHOUT_ENCRY);
 
     cJSON_Delete(root);
-    free(cjson_str);
+    slab_free(cjson_str);
     free(payload);
 }
 
@@ -410,7 +410,7 @@ static void hilink_conn_reject(uint8_t msg_id, uint8_t *service_name, uint8_t na
     hilink_data_rsp(msg_id, payload, payload_len, CMD_TYPE_RSP, MSG_WITHOUT_ENCRY);
 
     cJSON_Delete(rsp);
-    free(cjson_str);
+    slab_free(cjson_str);
     free(payload);
 }
 
@@ -464,7 +464,7 @@ static void hilink_deviceinfo(uint8_t msg_id)
 
     cJSON_Delete(root);
     hilink_data_rsp(msg_id, payload, payload_len, CMD_TYPE_RSP, MSG_WITHOUT_ENCRY);
-    free(cjson_str);
+    slab_free(cjson_str);
     free(payload);
 }
 
@@ -513,7 +513,7 @@ static void hilink_authsetup(uint8_t msg_id, uint8_t *data, uint16_t data_len)
 
     hilink_auth_info_store();
     cJSON_Delete(rsp);
-    free(cjson_str);
+    slab_free(cjson_str);
     free(payload);
 
     hilink_set_conn_finish(1);
@@ -588,7 +588,7 @@ static void hilink_createsession(uint8_t msg_id, uint8_t *data, uint16_t data_le
     hilink_data_rsp(msg_id, payload, payload_len, CMD_TYPE_RSP, MSG_WITHOUT_ENCRY);
     cJSON_Delete(root);
     cJSON_Delete(rsp);
-    free(cjson_str);
+    slab_free(cjson_str);
     free(payload);
 }
 
@@ -700,7 +700,7 @@ static void hilink_customsecdata(uint8_t msg_id, uint8_t *data, uint16_t data_le
 
     mbedtls_gcm_free(&context);
     cJSON_Delete(rsp);
-    free(cjson_str);
+    slab_free(cjson_str);
     free(encrydata);
     free(decrydata);
 }
@@ -786,7 +786,7 @@ static void hilink_cleardevreginfo(uint8_t msg_id, uint8_t *data, uint16_t data_
 
     cJSON_Delete(rsp);
     mbedtls_gcm_free(&context);
-    free(cjson_str);
+    slab_free(cjson_str);
     free(encrydata);
     free(decrydata);
 }
@@ -873,7 +873,7 @@ static int hilink_state_report()
     hilink_encry_report_send(cjson_str, cjson_len);
 
     cJSON_Delete(root);
-    free(cjson_str);
+    slab_free(cjson_str);
 
     return 0;
 }
@@ -904,7 +904,7 @@ static int hilink_time_info_report()
     hilink_encry_report_send(cjson_str, cjson_len);
 
     cJSON_Delete(root);
-    free(cjson_str);
+    slab_free(cjson_str);
 }
 
 /*
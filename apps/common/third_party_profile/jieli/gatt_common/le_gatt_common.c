@@ -645,6 +645,10 @@ static void __ble_comm_cbk_packet_handler(uint8_t packet_type, uint16_t channel,
             case HCI_SUBEVENT_LE_PHY_UPDATE_COMPLETE:
                 ADD_HANDLER_ROLE(__just_conn_handle_role(little_endian_read_16(packet, 4)));
                 break;
+
+            case HCI_SUBEVENT_LE_VENDOR_INTERVAL_COMPLETE:
+                ADD_HANDLER_ROLE(__just_conn_handle_role(little_endian_read_16(packet, 3)));
+                break;
             }
             break;
 
@@ -59,6 +59,7 @@ typedef enum {
     GATT_COMM_EVENT_CONNECTION_UPDATE_COMPLETE,/*链路连接参数更新完成*/
     GATT_COMM_EVENT_CONNECTION_PHY_UPDATE_COMPLETE,/*链路速率更新*/
     GATT_COMM_EVENT_CONNECTION_DATA_LENGTH_CHANGE,/*DLE更新*/
+    GATT_COMM_EVENT_CONNECTION_INTERVAL,/*连接事件结束(anchor点),需先调用ble_vendor_interval_event_enable使能*/
 
     /*======master + slave*/
     //type:gatt common
@@ -506,6 +506,12 @@ void ble_gatt_server_cbk_packet_handler(uint8_t packet_type, uint16_t channel, u
                 log_info("Rx PHY: %s\n", server_phy_result[hci_event_le_meta_get_phy_update_complete_rx_phy(packet)]);
                 __gatt_server_event_callback_handler(GATT_COMM_EVENT_CONNECTION_PHY_UPDATE_COMPLETE, tmp_val, 2, packet);
                 break;
+
+            //每个连接事件上报一次, 不打印
+            case HCI_SUBEVENT_LE_VENDOR_INTERVAL_COMPLETE:
+                tmp_val[0] = little_endian_read_16(packet, 3);
+                __gatt_server_event_callback_handler(GATT_COMM_EVENT_CONNECTION_INTERVAL, tmp_val, 2, packet);
+                break;
             }
             break;
 
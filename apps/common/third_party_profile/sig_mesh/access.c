@@ -1055,6 +1055,7 @@ int bt_mesh_comp_register(const struct bt_mesh_comp *comp)
     }
 
     dev_comp = comp;
+    bt_mesh_comp_cache_invalidate();
 
     err = 0;
 
@@ -1094,6 +1095,7 @@ int bt_mesh_comp2_register(const struct bt_mesh_comp2 *comp2)
     }
 
     dev_comp2 = comp2;
+    bt_mesh_comp_cache_invalidate();
 
     return 0;
 }
@@ -1764,6 +1766,7 @@ static int mod_rel_register(const struct bt_mesh_model *base,
             mod_rel_list[i].idx_ext == 0) {
             memcpy(&mod_rel_list[i], &extension,
                    sizeof(extension));
+            bt_mesh_comp_cache_invalidate();
             return 0;
         }
     }
@@ -1926,7 +1929,146 @@ void bt_mesh_model_pub_store(const struct bt_mesh_model *mod)
     bt_mesh_settings_store_schedule(BT_MESH_SETTINGS_MOD_PENDING);
 }
 
-int bt_mesh_comp_data_get_page(struct net_buf_simple *buf, size_t page, size_t offset)
+static int comp_data_build_page(struct net_buf_simple *buf, size_t page, size_t offset);
+
+#if (CONFIG_BT_MESH_COMP_CACHE)
+/* Up to this many elements (or page 2 records) are tracked per cached page,
+ * larger compositions are rebuilt on every read.
+ */
+#define COMP_CACHE_SEG_MAX 16
+
+/* Last serialised Composition Data page. The end offset of every element
+ * is kept, so a read at any offset reports whole elements only, exactly
+ * like building the page from that offset would.
+ */
+static struct {
+    u8_t page;
+    u8_t valid: 1,
+         hdr: 1;            /* seg 0 is the page 0 header, never split off */
+    u8_t seg_cnt;
+    u16_t len;
+    u16_t seg_end[COMP_CACHE_SEG_MAX];
+    u8_t data[CONFIG_BT_MESH_COMP_PST_BUF_SIZE];
+} comp_cache;
+
+void bt_mesh_comp_cache_invalidate(void)
+{
+    comp_cache.valid = 0;
+}
+
+static int comp_cache_seg_add(size_t *end, size_t size)
+{
+    if (comp_cache.seg_cnt >= COMP_CACHE_SEG_MAX) {
+        return -ENOMEM;
+    }
+
+    *end += size;
+    comp_cache.seg_end[comp_cache.seg_cnt++] = *end;
+
+    return 0;
+}
+
+/* Serialise a page into the cache buffer. The page is only marked valid
+ * for slicing if it was complete and its element table fit.
+ */
+static int comp_cache_fill(u8_t page)
+{
+    struct net_buf_simple buf = {
+        .data = comp_cache.data,
+        .len = 0,
+        .size = sizeof(comp_cache.data),
+        .__buf = comp_cache.data,
+    };
+    const struct bt_mesh_comp *comp = bt_mesh_comp_get();
+    size_t end = 0;
+    int i, err;
+
+    if (comp_cache.valid && comp_cache.page == page) {
+        return 0;
+    }
+
+    comp_cache.valid = 0;
+    comp_cache.seg_cnt = 0;
+    comp_cache.hdr = 0;
+    comp_cache.len = 0;
+
+    err = comp_data_build_page(&buf, page, 0);
+    if (err) {
+        return err;
+    }
+
+    comp_cache.page = page;
+    comp_cache.len = buf.len;
+
+    if (page == 0) {
+        comp_cache.hdr = 1;
+        err = comp_cache_seg_add(&end, 10);
+        for (i = 0; !err && i < comp->elem_count; i++) {
+            err = comp_cache_seg_add(&end, bt_mesh_comp_elem_size(&comp->elem[i]));
+        }
+    } else if (IS_ENABLED(CONFIG_BT_MESH_COMP_PAGE_1) && page == 1) {
+        for (i = 0; !err && i < comp->elem_count; i++) {
+            err = comp_cache_seg_add(&end, page1_elem_size(&comp->elem[i]));
+        }
+    } else {
+        for (i = 0; !err && i < dev_comp2->record_cnt; i++) {
+            err = comp_cache_seg_add(&end, 8 + dev_comp2->record[i].elem_offset_cnt +
+                                     dev_comp2->record[i].data_len);
+        }
+    }
+
+    /* Truncated page or too many elements: usable for storing, not slicing */
+    comp_cache.valid = (!err && end == buf.len);
+
+    LOG_DBG("Cached CDP%u (%u bytes) %svalid", page, comp_cache.len,
+            comp_cache.valid ? "" : "in");
+
+    return 0;
+}
+
+static int comp_cache_read(struct net_buf_simple *buf, u8_t page, size_t offset)
+{
+    size_t start = 0;
+    size_t from;
+    int i;
+
+    if (comp_cache_fill(page) || !comp_cache.valid) {
+        return -ENOENT;
+    }
+
+    for (i = 0; i < comp_cache.seg_cnt; start = comp_cache.seg_end[i++]) {
+        if (offset >= comp_cache.seg_end[i]) {
+            continue;
+        }
+
+        from = MAX(offset, start);
+
+        if ((i > 0 || !comp_cache.hdr) &&
+            net_buf_simple_tailroom(buf) < ((comp_cache.seg_end[i] - from) + BT_MESH_MIC_SHORT)) {
+            if (IS_ENABLED(CONFIG_BT_MESH_LARGE_COMP_DATA_SRV)) {
+                /* MshPRTv1.1: 4.4.1.2.2:
+                 * If the complete list of models does not fit in the Data field,
+                 * the element shall not be reported.
+                 */
+                return 0;
+            }
+
+            LOG_ERR("Too large device composition");
+            return -E2BIG;
+        }
+
+        net_buf_simple_add_mem(buf, &comp_cache.data[from], comp_cache.seg_end[i] - from);
+    }
+
+    return 0;
+}
+#else
+void bt_mesh_comp_cache_invalidate(void)
+{
+}
+#endif /* CONFIG_BT_MESH_COMP_CACHE */
+
+static int comp_data_build_page(struct net_buf_simple *buf, size_t page, size_t offset)
 {
     if (page == 0 || page == 128) {
         return bt_mesh_comp_data_get_page_0(buf, offset);
@@ -1939,6 +2081,20 @@ int bt_mesh_comp_data_get_page(struct net_buf_simple *buf, size_t page, size_t o
     return -EINVAL;
 }
 
+int bt_mesh_comp_data_get_page(struct net_buf_simple *buf, size_t page, size_t offset)
+{
+#if (CONFIG_BT_MESH_COMP_CACHE)
+    /* Pages 128-130 are the same as 0-2 until the composition changes */
+    int err = comp_cache_read(buf, page & 0x7f, offset);
+
+    if (err != -ENOENT) {
+        return err;
+    }
+#endif /* CONFIG_BT_MESH_COMP_CACHE */
+
+    return comp_data_build_page(buf, page, offset);
+}
+
 size_t comp_page_0_size(void)
 {
     const struct bt_mesh_comp *comp;
@@ -2000,6 +2156,24 @@ size_t bt_mesh_comp_page_size(uint8_t page)
 
 int bt_mesh_comp_store(void)
 {
+#if (CONFIG_BT_MESH_COMP_CACHE)
+    int err;
+
+    /* Store straight from the page cache, no second serialisation buffer */
+    for (int i = 0; i < ARRAY_SIZE(comp_data_pages); i++) {
+        err = comp_cache_fill(comp_data_pages[i].page);
+        if (err) {
+            LOG_ERR("Failed to read CDP%d: %d", comp_data_pages[i].page, err);
+            return err;
+        }
+
+        node_info_store(comp_data_pages[i].path, comp_cache.data, comp_cache.len);
+
+        LOG_DBG("Stored CDP%d", comp_data_pages[i].page);
+    }
+
+    return 0;
+#else
     NET_BUF_SIMPLE_DEFINE(buf, CONFIG_BT_MESH_COMP_PST_BUF_SIZE);
     int err;
 
@@ -2027,6 +2201,7 @@ int bt_mesh_comp_store(void)
     }
 
     return 0;
+#endif /* CONFIG_BT_MESH_COMP_CACHE */
 }
 
 int bt_mesh_comp_change_prepare(void)
@@ -71,11 +71,56 @@ static const u8_t adv_type[] = {
 
 static sys_timer mesh_AdvSend_timer;
 
+#if (CONFIG_BT_MESH_ADV_SCHED)
+
+enum {
+    ADV_SCHED_Q_LOCAL,
+    ADV_SCHED_Q_FRIEND,
+    ADV_SCHED_Q_RELAY,
+
+    ADV_SCHED_Q_NUM,
+};
+
+struct adv_sched_queue {
+    sys_slist_t list;
+    u8 weight;
+    u8 credit;
+    u8 depth;
+    u8 depth_max;
+    u32 enqueued;
+    u32 sent;
+    u32 dropped;
+    u32 latency_sum;
+    u32 latency_max;
+};
+
+static struct adv_sched_queue adv_sched[ADV_SCHED_Q_NUM] = {
+    [ADV_SCHED_Q_LOCAL]  = {
+        .weight = CONFIG_BT_MESH_ADV_SCHED_LOCAL_WEIGHT,
+        .credit = CONFIG_BT_MESH_ADV_SCHED_LOCAL_WEIGHT,
+    },
+    [ADV_SCHED_Q_FRIEND] = {
+        .weight = CONFIG_BT_MESH_ADV_SCHED_FRIEND_WEIGHT,
+        .credit = CONFIG_BT_MESH_ADV_SCHED_FRIEND_WEIGHT,
+    },
+    [ADV_SCHED_Q_RELAY]  = {
+        .weight = CONFIG_BT_MESH_ADV_SCHED_RELAY_WEIGHT,
+        .credit = CONFIG_BT_MESH_ADV_SCHED_RELAY_WEIGHT,
+    },
+};
+
+/* On-air duration of an adv waiting out its relay back-off */
+static u16 adv_sched_delayed_duration;
+
+#else
+
 static sys_slist_t adv_list = {
     .head = NULL,
     .tail = NULL,
 };
 
+#endif /* CONFIG_BT_MESH_ADV_SCHED */
+
 static void ble_adv_enable(bool en);
 static bool adv_send(struct bt_mesh_adv *adv);
 static void fresh_adv_info(struct bt_mesh_adv *adv);
@@ -88,10 +133,171 @@ extern bool get_if_connecting(void);
 extern void bt_mesh_adv_buf_alloc(void);
 void ble_set_scan_enable(bool en);
 
+#if (CONFIG_BT_MESH_ADV_SCHED)
+
+static struct adv_sched_queue *adv_sched_queue_get(struct bt_mesh_adv *adv)
+{
+    switch (adv->ctx.tag) {
+    case BT_MESH_ADV_TAG_RELAY:
+        return &adv_sched[ADV_SCHED_Q_RELAY];
+    case BT_MESH_ADV_TAG_FRIEND:
+        return &adv_sched[ADV_SCHED_Q_FRIEND];
+    default:
+        return &adv_sched[ADV_SCHED_Q_LOCAL];
+    }
+}
+
+static bool adv_sched_is_queued(struct adv_sched_queue *q, struct bt_mesh_adv *adv)
+{
+    struct bt_mesh_adv *queued;
+
+    SYS_SLIST_FOR_EACH_CONTAINER(&q->list, queued, node) {
+        if ((queued->b.len == adv->b.len) &&
+            !memcmp(queued->b.data, adv->b.data, adv->b.len)) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static void adv_sched_put(struct bt_mesh_adv *adv)
+{
+    struct adv_sched_queue *q = adv_sched_queue_get(adv);
+
+    adv->node.next = 0;
+    net_buf_slist_simple_put(&q->list, &adv->node);
+
+    if (++q->depth > q->depth_max) {
+        q->depth_max = q->depth;
+    }
+}
+
+/* Weighted round-robin: the highest priority backlogged queue which still
+ * has credit wins the slot, credits are refilled once every backlogged
+ * queue has spent its share, so relays cannot starve local traffic and
+ * local traffic cannot starve relays.
+ */
+static struct bt_mesh_adv *adv_sched_get(void)
+{
+    struct adv_sched_queue *q;
+    struct bt_mesh_adv *adv = NULL;
+
+    OS_ENTER_CRITICAL();
+
+    for (u8 round = 0; (round < 2) && !adv; round++) {
+        for (u8 i = 0; i < ADV_SCHED_Q_NUM; i++) {
+            q = &adv_sched[i];
+            if (sys_slist_is_empty(&q->list) || (0 == q->credit)) {
+                continue;
+            }
+
+            q->credit--;
+            q->depth--;
+            adv = net_buf_slist_simple_get(&q->list);
+            break;
+        }
+
+        if (!adv) {
+            for (u8 i = 0; i < ADV_SCHED_Q_NUM; i++) {
+                adv_sched[i].credit = adv_sched[i].weight;
+            }
+        }
+    }
+
+    OS_EXIT_CRITICAL();
+
+    return adv;
+}
+
+static u16 adv_sched_dispatch(struct bt_mesh_adv *adv)
+{
+    struct adv_sched_queue *q = adv_sched_queue_get(adv);
+    u32 latency = k_uptime_get_32() - adv->timestamp;
+
+    q->sent++;
+    q->latency_sum += latency;
+    if (latency > q->latency_max) {
+        q->latency_max = latency;
+    }
+
+    if ((BT_MESH_ADV_TAG_RELAY == adv->ctx.tag) && CONFIG_BT_MESH_ADV_SCHED_RELAY_JITTER_MS) {
+        return rand32() % (CONFIG_BT_MESH_ADV_SCHED_RELAY_JITTER_MS + 1);
+    }
+
+    return 0;
+}
+
+void bt_mesh_adv_sched_weight_set(u8_t local, u8_t friend, u8_t relay)
+{
+    OS_ENTER_CRITICAL();
+
+    adv_sched[ADV_SCHED_Q_LOCAL].weight  = local ? local : 1;
+    adv_sched[ADV_SCHED_Q_FRIEND].weight = friend ? friend : 1;
+    adv_sched[ADV_SCHED_Q_RELAY].weight  = relay ? relay : 1;
+
+    for (u8 i = 0; i < ADV_SCHED_Q_NUM; i++) {
+        adv_sched[i].credit = adv_sched[i].weight;
+    }
+
+    OS_EXIT_CRITICAL();
+}
+
+void bt_mesh_adv_sched_dump(void)
+{
+    static const char *const name[ADV_SCHED_Q_NUM] = {
+        [ADV_SCHED_Q_LOCAL]  = "local",
+        [ADV_SCHED_Q_FRIEND] = "friend",
+        [ADV_SCHED_Q_RELAY]  = "relay",
+    };
+    struct adv_sched_queue *q;
+
+    for (u8 i = 0; i < ADV_SCHED_Q_NUM; i++) {
+        q = &adv_sched[i];
+        printf("adv_sched %s w:%d depth:%d/%d enq:%d sent:%d drop:%d lat avg:%dms max:%dms\n",
+               name[i], q->weight, q->depth, q->depth_max,
+               q->enqueued, q->sent, q->dropped,
+               q->sent ? (q->latency_sum / q->sent) : 0, q->latency_max);
+    }
+}
+
+void bt_mesh_adv_sched_reset(void)
+{
+    struct adv_sched_queue *q;
+
+    OS_ENTER_CRITICAL();
+
+    for (u8 i = 0; i < ADV_SCHED_Q_NUM; i++) {
+        q = &adv_sched[i];
+        q->depth_max = q->depth;
+        q->enqueued = 0;
+        q->sent = 0;
+        q->dropped = 0;
+        q->latency_sum = 0;
+        q->latency_max = 0;
+    }
+
+    OS_EXIT_CRITICAL();
+}
+
+#endif /* CONFIG_BT_MESH_ADV_SCHED */
+
 static u16 mesh_adv_send_start(void *param)
 {
     struct bt_mesh_adv *buf = param;
 
+#if (CONFIG_BT_MESH_ADV_SCHED)
+    /* Relay back-off elapsed, go on air now. */
+    if (adv_sched_delayed_duration) {
+        u16 duration = adv_sched_delayed_duration;
+
+        adv_sched_delayed_duration = 0;
+        fresh_adv_info(buf);
+
+        return duration;
+    }
+#endif /* CONFIG_BT_MESH_ADV_SCHED */
+
     // if (BT_MESH_ADV(buf)->delay) {   //Don't run these because BT_MESH_ADV(buf)->delay can't be 1.
     //     BT_MESH_ADV(buf)->delay = 0;
     // fresh_adv_info(buf);
@@ -124,7 +330,11 @@ static void mesh_adv_send_end(void *param)
 
 
     struct bt_mesh_adv *prev_adv;
+#if (CONFIG_BT_MESH_ADV_SCHED)
+    prev_adv = adv_sched_get();
+#else
     prev_adv = net_buf_slist_simple_get(&adv_list);
+#endif /* CONFIG_BT_MESH_ADV_SCHED */
     LOG_DBG("%s prev_adv %p data %p busy %d ", __func__, prev_adv, prev_adv->ctx.busy);
 
     if (prev_adv && prev_adv->ctx.busy) {
@@ -265,8 +475,12 @@ static bool adv_send(struct bt_mesh_adv *adv)
     OS_ENTER_CRITICAL();
 
     if (TRUE == mesh_adv_send_timer_busy()) {    // not used now.
+#if (CONFIG_BT_MESH_ADV_SCHED)
+        adv_sched_put(adv);
+#else
         adv->node.next = 0;
         net_buf_slist_simple_put(&adv_list, &adv->node);
+#endif /* CONFIG_BT_MESH_ADV_SCHED */
 
         LOG_DBG("send timer busy. adv %p ", adv);
 
@@ -294,9 +508,16 @@ static bool adv_send(struct bt_mesh_adv *adv)
         }
     }
 
+#if (CONFIG_BT_MESH_ADV_SCHED)
+    delay = adv_sched_dispatch(adv);
+#endif /* CONFIG_BT_MESH_ADV_SCHED */
+
     if (0 == delay) {
         fresh_adv_info(adv);
     } else {
+#if (CONFIG_BT_MESH_ADV_SCHED)
+        adv_sched_delayed_duration = duration;
+#endif /* CONFIG_BT_MESH_ADV_SCHED */
         // BT_MESH_ADV(buf)->delay = 1; //for compiler, not used now.
     }
 
@@ -354,21 +575,6 @@ void bt_mesh_adv_gatt_update(void)
     }
 }
 
-void newbuf_replace(struct net_buf_pool *pool)
-{
-    struct net_buf *buf;
-
-    buf = net_buf_slist_simple_get(&adv_list);
-
-    BT_MESH_ADV(buf)->ctx.busy = 0;
-
-    buf->ref = 0;
-
-    buf->flags = 0;
-
-    pool->free_count++;
-}
-
 void bt_mesh_adv_send(struct bt_mesh_adv *adv, const struct bt_mesh_send_cb *cb,
                       void *cb_data)
 {
@@ -378,6 +584,29 @@ void bt_mesh_adv_send(struct bt_mesh_adv *adv, const struct bt_mesh_send_cb *cb,
 
     adv->ctx.cb = cb;
     adv->ctx.cb_data = cb_data;
+
+#if (CONFIG_BT_MESH_ADV_SCHED)
+    struct adv_sched_queue *q = adv_sched_queue_get(adv);
+
+    OS_ENTER_CRITICAL();
+
+    /* The same relayed PDU can arrive over several bearers, keep one copy. */
+    if (CONFIG_BT_MESH_ADV_SCHED_RELAY_DEDUP &&
+        (BT_MESH_ADV_TAG_RELAY == adv->ctx.tag) &&
+        adv_sched_is_queued(q, adv)) {
+        q->dropped++;
+        OS_EXIT_CRITICAL();
+        LOG_DBG("drop duplicate relay adv %p", adv);
+        bt_mesh_adv_send_start(0, -EALREADY, &adv->ctx);
+        return;
+    }
+
+    q->enqueued++;
+    adv->timestamp = k_uptime_get_32();
+
+    OS_EXIT_CRITICAL();
+#endif /* CONFIG_BT_MESH_ADV_SCHED */
+
     adv->ctx.busy = 1U;
 
     bt_mesh_adv_ref(adv);
@@ -79,6 +79,18 @@ static struct bt_mesh_adv *adv_pool;
 #else
 static struct bt_mesh_adv adv_pool[CONFIG_BT_MESH_ADV_BUF_COUNT];
 #endif /* NET_BUF_USE_MALLOC */
+
+/* slab块直接落在adv_pool上, 块大小须与数组步长一致 */
+BUILD_ASSERT(sizeof(struct bt_mesh_adv) == MEM_SLAB_BLK_SIZE(sizeof(struct bt_mesh_adv)),
+             "bt_mesh_adv size must be 4-byte aligned");
+
+/* adv按包申请释放, 用adv_pool做slab池, 池满时退回堆;
+ * malloc模式下adv_pool在bt_mesh_adv_buf_alloc()里才分配, 之前池为空 */
+#if NET_BUF_USE_MALLOC
+MEM_SLAB_DEFINE_BUF(mesh_adv_slab, NULL, sizeof(struct bt_mesh_adv), 0);
+#else
+MEM_SLAB_DEFINE_BUF(mesh_adv_slab, adv_pool, sizeof(struct bt_mesh_adv), CONFIG_BT_MESH_ADV_BUF_COUNT);
+#endif
 void bt_mesh_adv_send_start(u16_t duration, int err, struct bt_mesh_adv_ctx *ctx)
 {
     if (!ctx->started) {
@@ -118,7 +130,10 @@ static struct bt_mesh_adv *adv_create_from_pool(struct k_mem_slab *buf_pool,
     }
 
     // err = k_mem_slab_alloc(buf_pool, (void **)&adv, timeout);
-    adv = malloc(sizeof(struct bt_mesh_adv));
+    adv = mem_slab_alloc(&mesh_adv_slab);
+    if (!adv) {
+        adv = malloc(sizeof(struct bt_mesh_adv));
+    }
 
     if (!adv) {
         return NULL;
@@ -172,7 +187,11 @@ void bt_mesh_adv_unref(struct bt_mesh_adv *adv)
 #endif
 
     // k_mem_slab_free(slab, (void *)adv);	//for compiler, not used now.
-    free((void *)adv);
+    if (mem_slab_contain(&mesh_adv_slab, adv)) {
+        mem_slab_free(&mesh_adv_slab, adv);
+    } else {
+        free((void *)adv);
+    }
 }
 
 struct bt_mesh_adv *bt_mesh_adv_create(enum bt_mesh_adv_type type,
@@ -315,6 +334,9 @@ void bt_mesh_adv_buf_alloc(void)
                    net_buf_p, net_buf_data_p, (struct bt_mesh_adv *)adv_pool_p,
                    config_bt_mesh_adv_buf_count);
 
+    mesh_adv_slab.buf = (u8 *)adv_pool;
+    mesh_adv_slab.blk_num = config_bt_mesh_adv_buf_count;
+
     LOG_DBG("total buf_size=0x%x", buf_size);
     LOG_DBG("net_buf addr=0x%x", net_buf_p);
     LOG_DBG("net_buf_data addr=0x%x", net_buf_data_p);
@@ -325,6 +347,13 @@ void bt_mesh_adv_buf_alloc(void)
 
 void bt_mesh_adv_buf_free(void)
 {
+    local_irq_disable();
+    mesh_adv_slab.buf = NULL;
+    mesh_adv_slab.blk_num = 0;
+    mesh_adv_slab.free_list = NULL;
+    mesh_adv_slab.uninit = 0;
+    mesh_adv_slab.used = 0;
+    local_irq_enable();
     free(NET_BUF_FREE(adv_buf_pool));
 }
 #endif /* NET_BUF_USE_MALLOC */
@@ -74,6 +74,11 @@ struct bt_mesh_adv {
 
     uint8_t __ref;
 
+#if (CONFIG_BT_MESH_ADV_SCHED)
+    /* Uptime (ms) when queued, for tx scheduler latency metrics */
+    u32_t timestamp;
+#endif /* CONFIG_BT_MESH_ADV_SCHED */
+
     uint8_t __bufs[BT_MESH_ADV_DATA_SIZE];
 };
 
@@ -128,6 +133,18 @@ void bt_mesh_adv_send_start(u16_t duration, int err, struct bt_mesh_adv_ctx *ctx
 
 int bt_mesh_scan_active_set(bool active);
 
+#if (CONFIG_BT_MESH_ADV_SCHED)
+/* Set weighted round-robin ratio between local, friend and relay queues,
+ * a weight of 0 is treated as 1 so no queue can be starved.
+ */
+void bt_mesh_adv_sched_weight_set(u8_t local, u8_t friend, u8_t relay);
+
+/* Print per-queue depth, drop and latency counters. */
+void bt_mesh_adv_sched_dump(void);
+
+void bt_mesh_adv_sched_reset(void);
+#endif /* CONFIG_BT_MESH_ADV_SCHED */
+
 int bt_mesh_adv_bt_data_send(uint8_t num_events, u16_t adv_interval,
                              const struct bt_data *ad, size_t ad_len);
 
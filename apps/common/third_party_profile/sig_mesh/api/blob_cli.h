@@ -51,6 +51,9 @@ struct bt_mesh_blob_target {
 
     /** Target node's Pull mode context.
      *  Needs to be initialized when sending a BLOB in Pull mode.
+     *  Optional in Push mode: when set and sending to each Target node
+     *  individually, missing chunks are only resent to the Target nodes
+     *  that reported them.
      */
     struct bt_mesh_blob_target_pull *pull;
 
@@ -311,6 +314,16 @@ struct bt_mesh_blob_cli {
     enum bt_mesh_blob_cli_state state;
     struct bt_mesh_blob_block block;
     struct bt_mesh_blob_cli_caps caps;
+
+    /* Transfer statistics, logged when the transfer ends. Distribution
+     * time against target count is measured on hardware from this log;
+     * the mesh stack needs the mesh app's model_api.h, so it has no host
+     * build to run a simulation against.
+     */
+    struct {
+        u32_t start_time;
+        u32_t chunk_tx;
+    } stat;
 };
 
 /** @brief Retrieve transfer capabilities for a list of Target nodes.
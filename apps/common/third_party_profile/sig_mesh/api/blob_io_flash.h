@@ -31,6 +31,19 @@ struct bt_mesh_blob_io_flash {
 
     /* Internal flash area pointer. */
     const struct flash_area *area;
+#if (CONFIG_BT_MESH_BLOB_IO_FLASH_WRITE_BEHIND)
+    /* Write-behind block buffer: the completed block waiting to be
+     * written to flash.
+     */
+    struct {
+        u32_t offset;
+        u32_t size;
+        u16_t chunk_size;
+        u8_t  pending;
+    } wb;
+    /* Flushes the pending block outside the chunk receive path. */
+    struct k_work_delayable wb_flush;
+#endif
     /* BLOB stream. */
     struct bt_mesh_blob_io io;
 };
@@ -657,6 +657,42 @@ int bt_mesh_lpn_set(bool enable);
  */
 int bt_mesh_lpn_poll(void);
 
+/** @brief Set the latency the application can tolerate for downlink data.
+ *
+ *  The adaptive poll engine never lets the Friend Poll interval grow above
+ *  this value while backing off. Zero removes the hint, leaving the interval
+ *  bounded by the PollTimeout only. Values above the PollTimeout are clamped
+ *  to it.
+ *
+ *  @param latency_ms  Maximum poll interval in milliseconds.
+ *
+ *  @return Zero on success or (negative) error code otherwise.
+ */
+int bt_mesh_lpn_poll_latency_set(u32_t latency_ms);
+
+/** Low Power Node radio activity since the last reset. */
+struct bt_mesh_lpn_radio_stat {
+    /** Length of the measurement window in milliseconds. */
+    u32_t window;
+    /** Time spent scanning for Friend responses in milliseconds. */
+    u32_t scan;
+    /** Time spent advertising requests in milliseconds. */
+    u32_t tx;
+    /** Friend Polls sent. */
+    u32_t polls;
+    /** Data messages received from the Friend. */
+    u32_t data;
+    /** Radio-on time extrapolated to one hour, in milliseconds. */
+    u32_t on_per_hour;
+};
+
+/** @brief Get Low Power Node radio activity statistics.
+ *
+ *  @param stat   Statistics output.
+ *  @param reset  Start a new measurement window after reading.
+ */
+void bt_mesh_lpn_radio_stat_get(struct bt_mesh_lpn_radio_stat *stat, bool reset);
+
 /** Low Power Node callback functions. */
 struct bt_mesh_lpn_cb {
     /** @brief Friendship established.
@@ -162,6 +162,12 @@
 #define CONFIG_BT_MESH_LPN_INIT_POLL_TIMEOUT    config_bt_mesh_lpn_init_poll_timeout // 300
 #define CONFIG_BT_MESH_LPN_RSSI_FACTOR          config_bt_mesh_lpn_rssi_factor // 0
 #define CONFIG_BT_MESH_LPN_RECV_WIN_FACTOR      config_bt_mesh_lpn_recv_win_factor // 0
+/* Adaptive poll: poll every BURST_TIMEOUT ms for BURST_COUNT responses
+ * after receiving data, then back off exponentially up to PollTimeout.
+ */
+#define CONFIG_BT_MESH_LPN_POLL_ADAPTIVE        1
+#define CONFIG_BT_MESH_LPN_POLL_BURST_TIMEOUT   300
+#define CONFIG_BT_MESH_LPN_POLL_BURST_COUNT     4
 #endif /* CONFIG_BT_MESH_LOW_POWER */
 
 /* Net buffer config */
@@ -271,6 +277,17 @@
 #define CONFIG_BT_MESH_BLOB_BLOCK_SIZE_MIN      4096
 #define CONFIG_BT_MESH_BLOB_BLOCK_SIZE_MAX      4096
 #define CONFIG_BT_MESH_BLOB_CHUNK_COUNT_MAX     256
+/* Collect each received block in RAM and write it to flash in chunk order
+ * after the block completes, instead of one flash write per chunk. The write
+ * is deferred until the block status has been sent, but k_work runs on the
+ * same task as the mesh stack, so it is not concurrent with reception.
+ * Costs one CONFIG_BT_MESH_BLOB_BLOCK_SIZE_MAX buffer.
+ */
+#if (CONFIG_MESH_MODEL == SIG_MESH_DFU_TARGET_DEMO)
+#define CONFIG_BT_MESH_BLOB_IO_FLASH_WRITE_BEHIND   1
+#else
+#define CONFIG_BT_MESH_BLOB_IO_FLASH_WRITE_BEHIND   0
+#endif
 #define CONFIG_BT_MESH_DFU_METADATA             1
 #define CONFIG_BT_MESH_DFU_METADATA_MAXLEN      32
 #define CONFIG_BT_MESH_DFU_FWID_MAXLEN          8
@@ -366,6 +383,11 @@
 #define CONFIG_BT_MESH_SAR_RX_ACK_RETRANS_COUNT 0x00 //range 0x00 0x03 default 0x00
 
 #define CONFIG_BT_MESH_COMP_PST_BUF_SIZE        600
+/* Keep the last requested Composition Data page serialised (costs
+ * CONFIG_BT_MESH_COMP_PST_BUF_SIZE bytes of RAM), so chunked reads are
+ * served by copying instead of rebuilding the page.
+ */
+#define CONFIG_BT_MESH_COMP_CACHE               1
 
 #define CONFIG_BT_MESH_CFG_CLI_TIMEOUT          6000
 
@@ -376,6 +398,17 @@
 
 #define CONFIG_BT_EXT_ADV_MAX_ADV_SET                   2
 
+/* Adv tx scheduler config */
+#define CONFIG_BT_MESH_ADV_SCHED                        1
+/* Weighted round-robin slots per round: local > friend > relay */
+#define CONFIG_BT_MESH_ADV_SCHED_LOCAL_WEIGHT           4
+#define CONFIG_BT_MESH_ADV_SCHED_FRIEND_WEIGHT          2
+#define CONFIG_BT_MESH_ADV_SCHED_RELAY_WEIGHT           1
+/* Random back-off before a relayed PDU goes on air, 0 ~ n ms */
+#define CONFIG_BT_MESH_ADV_SCHED_RELAY_JITTER_MS        10
+/* Drop a relay PDU whose payload is already waiting in the relay queue */
+#define CONFIG_BT_MESH_ADV_SCHED_RELAY_DEDUP            1
+
 /* Keys config */
 #define CONFIG_BT_MESH_USES_TINYCRYPT           1
 #define CONFIG_BT_MESH_USES_MBEDTLS_PSA         0
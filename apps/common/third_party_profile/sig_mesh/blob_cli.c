@@ -216,6 +216,10 @@ static u16_t next_missing_chunk(struct bt_mesh_blob_cli *cli,
     return idx;
 }
 
+/* Push mode unicast: resend only what each target reported missing, if it has a bitmap. */
+#define PUSH_TARGET_FILTER(cli, target) ((cli)->xfer->mode == BT_MESH_BLOB_XFER_MODE_PUSH && \
+					 (target)->pull && UNICAST_MODE(cli))
+
 /* Used in Pull mode to collect all missing chunks from each target in cli->block.missing. */
 static void update_missing_chunks(struct bt_mesh_blob_cli *cli)
 {
@@ -292,7 +296,16 @@ static void block_set(struct bt_mesh_blob_cli *cli, u16_t block_idx)
         DIV_ROUND_UP(cli->block.size, cli->xfer->chunk_size);
 
     if (cli->xfer->mode == BT_MESH_BLOB_XFER_MODE_PUSH) {
+        struct bt_mesh_blob_target *target;
+
         blob_chunk_missing_set_all(&cli->block);
+
+        TARGETS_FOR_EACH(cli, target) {
+            if (target->pull) {
+                memcpy(target->pull->missing, cli->block.missing,
+                       sizeof(target->pull->missing));
+            }
+        }
     } else {
         struct bt_mesh_blob_target *target;
 
@@ -320,9 +333,21 @@ static void suspend(struct bt_mesh_blob_cli *cli)
 static void end(struct bt_mesh_blob_cli *cli, bool success)
 {
     const struct bt_mesh_blob_xfer *xfer = cli->xfer;
+    struct bt_mesh_blob_target *target;
+    u16_t targets = 0;
 
     LOG_INF(">>> %s %u", __func__, success);
 
+    TARGETS_FOR_EACH(cli, target) {
+        if (target->status == BT_MESH_BLOB_SUCCESS) {
+            targets++;
+        }
+    }
+
+    LOG_INF("BLOB %u bytes to %u targets in %u ms, %u chunk tx (%u chunks)",
+            xfer->size, targets, k_uptime_get_32() - cli->stat.start_time,
+            cli->stat.chunk_tx, DIV_ROUND_UP(xfer->size, xfer->chunk_size));
+
     io_close(cli);
     cli_state_reset(cli);
     if (cli->cb && cli->cb->end) {
@@ -392,6 +417,13 @@ static struct bt_mesh_blob_target *next_target(struct bt_mesh_blob_cli *cli,
             goto next;
         }
 
+        if (cli->state == BT_MESH_BLOB_CLI_STATE_BLOCK_SEND &&
+            PUSH_TARGET_FILTER(cli, *current) &&
+            !blob_chunk_missing_get((*current)->pull->missing, cli->chunk_idx)) {
+            /* Target already has this chunk, only others asked for it again. */
+            goto next;
+        }
+
         break;
 
 next:
@@ -711,6 +743,8 @@ static void chunk_tx(struct bt_mesh_blob_cli *cli, u16_t dst)
         return;
     }
 
+    cli->stat.chunk_tx++;
+
     tx(cli, dst, &buf);
 }
 
@@ -1195,6 +1229,10 @@ static void rx_block_status(struct bt_mesh_blob_cli *cli,
         LOG_DBG("Target 0x%04x received all chunks", target->addr);
     } else if (block->missing == BT_MESH_BLOB_CHUNKS_MISSING_ALL) {
         blob_chunk_missing_set_all(&cli->block);
+
+        if (PUSH_TARGET_FILTER(cli, target)) {
+            memcpy(target->pull->missing, cli->block.missing, sizeof(target->pull->missing));
+        }
     } else if (cli->xfer->mode == BT_MESH_BLOB_XFER_MODE_PULL) {
         memcpy(target->pull->missing, block->block.missing, sizeof(block->block.missing));
 
@@ -1207,9 +1245,16 @@ static void rx_block_status(struct bt_mesh_blob_cli *cli,
          */
         target->pull->block_report_timestamp = 0ll;
     } else {
+        /* The union of all reports is the set to resend; each target's own
+         * report decides whether it is addressed for a given chunk.
+         */
         for (int i = 0; i < ARRAY_SIZE(block->block.missing); ++i) {
             cli->block.missing[i] |= block->block.missing[i];
         }
+
+        if (PUSH_TARGET_FILTER(cli, target)) {
+            memcpy(target->pull->missing, block->block.missing, sizeof(target->pull->missing));
+        }
     }
 
     if (SENDING_CHUNKS_IN_PULL_MODE(cli)) {
@@ -1571,6 +1616,8 @@ int bt_mesh_blob_cli_send(struct bt_mesh_blob_cli *cli,
     cli->xfer = xfer;
     cli->inputs = inputs;
     cli->io = io;
+    cli->stat.start_time = k_uptime_get_32();
+    cli->stat.chunk_tx = 0;
 
     if (cli->xfer->block_size_log == 0x20) {
         cli->block_count = 1;
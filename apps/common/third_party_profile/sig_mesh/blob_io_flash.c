@@ -27,6 +27,47 @@
 
 #define FLASH_IO(_io) CONTAINER_OF(_io, struct bt_mesh_blob_io_flash, io)
 
+#if (CONFIG_BT_MESH_BLOB_IO_FLASH_WRITE_BEHIND)
+static u8_t wb_buf[CONFIG_BT_MESH_BLOB_BLOCK_SIZE_MAX] __attribute__((aligned(4)));
+
+static void wb_write(struct bt_mesh_blob_io_flash *flash)
+{
+    u32_t offset;
+    u16_t len;
+
+    if (!flash->wb.pending) {
+        return;
+    }
+
+    LOG_DBG(">>> flush block offset %d size %d", flash->wb.offset, flash->wb.size);
+
+    /* Hand the block over in chunk order, whatever order the chunks came in */
+    for (offset = 0; offset < flash->wb.size; offset += len) {
+        len = MIN(flash->wb.chunk_size, flash->wb.size - offset);
+#if CONFIG_BT_MESH_DFU_TARGET
+        mesh_targe_ota_process(DFU_NODE_OTA_DATA, &wb_buf[offset], len,
+                               flash->wb.size, offset);
+#endif
+    }
+
+    flash->wb.pending = 0;
+}
+
+static void wb_flush(struct k_work *work)
+{
+    struct bt_mesh_blob_io_flash *flash =
+        CONTAINER_OF(work, struct bt_mesh_blob_io_flash, wb_flush.work);
+
+    wb_write(flash);
+}
+
+static void wb_reset(struct bt_mesh_blob_io_flash *flash)
+{
+    k_work_cancel_delayable(&flash->wb_flush);
+    memset(&flash->wb, 0, sizeof(flash->wb));
+}
+#endif /* CONFIG_BT_MESH_BLOB_IO_FLASH_WRITE_BEHIND */
+
 static int test_flash_area(u8_t area_id)
 {
     // test flash area can used or not.
@@ -40,6 +81,9 @@ static int io_open(const struct bt_mesh_blob_io *io,
     struct bt_mesh_blob_io_flash *flash = FLASH_IO(io);
 
     flash->mode = mode;
+#if (CONFIG_BT_MESH_BLOB_IO_FLASH_WRITE_BEHIND)
+    wb_reset(flash);
+#endif
 #if CONFIG_BT_MESH_DFU_DIST
     mesh_dist_loader_init(R_TYPE);
 #endif
@@ -51,6 +95,12 @@ static void io_close(const struct bt_mesh_blob_io *io,
 {
     struct bt_mesh_blob_io_flash *flash = FLASH_IO(io);
 
+#if (CONFIG_BT_MESH_BLOB_IO_FLASH_WRITE_BEHIND)
+    /* Completed blocks are flushed by block_end(), anything left is an
+     * aborted transfer.
+     */
+    wb_reset(flash);
+#endif
     // flash_area_close(flash->area);
 }
 
@@ -67,6 +117,16 @@ static int block_start(const struct bt_mesh_blob_io *io,
 
     erase_size = block->size;
 
+#if (CONFIG_BT_MESH_BLOB_IO_FLASH_WRITE_BEHIND)
+    if (block->size > sizeof(wb_buf)) {
+        return -EINVAL;
+    }
+
+    /* The previous block must reach flash before the buffer is reused */
+    k_work_cancel_delayable(&flash->wb_flush);
+    wb_write(flash);
+#endif
+
     return 0;//flash_area_flatten(flash->area, flash->offset + block->offset, erase_size);
 }
 
@@ -96,13 +156,48 @@ static int wr_chunk(const struct bt_mesh_blob_io *io,
     LOG_DBG(">>> flash->offset %d block->offset %d chunk->offset %d", flash->offset,
             block->offset, chunk->offset);
 
-#if CONFIG_BT_MESH_DFU_TARGET
+#if (CONFIG_BT_MESH_BLOB_IO_FLASH_WRITE_BEHIND)
+    if (chunk->offset + chunk->size > block->size) {
+        return -EINVAL;
+    }
+
+    memcpy(&wb_buf[chunk->offset], chunk->data, chunk->size);
+#elif CONFIG_BT_MESH_DFU_TARGET
     mesh_targe_ota_process(DFU_NODE_OTA_DATA, chunk->data, chunk->size, block->size, chunk->offset);
 #endif
 
     return 0;
 }
 
+#if (CONFIG_BT_MESH_BLOB_IO_FLASH_WRITE_BEHIND)
+static void block_end(const struct bt_mesh_blob_io *io,
+                      const struct bt_mesh_blob_xfer *xfer,
+                      const struct bt_mesh_blob_block *block)
+{
+    struct bt_mesh_blob_io_flash *flash = FLASH_IO(io);
+
+    if (flash->mode == BT_MESH_BLOB_READ) {
+        return;
+    }
+
+    flash->wb.offset = block->offset;
+    flash->wb.size = block->size;
+    flash->wb.chunk_size = xfer->chunk_size;
+    flash->wb.pending = 1;
+
+    if (block->offset + block->size >= xfer->size) {
+        /* Last block: the transfer may be applied right after this */
+        wb_write(flash);
+        return;
+    }
+
+    /* Written once the current message has been handled and the block
+     * status sent, or at the latest when the next block starts.
+     */
+    k_work_reschedule(&flash->wb_flush, K_NO_WAIT);
+}
+#endif /* CONFIG_BT_MESH_BLOB_IO_FLASH_WRITE_BEHIND */
+
 int bt_mesh_blob_io_flash_init(struct bt_mesh_blob_io_flash *flash,
                                u8_t area_id, off_t offset)
 {
@@ -118,7 +213,13 @@ int bt_mesh_blob_io_flash_init(struct bt_mesh_blob_io_flash *flash,
     flash->io.open = io_open;
     flash->io.close = io_close;
     flash->io.block_start = block_start;
+#if (CONFIG_BT_MESH_BLOB_IO_FLASH_WRITE_BEHIND)
+    flash->io.block_end = block_end;
+    k_work_init_delayable(&flash->wb_flush, wb_flush);
+    wb_reset(flash);
+#else
     flash->io.block_end = NULL;
+#endif
     flash->io.rd = rd_chunk;
     flash->io.wr = wr_chunk;
 
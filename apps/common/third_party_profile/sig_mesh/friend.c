@@ -52,13 +52,9 @@
 #define FRIEND_POLL_IO_0()          CUR_DEBUG_IO_0(A, 0)
 #define FRIEND_POLL_IO_1()          CUR_DEBUG_IO_1(A, 0)
 
-#define FRIEND_BUF_SIZE     (BT_MESH_ADV_DATA_SIZE - BT_MESH_NET_HDR_LEN)
+#define FRIEND_PDU_NONE     0xFF
 
-/* We reserve one extra buffer for each friendship, since we need to be able
- * to resend the last sent PDU, which sits separately outside of the queue.
- */
-#define FRIEND_BUF_COUNT    ((CONFIG_BT_MESH_FRIEND_QUEUE_SIZE + 1) * \
-                 CONFIG_BT_MESH_FRIEND_LPN_COUNT)
+BUILD_ASSERT(FRIEND_QUEUE_SIZE_MAX + 1 < 32, "Friend PDU slots are tracked in a 32-bit map.");
 
 /* PDUs from Friend to the LPN should only be transmitted once with the
  * smallest possible interval (20ms).
@@ -79,42 +75,165 @@ struct friend_pdu_info {
 
 BUILD_ASSERT(CONFIG_BT_MESH_LABEL_COUNT <= 0xFFFU, "Friend doesn't support more than 4096 labels.");
 
+/* Friend Queue
+ *
+ * Every LPN owns FRIEND_PDU_COUNT fixed PDU slots. The Friend Queue and the
+ * segment reassembly contexts are rings of slot indexes, so a Friend Poll
+ * is served from the ring head and evicting the oldest PDU is O(1). Slots
+ * holding Segment Acks are tracked in seg_ack_map, so purging an outdated
+ * ack only looks at those.
+ *
+ * PDUs relayed on behalf of other nodes are network encrypted when they
+ * are queued, leaving only PDUs originated by this node (which need a fresh
+ * SEQ, and an updated MD for Friend Update) to be encrypted on poll.
+ */
 
-#if 0 //NET_BUF_USE_MALLOC for friend
-struct friend_adv {
-    u16_t app_idx;
-    struct {
-        /* CONFIG_BT_MESH_LABEL_COUNT max value is 4096. */
-        u16_t uuidx: 15,
-              seg: 1;
-    };
-};
-static struct friend_adv *adv_pool;
-#else
-struct friend_adv {
-    u16_t app_idx;
-    struct {
-        /* CONFIG_BT_MESH_LABEL_COUNT max value is 4096. */
-        u16_t uuidx: 15,
-              seg: 1;
-    };
+static void ring_init(struct bt_mesh_friend_ring *ring)
+{
+    ring->head = 0U;
+    ring->count = 0U;
+}
 
-};
+static u8_t ring_at(const struct bt_mesh_friend_ring *ring, u8_t pos)
+{
+    return ring->idx[(ring->head + pos) % CONFIG_BT_MESH_FRIEND_QUEUE_SIZE];
+}
 
-// NET_BUF_POOL_FIXED_DEFINE(friend_buf_pool, FRIEND_BUF_COUNT, BT_MESH_ADV_DATA_SIZE,
-// 			  sizeof(struct friend_adv), NULL);
+static bool ring_put(struct bt_mesh_friend_ring *ring, u8_t id)
+{
+    if (ring->count >= CONFIG_BT_MESH_FRIEND_QUEUE_SIZE) {
+        return false;
+    }
 
-static struct friend_adv adv_pool[5];//FRIEND_BUF_COUNT
+    ring->idx[(ring->head + ring->count) % CONFIG_BT_MESH_FRIEND_QUEUE_SIZE] = id;
+    ring->count++;
 
-#endif /* NET_BUF_USE_MALLOC */
+    return true;
+}
+
+static u8_t ring_get(struct bt_mesh_friend_ring *ring)
+{
+    u8_t id;
+
+    if (!ring->count) {
+        return FRIEND_PDU_NONE;
+    }
+
+    id = ring->idx[ring->head];
+    ring->head = (ring->head + 1) % CONFIG_BT_MESH_FRIEND_QUEUE_SIZE;
+    ring->count--;
+
+    return id;
+}
+
+static void ring_remove(struct bt_mesh_friend_ring *ring, u8_t pos)
+{
+    for (; (pos + 1) < ring->count; pos++) {
+        ring->idx[(ring->head + pos) % CONFIG_BT_MESH_FRIEND_QUEUE_SIZE] =
+            ring->idx[(ring->head + pos + 1) % CONFIG_BT_MESH_FRIEND_QUEUE_SIZE];
+    }
+
+    ring->count--;
+}
+
+static void pdu_buf(struct bt_mesh_friend_pdu *pdu, struct net_buf_simple *buf)
+{
+    buf->__buf = pdu->data;
+    buf->data = pdu->data;
+    buf->len = pdu->len;
+    buf->size = sizeof(pdu->data);
+}
+
+static void pdu_free(struct bt_mesh_friend *frnd, u8_t id)
+{
+    if (id == FRIEND_PDU_NONE) {
+        return;
+    }
+
+    frnd->pdu_free |= BIT(id);
+    frnd->seg_ack_map &= ~BIT(id);
+}
+
+static u8_t pdu_alloc(struct bt_mesh_friend *frnd)
+{
+    u8_t id;
+
+    if (!frnd->pdu_free) {
+        /* The remaining slots are held by pending segments, reuse the
+         * oldest queued PDU like a full Friend Queue would.
+         */
+        id = ring_get(&frnd->queue);
+        if (id == FRIEND_PDU_NONE) {
+            return FRIEND_PDU_NONE;
+        }
+
+        frnd->seg_ack_map &= ~BIT(id);
+        frnd->stat.dropped++;
+
+        return id;
+    }
+
+    id = find_lsb_set(frnd->pdu_free) - 1;
+    frnd->pdu_free &= ~BIT(id);
 
-#define FRIEND_ADV(buf) (*(struct friend_adv **)net_buf_user_data(buf))
+    return id;
+}
+
+static void purge_pdus(struct bt_mesh_friend *frnd, struct bt_mesh_friend_ring *ring)
+{
+    u8_t id;
+
+    while ((id = ring_get(ring)) != FRIEND_PDU_NONE) {
+        pdu_free(frnd, id);
+    }
+}
+
+static bool ring_remove_id(struct bt_mesh_friend_ring *ring, u8_t id)
+{
+    u8_t pos;
+
+    for (pos = 0; pos < ring->count; pos++) {
+        if (ring_at(ring, pos) == id) {
+            ring_remove(ring, pos);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/* Take a queued PDU out of whichever ring holds it and free its slot */
+static void pdu_drop(struct bt_mesh_friend *frnd, u8_t id)
+{
+    int i;
+
+    if (!ring_remove_id(&frnd->queue, id)) {
+        for (i = 0; i < ARRAY_SIZE(frnd->seg); i++) {
+            if (ring_remove_id(&frnd->seg[i].queue, id)) {
+                break;
+            }
+        }
+    }
+
+    pdu_free(frnd, id);
+    frnd->stat.dropped++;
+}
 
-static struct friend_adv *adv_alloc(int id)
+static void friend_queue_reset(struct bt_mesh_friend *frnd)
 {
-    adv_pool[id].app_idx = BT_MESH_KEY_UNUSED;
-    adv_pool[id].seg = false;
-    return &adv_pool[id];
+    int i;
+
+    frnd->pdu_free = BIT_MASK(FRIEND_PDU_COUNT);
+    frnd->seg_ack_map = 0U;
+    frnd->last = FRIEND_PDU_NONE;
+    frnd->stat.poll_time = 0U;
+
+    ring_init(&frnd->queue);
+
+    for (i = 0; i < ARRAY_SIZE(frnd->seg); i++) {
+        ring_init(&frnd->seg[i].queue);
+        frnd->seg[i].seg_count = 0U;
+    }
 }
 
 static bool friend_is_allocated(const struct bt_mesh_friend *frnd)
@@ -170,15 +289,6 @@ static int friend_cred_create(struct bt_mesh_friend *frnd, u8_t idx)
                                       &frnd->subnet->keys[idx].net);
 }
 
-static void purge_buffers(sys_slist_t *list)
-{
-    struct net_buf *buf;
-
-    while ((buf = (void *)net_buf_slist_get(list))) {
-        net_buf_unref(buf);
-    }
-}
-
 /* Intentionally start a little bit late into the ReceiveWindow when
  * it's large enough. This may improve reliability with some platforms,
  * like the PTS, where the receiver might not have sufficiently compensated
@@ -209,19 +319,7 @@ static void friend_clear(struct bt_mesh_friend *frnd)
     }
     memset(frnd->cred, 0, sizeof(frnd->cred));
 
-    if (frnd->last) {
-        net_buf_unref(frnd->last);
-        frnd->last = NULL;
-    }
-
-    purge_buffers(&frnd->queue);
-
-    for (i = 0; i < ARRAY_SIZE(frnd->seg); i++) {
-        struct bt_mesh_friend_seg *seg = &frnd->seg[i];
-
-        purge_buffers(&seg->queue);
-        seg->seg_count = 0U;
-    }
+    friend_queue_reset(frnd);
 
     // STRUCT_SECTION_FOREACH(bt_mesh_friend_cb, cb) {	//for compiler, not used now.
     // 	if (frnd->established && cb->terminated) {
@@ -234,7 +332,6 @@ static void friend_clear(struct bt_mesh_friend *frnd)
     frnd->established = 0U;
     frnd->pending_buf = 0U;
     frnd->fsn = 0U;
-    frnd->queue_size = 0U;
     frnd->pending_req = 0U;
     (void)memset(frnd->sub_list, 0, sizeof(frnd->sub_list));
 }
@@ -366,36 +463,67 @@ static void friend_sub_rem(struct bt_mesh_friend *frnd, u16_t addr)
     }
 }
 
-static struct net_buf *create_friend_pdu(struct bt_mesh_friend *frnd,
-        struct friend_pdu_info *info,
-        struct net_buf_simple *sdu)
+static u8_t create_friend_pdu(struct bt_mesh_friend *frnd,
+                              struct friend_pdu_info *info,
+                              struct net_buf_simple *sdu)
 {
-    struct net_buf *buf;
+    struct bt_mesh_friend_pdu *pdu;
+    struct net_buf_simple buf;
+    u8_t mic_len = info->ctl ? 8 : 4;
+    u8_t id;
 
+    if (BT_MESH_NET_HDR_LEN + sdu->len + mic_len > BT_MESH_NET_MAX_PDU_LEN) {
+        LOG_ERR("Too big Friend PDU (%u bytes)", sdu->len);
+        return FRIEND_PDU_NONE;
+    }
 
-    // buf = net_buf_alloc(&friend_buf_pool, K_NO_WAIT);	//for compiler, not used now.
-    if (!buf) {
-        return NULL;
+    id = pdu_alloc(frnd);
+    if (id == FRIEND_PDU_NONE) {
+        return FRIEND_PDU_NONE;
     }
 
-    FRIEND_ADV(buf) = adv_alloc(net_buf_id(buf));
+    pdu = &frnd->pdu[id];
+    pdu->encrypted = 0U;
+    pdu->cred_idx = 0U;
+    pdu->seg = 0U;
+    pdu->app_idx = BT_MESH_KEY_UNUSED;
+    pdu->uuidx = 0U;
 
-    net_buf_add_u8(buf, (info->iv_index & 1) << 7); /* Will be reset in encryption */
+    pdu->len = 0U;
+    pdu_buf(pdu, &buf);
+
+    net_buf_simple_add_u8(&buf, (info->iv_index & 1) << 7); /* Will be reset in encryption */
 
     if (info->ctl) {
-        net_buf_add_u8(buf, info->ttl | 0x80);
+        net_buf_simple_add_u8(&buf, info->ttl | 0x80);
     } else {
-        net_buf_add_u8(buf, info->ttl);
+        net_buf_simple_add_u8(&buf, info->ttl);
     }
 
-    net_buf_add_mem(buf, info->seq, sizeof(info->seq));
+    net_buf_simple_add_mem(&buf, info->seq, sizeof(info->seq));
+
+    net_buf_simple_add_be16(&buf, info->src);
+    net_buf_simple_add_be16(&buf, info->dst);
+
+    net_buf_simple_add_mem(&buf, sdu->data, sdu->len);
 
-    net_buf_add_be16(buf, info->src);
-    net_buf_add_be16(buf, info->dst);
+    pdu->len = buf.len;
 
-    net_buf_add_mem(buf, sdu->data, sdu->len);
+    /* Cache the header fields the queue is searched by, the PDU itself
+     * may be encrypted long before it leaves the queue.
+     */
+    pdu->src = info->src;
+    pdu->seq = sys_get_be24(info->seq);
+    pdu->seq_zero = 0U;
+    pdu->seg_ack = 0U;
+
+    if (pdu->len >= BT_MESH_NET_HDR_LEN + 3) {
+        pdu->seq_zero = ((sys_get_be16(&pdu->data[10]) >> 2) & TRANS_SEQ_ZERO_MASK);
+        pdu->seg_ack = (info->ctl && (pdu->len == 16) &&
+                        (TRANS_CTL_OP(&pdu->data[9]) == TRANS_CTL_OP_ACK));
+    }
 
-    return buf;
+    return id;
 }
 
 struct unseg_app_sdu_meta {
@@ -406,11 +534,10 @@ struct unseg_app_sdu_meta {
 };
 
 static int unseg_app_sdu_unpack(struct bt_mesh_friend *frnd,
-                                struct net_buf *buf,
+                                struct net_buf_simple *buf,
+                                u16_t app_idx, u16_t uuidx,
                                 struct unseg_app_sdu_meta *meta)
 {
-    u16_t app_idx = FRIEND_ADV(buf)->app_idx;
-    u16_t uuidx = FRIEND_ADV(buf)->uuidx;
     struct bt_mesh_net_rx net = {
         .ctx = {
             .app_idx = app_idx,
@@ -420,7 +547,7 @@ static int unseg_app_sdu_unpack(struct bt_mesh_friend *frnd,
     int err;
 
     meta->subnet = frnd->subnet;
-    bt_mesh_net_header_parse(&buf->b, &net);
+    bt_mesh_net_header_parse(buf, &net);
     err = bt_mesh_keys_resolve(&net.ctx, &net.sub, &meta->key, &meta->aid);
     if (err) {
         return err;
@@ -443,7 +570,7 @@ static int unseg_app_sdu_unpack(struct bt_mesh_friend *frnd,
 }
 
 static int unseg_app_sdu_decrypt(struct bt_mesh_friend *frnd,
-                                 struct net_buf *buf,
+                                 struct net_buf_simple *buf,
                                  const struct unseg_app_sdu_meta *meta)
 {
     struct net_buf_simple in;
@@ -452,7 +579,7 @@ static int unseg_app_sdu_decrypt(struct bt_mesh_friend *frnd,
     /* Direct the input buffer at the Upper Transport Access PDU, accounting for
      * the network header and the 1 byte lower transport header
      */
-    net_buf_simple_clone(&buf->b, &in);
+    net_buf_simple_clone(buf, &in);
     net_buf_simple_pull(&in, BT_MESH_NET_HDR_LEN);
     net_buf_simple_pull(&in, 1);
     in.len -= BT_MESH_MIC_SHORT;
@@ -465,12 +592,12 @@ static int unseg_app_sdu_decrypt(struct bt_mesh_friend *frnd,
 }
 
 static int unseg_app_sdu_encrypt(struct bt_mesh_friend *frnd,
-                                 struct net_buf *buf,
+                                 struct net_buf_simple *buf,
                                  const struct unseg_app_sdu_meta *meta)
 {
     struct net_buf_simple sdu;
 
-    net_buf_simple_clone(&buf->b, &sdu);
+    net_buf_simple_clone(buf, &sdu);
     net_buf_simple_pull(&sdu, BT_MESH_NET_HDR_LEN);
     net_buf_simple_pull(&sdu, 1);
     sdu.len -= BT_MESH_MIC_SHORT;
@@ -479,16 +606,17 @@ static int unseg_app_sdu_encrypt(struct bt_mesh_friend *frnd,
 }
 
 static int unseg_app_sdu_prepare(struct bt_mesh_friend *frnd,
-                                 struct net_buf *buf)
+                                 struct bt_mesh_friend_pdu *pdu,
+                                 struct net_buf_simple *buf)
 {
     struct unseg_app_sdu_meta meta;
     int err;
 
-    if (FRIEND_ADV(buf)->app_idx == BT_MESH_KEY_UNUSED) {
+    if (pdu->app_idx == BT_MESH_KEY_UNUSED) {
         return 0;
     }
 
-    err = unseg_app_sdu_unpack(frnd, buf, &meta);
+    err = unseg_app_sdu_unpack(frnd, buf, pdu->app_idx, pdu->uuidx, &meta);
     if (err) {
         return err;
     }
@@ -518,59 +646,114 @@ static int unseg_app_sdu_prepare(struct bt_mesh_friend *frnd,
     return err;
 }
 
-static int encrypt_friend_pdu(struct bt_mesh_friend *frnd, struct net_buf *buf,
+static int encrypt_friend_pdu(struct bt_mesh_friend *frnd,
+                              struct bt_mesh_friend_pdu *pdu,
                               bool flooding_cred)
 {
     const struct bt_mesh_net_cred *cred;
+    struct net_buf_simple buf;
+    u8_t tx_idx = SUBNET_KEY_TX_IDX(frnd->subnet);
     u32_t iv_index;
     u16_t src;
     int err;
 
+    if (pdu->encrypted) {
+        return 0;
+    }
+
     if (flooding_cred) {
-        cred = &frnd->subnet->keys[SUBNET_KEY_TX_IDX(frnd->subnet)]
-               .msg;
+        cred = &frnd->subnet->keys[tx_idx].msg;
     } else {
-        cred = &frnd->cred[SUBNET_KEY_TX_IDX(frnd->subnet)];
+        cred = &frnd->cred[tx_idx];
     }
 
-    src = sys_get_be16(&buf->data[5]);
+    pdu_buf(pdu, &buf);
+
+    src = sys_get_be16(&buf.data[5]);
 
     if (bt_mesh_has_addr(src)) {
         u32_t seq;
 
-        if (FRIEND_ADV(buf)->app_idx != BT_MESH_KEY_UNUSED) {
-            err = unseg_app_sdu_prepare(frnd, buf);
+        if (pdu->app_idx != BT_MESH_KEY_UNUSED) {
+            err = unseg_app_sdu_prepare(frnd, pdu, &buf);
             if (err) {
                 return err;
             }
         }
 
         seq = bt_mesh_next_seq();
-        sys_put_be24(seq, &buf->data[2]);
+        sys_put_be24(seq, &buf.data[2]);
 
         iv_index = BT_MESH_NET_IVI_TX;
-        FRIEND_ADV(buf)->app_idx = BT_MESH_KEY_UNUSED;
+        pdu->app_idx = BT_MESH_KEY_UNUSED;
     } else {
-        u8_t ivi = (buf->data[0] >> 7);
+        u8_t ivi = (buf.data[0] >> 7);
         iv_index = (bt_mesh.iv_index - ((bt_mesh.iv_index & 1) != ivi));
     }
 
-    buf->data[0] = (cred->nid | (iv_index & 1) << 7);
+    buf.data[0] = (cred->nid | (iv_index & 1) << 7);
 
-    if (bt_mesh_net_encrypt(&cred->enc, &buf->b, iv_index, BT_MESH_NONCE_NETWORK)) {
+    if (bt_mesh_net_encrypt(&cred->enc, &buf, iv_index, BT_MESH_NONCE_NETWORK)) {
         LOG_ERR("Encrypting failed");
         return -EINVAL;
     }
 
-    if (bt_mesh_net_obfuscate(buf->data, iv_index, &cred->privacy)) {
+    if (bt_mesh_net_obfuscate(buf.data, iv_index, &cred->privacy)) {
         LOG_ERR("Obfuscating failed");
         return -EINVAL;
     }
 
+    pdu->len = buf.len;
+    pdu->encrypted = 1U;
+    pdu->cred_idx = tx_idx;
+
     return 0;
 }
 
-static struct net_buf *encode_friend_ctl(struct bt_mesh_friend *frnd,
+/* The old friend credentials are about to be revoked: bring PDUs queued
+ * under them back to plaintext, they get encrypted again with the new
+ * credentials when polled.
+ */
+static void friend_queue_key_revoke(struct bt_mesh_friend *frnd)
+{
+    const struct bt_mesh_net_cred *cred = &frnd->cred[0];
+    struct bt_mesh_friend_pdu *pdu;
+    struct net_buf_simple buf;
+    u32_t iv_index;
+    u8_t id;
+
+    for (id = 0; id < FRIEND_PDU_COUNT; id++) {
+        pdu = &frnd->pdu[id];
+
+        if ((frnd->pdu_free & BIT(id)) || (id == frnd->last) || !pdu->encrypted) {
+            continue;
+        }
+
+        if (pdu->cred_idx) {
+            /* cred[1] becomes cred[0] */
+            pdu->cred_idx = 0U;
+            continue;
+        }
+
+        pdu_buf(pdu, &buf);
+        iv_index = (bt_mesh.iv_index - ((bt_mesh.iv_index & 1) != (buf.data[0] >> 7)));
+
+        if (bt_mesh_net_obfuscate(buf.data, iv_index, &cred->privacy) ||
+            bt_mesh_net_decrypt(&cred->enc, &buf, iv_index, BT_MESH_NONCE_NETWORK)) {
+            /* The slot is already de-obfuscated and possibly partially
+             * decrypted in place, it can't be sent or re-encrypted.
+             */
+            LOG_WRN("Unable to decrypt queued PDU for 0x%04x", frnd->lpn);
+            pdu_drop(frnd, id);
+            continue;
+        }
+
+        pdu->len = buf.len;
+        pdu->encrypted = 0U;
+    }
+}
+
+static u8_t encode_friend_ctl(struct bt_mesh_friend *frnd,
         u8_t ctl_op,
         struct net_buf_simple *sdu)
 {
@@ -593,7 +776,7 @@ static struct net_buf *encode_friend_ctl(struct bt_mesh_friend *frnd,
     return create_friend_pdu(frnd, &info, sdu);
 }
 
-static struct net_buf *encode_update(struct bt_mesh_friend *frnd, u8_t md)
+static u8_t encode_update(struct bt_mesh_friend *frnd, u8_t md)
 {
     struct bt_mesh_ctl_friend_update *upd;
     NET_BUF_SIMPLE_DEFINE(sdu, 1 + sizeof(*upd));
@@ -616,7 +799,7 @@ static void enqueue_sub_cfm(struct bt_mesh_friend *frnd, u8_t xact)
 {
     struct bt_mesh_ctl_friend_sub_confirm *cfm;
     NET_BUF_SIMPLE_DEFINE(sdu, 1 + sizeof(*cfm));
-    struct net_buf *buf;
+    u8_t id;
 
     LOG_DBG("lpn 0x%04x xact 0x%02x", frnd->lpn, xact);
 
@@ -625,22 +808,23 @@ static void enqueue_sub_cfm(struct bt_mesh_friend *frnd, u8_t xact)
     cfm = net_buf_simple_add(&sdu, sizeof(*cfm));
     cfm->xact = xact;
 
-    buf = encode_friend_ctl(frnd, TRANS_CTL_OP_FRIEND_SUB_CFM, &sdu);
-    if (!buf) {
+    id = encode_friend_ctl(frnd, TRANS_CTL_OP_FRIEND_SUB_CFM, &sdu);
+    if (id == FRIEND_PDU_NONE) {
         LOG_ERR("Unable to encode Subscription List Confirmation");
         return;
     }
 
-    if (encrypt_friend_pdu(frnd, buf, false)) {
+    if (encrypt_friend_pdu(frnd, &frnd->pdu[id], false)) {
+        pdu_free(frnd, id);
         return;
     }
 
-    if (frnd->last) {
+    if (frnd->last != FRIEND_PDU_NONE) {
         LOG_DBG("Discarding last PDU");
-        net_buf_unref(frnd->last);
+        pdu_free(frnd, frnd->last);
     }
 
-    frnd->last = buf;
+    frnd->last = id;
     frnd->send_last = 1U;
 }
 
@@ -723,23 +907,35 @@ int bt_mesh_friend_sub_rem(struct bt_mesh_net_rx *rx,
     return 0;
 }
 
-static void enqueue_buf(struct bt_mesh_friend *frnd, struct net_buf *buf)
+static void enqueue_buf(struct bt_mesh_friend *frnd, u8_t id)
 {
-    net_buf_slist_put(&frnd->queue, buf);
-    frnd->queue_size++;
+    if (frnd->queue.count >= CONFIG_BT_MESH_FRIEND_QUEUE_SIZE) {
+        pdu_free(frnd, ring_get(&frnd->queue));
+        frnd->stat.dropped++;
+    }
+
+    ring_put(&frnd->queue, id);
+
+    if (frnd->pdu[id].seg_ack) {
+        frnd->seg_ack_map |= BIT(id);
+    }
+
+    if (frnd->queue.count > frnd->stat.queue_max) {
+        frnd->stat.queue_max = frnd->queue.count;
+    }
 }
 
 static void enqueue_update(struct bt_mesh_friend *frnd, u8_t md)
 {
-    struct net_buf *buf;
+    u8_t id;
 
-    buf = encode_update(frnd, md);
-    if (!buf) {
+    id = encode_update(frnd, md);
+    if (id == FRIEND_PDU_NONE) {
         LOG_ERR("Unable to encode Friend Update");
         return;
     }
 
-    enqueue_buf(frnd, buf);
+    enqueue_buf(frnd, id);
 }
 
 int bt_mesh_friend_poll(struct bt_mesh_net_rx *rx, struct net_buf_simple *buf)
@@ -770,20 +966,21 @@ int bt_mesh_friend_poll(struct bt_mesh_net_rx *rx, struct net_buf_simple *buf)
 
     LOG_DBG("msg->fsn %u frnd->fsn %u", (msg->fsn & 1), frnd->fsn);
 
+    frnd->stat.poll_time = k_uptime_get_32();
+    frnd->stat.polls++;
+
     friend_recv_delay(frnd);
 
-    if (msg->fsn == frnd->fsn && frnd->last) {
+    if (msg->fsn == frnd->fsn && frnd->last != FRIEND_PDU_NONE) {
         LOG_DBG("Re-sending last PDU");
         frnd->send_last = 1U;
     } else {
-        if (frnd->last) {
-            net_buf_unref(frnd->last);
-            frnd->last = NULL;
-        }
+        pdu_free(frnd, frnd->last);
+        frnd->last = FRIEND_PDU_NONE;
 
         frnd->fsn = msg->fsn;
 
-        if (sys_slist_is_empty(&frnd->queue)) {
+        if (!frnd->queue.count) {
             enqueue_update(frnd, 0);
             LOG_DBG("Enqueued Friend Update to empty queue");
         }
@@ -940,7 +1137,7 @@ static void enqueue_offer(struct bt_mesh_friend *frnd, s8_t rssi)
 {
     struct bt_mesh_ctl_friend_offer *off;
     NET_BUF_SIMPLE_DEFINE(sdu, 1 + sizeof(*off));
-    struct net_buf *buf;
+    u8_t id;
 
     LOG_DBG("");
 
@@ -958,21 +1155,20 @@ static void enqueue_offer(struct bt_mesh_friend *frnd, s8_t rssi)
                          */
                         off->frnd_counter = sys_cpu_to_be16(frnd->counter);
 
-    buf = encode_friend_ctl(frnd, TRANS_CTL_OP_FRIEND_OFFER, &sdu);
-    if (!buf) {
+    id = encode_friend_ctl(frnd, TRANS_CTL_OP_FRIEND_OFFER, &sdu);
+    if (id == FRIEND_PDU_NONE) {
         LOG_ERR("Unable to encode Friend Offer");
         return;
     }
 
-    if (encrypt_friend_pdu(frnd, buf, true)) {
+    if (encrypt_friend_pdu(frnd, &frnd->pdu[id], true)) {
+        pdu_free(frnd, id);
         return;
     }
 
-    if (frnd->last) {
-        net_buf_unref(frnd->last);
-    }
+    pdu_free(frnd, frnd->last);
 
-    frnd->last = buf;
+    frnd->last = id;
     frnd->send_last = 1U;
 }
 
@@ -1105,25 +1301,18 @@ init_friend:
     return 0;
 }
 
-static bool is_seg(struct bt_mesh_friend_seg *seg, u16_t src, u16_t seq_zero)
+static bool is_seg(struct bt_mesh_friend *frnd, struct bt_mesh_friend_seg *seg,
+                   u16_t src, u16_t seq_zero)
 {
-    struct net_buf *buf = (void *)sys_slist_peek_head(&seg->queue);
-    struct net_buf_simple_state state;
-    u16_t buf_seq_zero;
-    u16_t buf_src;
+    struct bt_mesh_friend_pdu *pdu;
 
-    if (!buf) {
+    if (!seg->queue.count) {
         return false;
     }
 
-    net_buf_simple_save(&buf->b, &state);
-    net_buf_skip(buf, 5);   /* skip IVI, NID, CTL, TTL, SEQ */
-    buf_src = net_buf_pull_be16(buf);
-    net_buf_skip(buf, 3);   /* skip DST, OP/AID */
-    buf_seq_zero = ((net_buf_pull_be16(buf) >> 2) & TRANS_SEQ_ZERO_MASK);
-    net_buf_simple_restore(&buf->b, &state);
+    pdu = &frnd->pdu[ring_at(&seg->queue, 0)];
 
-    return ((src == buf_src) && (seq_zero == buf_seq_zero));
+    return ((src == pdu->src) && (seq_zero == pdu->seq_zero));
 }
 
 static struct bt_mesh_friend_seg *get_seg(struct bt_mesh_friend *frnd,
@@ -1136,11 +1325,11 @@ static struct bt_mesh_friend_seg *get_seg(struct bt_mesh_friend *frnd,
     for (i = 0; i < ARRAY_SIZE(frnd->seg); i++) {
         struct bt_mesh_friend_seg *seg = &frnd->seg[i];
 
-        if (is_seg(seg, src, seq_zero)) {
+        if (is_seg(frnd, seg, src, seq_zero)) {
             return seg;
         }
 
-        if (!unassigned && !sys_slist_peek_head(&seg->queue)) {
+        if (!unassigned && !seg->queue.count) {
             unassigned = seg;
         }
     }
@@ -1155,35 +1344,42 @@ static struct bt_mesh_friend_seg *get_seg(struct bt_mesh_friend *frnd,
 static void enqueue_friend_pdu(struct bt_mesh_friend *frnd,
                                enum bt_mesh_friend_pdu_type type,
                                u16_t src, u8_t seg_count,
-                               struct net_buf *buf)
+                               u8_t id)
 {
     struct bt_mesh_friend_seg *seg;
+    u8_t seg_id;
 
     LOG_DBG("type %u", type);
 
-    if (type == BT_MESH_FRIEND_PDU_SINGLE) {
-        enqueue_buf(frnd, buf);
+    /* Relayed PDUs don't depend on our SEQ, get them ready to send now
+     * rather than in the LPN's ReceiveWindow.
+     */
+    if (!bt_mesh_has_addr(src) &&
+        encrypt_friend_pdu(frnd, &frnd->pdu[id], false)) {
+        pdu_free(frnd, id);
         return;
     }
 
-    u16_t seq_zero = (((buf->data[10] << 8 | buf->data[11]) >> 2) & TRANS_SEQ_ZERO_MASK);
+    if (type == BT_MESH_FRIEND_PDU_SINGLE) {
+        enqueue_buf(frnd, id);
+        return;
+    }
 
-    seg = get_seg(frnd, src, seq_zero, seg_count);
-    if (!seg) {
+    seg = get_seg(frnd, src, frnd->pdu[id].seq_zero, seg_count);
+    if (!seg || !ring_put(&seg->queue, id)) {
         LOG_ERR("No free friend segment RX contexts for 0x%04x", src);
-        net_buf_unref(buf);
+        pdu_free(frnd, id);
         return;
     }
 
-    net_buf_slist_put(&seg->queue, buf);
-
     if (type == BT_MESH_FRIEND_PDU_COMPLETE) {
-        sys_slist_merge_slist(&frnd->queue, &seg->queue);
+        while ((seg_id = ring_get(&seg->queue)) != FRIEND_PDU_NONE) {
+            enqueue_buf(frnd, seg_id);
+        }
 
-        frnd->queue_size += seg->seg_count;
         seg->seg_count = 0U;
     } else {
-        FRIEND_ADV(buf)->seg = true;
+        frnd->pdu[id].seg = 1U;
     }
 }
 
@@ -1200,10 +1396,20 @@ static void buf_send_start(u16_t duration, int err, void *user_data)
 
     frnd->pending_buf = 0U;
 
+    if (frnd->stat.poll_time) {
+        u32_t latency = k_uptime_get_32() - frnd->stat.poll_time;
+
+        frnd->stat.poll_time = 0U;
+        frnd->stat.latency_sum += latency;
+        if (latency > frnd->stat.latency_max) {
+            frnd->stat.latency_max = MIN(latency, UINT16_MAX);
+        }
+    }
+
     /* Friend Offer doesn't follow the re-sending semantics */
-    if (!frnd->established && frnd->last) {
-        net_buf_unref(frnd->last);
-        frnd->last = NULL;
+    if (!frnd->established && frnd->last != FRIEND_PDU_NONE) {
+        pdu_free(frnd, frnd->last);
+        frnd->last = FRIEND_PDU_NONE;
     }
 }
 
@@ -1229,36 +1435,34 @@ static void buf_send_end(int err, void *user_data)
     }
 }
 
-static void update_overwrite(struct net_buf *buf, u8_t md)
+static void update_overwrite(struct bt_mesh_friend_pdu *pdu, u8_t md)
 {
-    struct net_buf_simple_state state;
+    struct net_buf_simple buf;
     struct bt_mesh_ctl_friend_update *upd;
 
-    if (buf->len != 16) {
+    /* Friend Updates are ours, so they are still plaintext here */
+    if (pdu->len != 16 || pdu->encrypted) {
         return;
     }
 
-    net_buf_simple_save(&buf->b, &state);
+    pdu_buf(pdu, &buf);
 
-    net_buf_skip(buf, 1); /* skip IVI, NID */
+    net_buf_simple_pull(&buf, 1); /* skip IVI, NID */
 
-    if (!(net_buf_pull_u8(buf) >> 7)) {
-        goto end;
+    if (!(net_buf_simple_pull_u8(&buf) >> 7)) {
+        return;
     }
 
-    net_buf_skip(buf, 7); /* skip seqnum src dec*/
+    net_buf_simple_pull(&buf, 7); /* skip seqnum src dec*/
 
-    if (TRANS_CTL_OP((u8_t *) net_buf_pull_mem(buf, 1))
+    if (TRANS_CTL_OP((u8_t *) net_buf_simple_pull_mem(&buf, 1))
         != TRANS_CTL_OP_FRIEND_UPDATE) {
-        goto end;
+        return;
     }
 
-    upd = net_buf_pull_mem(buf, sizeof(*upd));
+    upd = net_buf_simple_pull_mem(&buf, sizeof(*upd));
     LOG_DBG("Update Previous Friend Update MD 0x%02x -> 0x%02x", upd->md, md);
     upd->md = md;
-
-end:
-    net_buf_simple_restore(&buf->b, &state);
 }
 
 static void friend_timeout(struct k_work *work)
@@ -1270,6 +1474,7 @@ static void friend_timeout(struct k_work *work)
         .start = buf_send_start,
         .end = buf_send_end,
     };
+    struct bt_mesh_friend_pdu *pdu;
     struct bt_mesh_adv *adv;
     u8_t md;
 
@@ -1279,10 +1484,10 @@ static void friend_timeout(struct k_work *work)
 
     __ASSERT_NO_MSG(frnd->pending_buf == 0U);
 
-    LOG_DBG("lpn 0x%04x send_last %u last %p", frnd->lpn, frnd->send_last, frnd->last);
+    LOG_DBG("lpn 0x%04x send_last %u last %u", frnd->lpn, frnd->send_last, frnd->last);
 
-    if (frnd->send_last && frnd->last) {
-        LOG_DBG("Sending frnd->last %p", frnd->last);
+    if (frnd->send_last && frnd->last != FRIEND_PDU_NONE) {
+        LOG_DBG("Sending frnd->last %u", frnd->last);
         frnd->send_last = 0U;
         goto send_last;
     }
@@ -1293,23 +1498,28 @@ static void friend_timeout(struct k_work *work)
         return;
     }
 
-    frnd->last = (void *)net_buf_slist_get(&frnd->queue);
-    if (!frnd->last) {
+    pdu_free(frnd, frnd->last);
+
+    frnd->last = ring_get(&frnd->queue);
+    if (frnd->last == FRIEND_PDU_NONE) {
         LOG_WRN("Friendship not established with 0x%04x", frnd->lpn);
         friend_clear(frnd);
         return;
     }
 
-    md = (u8_t)(sys_slist_peek_head(&frnd->queue) != NULL);
+    frnd->seg_ack_map &= ~BIT(frnd->last);
 
-    update_overwrite(frnd->last, md);
+    md = (u8_t)(frnd->queue.count != 0U);
 
-    if (encrypt_friend_pdu(frnd, frnd->last, false)) {
+    update_overwrite(&frnd->pdu[frnd->last], md);
+
+    if (encrypt_friend_pdu(frnd, &frnd->pdu[frnd->last], false)) {
+        pdu_free(frnd, frnd->last);
+        frnd->last = FRIEND_PDU_NONE;
         return;
     }
 
-    LOG_DBG("Sending buf %p from Friend Queue of LPN 0x%04x", frnd->last, frnd->lpn);
-    frnd->queue_size--;
+    LOG_DBG("Sending pdu %u from Friend Queue of LPN 0x%04x", frnd->last, frnd->lpn);
 
 send_last:
     adv = bt_mesh_adv_create(BT_MESH_ADV_DATA, BT_MESH_ADV_TAG_FRIEND,
@@ -1319,7 +1529,8 @@ send_last:
         return;
     }
 
-    net_buf_simple_add_mem(&adv->b, frnd->last->data, frnd->last->len);
+    pdu = &frnd->pdu[frnd->last];
+    net_buf_simple_add_mem(&adv->b, pdu->data, pdu->len);
 
     frnd->pending_req = 0U;
     frnd->pending_buf = 1U;
@@ -1361,6 +1572,7 @@ static void subnet_evt(struct bt_mesh_subnet *sub, enum bt_mesh_key_evt evt)
             break;
         case BT_MESH_KEY_REVOKED:
             LOG_DBG("Revoking old keys for 0x%04x", frnd->lpn);
+            friend_queue_key_revoke(frnd);
             bt_mesh_friend_cred_destroy(&frnd->cred[0]);
             memcpy(&frnd->cred[0], &frnd->cred[1],
                    sizeof(frnd->cred[0]));
@@ -1381,79 +1593,52 @@ int bt_mesh_friend_init(void)
 {
     int i;
 
+    if (CONFIG_BT_MESH_FRIEND_QUEUE_SIZE > FRIEND_QUEUE_SIZE_MAX) {
+        LOG_ERR("Friend Queue size %u above %u", CONFIG_BT_MESH_FRIEND_QUEUE_SIZE,
+                FRIEND_QUEUE_SIZE_MAX);
+        return -EINVAL;
+    }
+
     for (i = 0; i < ARRAY_SIZE(bt_mesh.frnd); i++) {
         struct bt_mesh_friend *frnd = &bt_mesh.frnd[i];
-        int j;
 
-        sys_slist_init(&frnd->queue);
+        friend_queue_reset(frnd);
 
         k_work_init_delayable(&frnd->timer, friend_timeout);
         k_work_init_delayable(&frnd->clear.timer, clear_timeout);
-
-        for (j = 0; j < ARRAY_SIZE(frnd->seg); j++) {
-            sys_slist_init(&frnd->seg[j].queue);
-        }
     }
 
     return 0;
 }
 
-static bool is_segack(struct net_buf *buf, const u64_t *seqauth, u16_t src)
-{
-    struct net_buf_simple_state state;
-    bool found = false;
-
-    if (buf->len != 16) {
-        return false;
-    }
-
-    net_buf_simple_save(&buf->b, &state);
-
-    net_buf_skip(buf, 1); /* skip IVI, NID */
-
-    if (!(net_buf_pull_u8(buf) >> 7)) {
-        goto end;
-    }
-
-    net_buf_pull(buf, 3); /* skip SEQNUM */
-
-    if (src != net_buf_pull_be16(buf)) {
-        goto end;
-    }
-
-    net_buf_skip(buf, 2); /* skip dst */
-
-    if (TRANS_CTL_OP((u8_t *) net_buf_pull_mem(buf, 1)) != TRANS_CTL_OP_ACK) {
-        goto end;
-    }
-
-    found = ((net_buf_pull_be16(buf) >> 2) & TRANS_SEQ_ZERO_MASK) ==
-            (*seqauth & TRANS_SEQ_ZERO_MASK);
-end:
-    net_buf_simple_restore(&buf->b, &state);
-    return found;
-}
-
 static void friend_purge_old_ack(struct bt_mesh_friend *frnd,
                                  const u64_t *seq_auth, u16_t src)
 {
-    sys_snode_t *cur, *prev = NULL;
+    u16_t seq_zero = (*seq_auth & TRANS_SEQ_ZERO_MASK);
+    u32_t map = frnd->seg_ack_map;
+    unsigned int bit;
+    u8_t id, pos;
 
     LOG_DBG("SeqAuth %llx src 0x%04x", *seq_auth, src);
 
-    for (cur = sys_slist_peek_head(&frnd->queue);
-         cur != NULL; prev = cur, cur = sys_slist_peek_next(cur)) {
-        struct net_buf *buf = (void *)cur;
-
-        if (is_segack(buf, seq_auth, src)) {
-            LOG_DBG("Removing old ack from Friend Queue");
+    while ((bit = find_lsb_set(map))) {
+        id = bit - 1;
+        map &= ~BIT(id);
 
-            sys_slist_remove(&frnd->queue, prev, cur);
-            frnd->queue_size--;
+        if ((frnd->pdu[id].src != src) || (frnd->pdu[id].seq_zero != seq_zero)) {
+            continue;
+        }
 
-            net_buf_unref(buf);
-            break;
+        for (pos = 0; pos < frnd->queue.count; pos++) {
+            if (ring_at(&frnd->queue, pos) == id) {
+                LOG_DBG("Removing old ack from Friend Queue");
+                ring_remove(&frnd->queue, pos);
+                pdu_free(frnd, id);
+                break;
+            }
         }
+
+        break;
     }
 }
 
@@ -1464,7 +1649,7 @@ static void friend_lpn_enqueue_rx(struct bt_mesh_friend *frnd,
                                   struct net_buf_simple *sbuf)
 {
     struct friend_pdu_info info;
-    struct net_buf *buf;
+    u8_t id;
 
     /* Because of network loopback, tx packets will also be passed into
      * this rx function. These packets have already been added to the
@@ -1474,7 +1659,7 @@ static void friend_lpn_enqueue_rx(struct bt_mesh_friend *frnd,
         return;
     }
 
-    LOG_DBG("LPN 0x%04x queue_size %u", frnd->lpn, frnd->queue_size);
+    LOG_DBG("LPN 0x%04x queue_size %u", frnd->lpn, frnd->queue.count);
 
     if (type == BT_MESH_FRIEND_PDU_SINGLE && seq_auth) {
         friend_purge_old_ack(frnd, seq_auth, rx->ctx.addr);
@@ -1495,15 +1680,15 @@ static void friend_lpn_enqueue_rx(struct bt_mesh_friend *frnd,
 
     info.iv_index = BT_MESH_NET_IVI_RX(rx);
 
-    buf = create_friend_pdu(frnd, &info, sbuf);
-    if (!buf) {
+    id = create_friend_pdu(frnd, &info, sbuf);
+    if (id == FRIEND_PDU_NONE) {
         LOG_ERR("Failed to encode Friend buffer");
         return;
     }
 
-    enqueue_friend_pdu(frnd, type, info.src, seg_count, buf);
+    enqueue_friend_pdu(frnd, type, info.src, seg_count, id);
 
-    LOG_DBG("Queued message for LPN 0x%04x, queue_size %u", frnd->lpn, frnd->queue_size);
+    LOG_DBG("Queued message for LPN 0x%04x, queue_size %u", frnd->lpn, frnd->queue.count);
 }
 
 static void friend_lpn_enqueue_tx(struct bt_mesh_friend *frnd,
@@ -1513,7 +1698,7 @@ static void friend_lpn_enqueue_tx(struct bt_mesh_friend *frnd,
                                   struct net_buf_simple *sbuf)
 {
     struct friend_pdu_info info;
-    struct net_buf *buf;
+    u8_t id;
 
     LOG_DBG("LPN 0x%04x", frnd->lpn);
 
@@ -1531,8 +1716,8 @@ static void friend_lpn_enqueue_tx(struct bt_mesh_friend *frnd,
 
     info.iv_index = BT_MESH_NET_IVI_TX;
 
-    buf = create_friend_pdu(frnd, &info, sbuf);
-    if (!buf) {
+    id = create_friend_pdu(frnd, &info, sbuf);
+    if (id == FRIEND_PDU_NONE) {
         LOG_ERR("Failed to encode Friend buffer");
         return;
     }
@@ -1542,7 +1727,7 @@ static void friend_lpn_enqueue_tx(struct bt_mesh_friend *frnd,
          * as they depend on the the sequence number being the same
          * when encrypting in transport and network.
          */
-        FRIEND_ADV(buf)->app_idx = tx->ctx->app_idx;
+        frnd->pdu[id].app_idx = tx->ctx->app_idx;
 
         /* When reencrypting a virtual address message, we need to know uuid as well. */
         if (BT_MESH_ADDR_IS_VIRTUAL(tx->ctx->addr)) {
@@ -1551,15 +1736,15 @@ static void friend_lpn_enqueue_tx(struct bt_mesh_friend *frnd,
 
             err = bt_mesh_va_get_idx_by_uuid(tx->ctx->uuid, &uuidx);
             if (err) {
-                net_buf_unref(buf);
+                pdu_free(frnd, id);
                 return;
             }
 
-            FRIEND_ADV(buf)->uuidx = uuidx;
+            frnd->pdu[id].uuidx = uuidx;
         }
     }
 
-    enqueue_friend_pdu(frnd, type, info.src, seg_count, buf);
+    enqueue_friend_pdu(frnd, type, info.src, seg_count, id);
 
     LOG_DBG("Queued message for LPN 0x%04x, dst: %04x, uuid: %p", frnd->lpn, tx->ctx->addr,
             tx->ctx->uuid);
@@ -1622,7 +1807,7 @@ static bool friend_queue_has_space(struct bt_mesh_friend *frnd, u16_t addr,
     for (i = 0; i < ARRAY_SIZE(frnd->seg); i++) {
         struct bt_mesh_friend_seg *seg = &frnd->seg[i];
 
-        if (seq_auth && is_seg(seg, addr, *seq_auth & TRANS_SEQ_ZERO_MASK)) {
+        if (seq_auth && is_seg(frnd, seg, addr, *seq_auth & TRANS_SEQ_ZERO_MASK)) {
             /* If there's a segment queue for this message then the
              * space verification has already happened.
              */
@@ -1678,16 +1863,13 @@ bool bt_mesh_friend_queue_has_space(u16_t net_idx, u16_t src, u16_t dst,
 static bool friend_queue_check_dup(struct bt_mesh_friend *frnd, u32_t seq,
                                    u16_t src)
 {
-    struct bt_mesh_net_rx rx;
-    sys_snode_t *cur;
-
-    for (cur = sys_slist_peek_head(&frnd->queue); cur != NULL;
-         cur = sys_slist_peek_next(cur)) {
-        struct net_buf *buf = (void *)cur;
+    struct bt_mesh_friend_pdu *pdu;
+    u8_t pos;
 
-        bt_mesh_net_header_parse(&buf->b, &rx);
+    for (pos = 0; pos < frnd->queue.count; pos++) {
+        pdu = &frnd->pdu[ring_at(&frnd->queue, pos)];
 
-        if ((src == rx.ctx.addr) && (seq == rx.seq)) {
+        if ((src == pdu->src) && (seq == pdu->seq)) {
             return true;
         }
     }
@@ -1705,23 +1887,23 @@ static bool friend_queue_prepare_space(struct bt_mesh_friend *frnd, u16_t addr,
         return false;
     }
 
-    avail_space = CONFIG_BT_MESH_FRIEND_QUEUE_SIZE - frnd->queue_size;
+    avail_space = CONFIG_BT_MESH_FRIEND_QUEUE_SIZE - frnd->queue.count;
     pending_segments = false;
 
     while (pending_segments || avail_space < seg_count) {
-        struct net_buf *buf = (void *)net_buf_slist_get(&frnd->queue);
+        u8_t id = ring_get(&frnd->queue);
 
-        if (!buf) {
+        if (id == FRIEND_PDU_NONE) {
             LOG_ERR("Unable to free up enough buffers");
             return false;
         }
 
-        frnd->queue_size--;
         avail_space++;
 
-        pending_segments = FRIEND_ADV(buf)->seg;
+        pending_segments = frnd->pdu[id].seg;
 
-        net_buf_unref(buf);
+        pdu_free(frnd, id);
+        frnd->stat.dropped++;
     }
 
     return true;
@@ -1806,6 +1988,25 @@ bool bt_mesh_friend_enqueue_tx(struct bt_mesh_net_tx *tx,
     return matched;
 }
 
+void bt_mesh_friend_stat_dump(void)
+{
+    int i;
+
+    for (i = 0; i < ARRAY_SIZE(bt_mesh.frnd); i++) {
+        struct bt_mesh_friend *frnd = &bt_mesh.frnd[i];
+
+        if (!friend_is_allocated(frnd)) {
+            continue;
+        }
+
+        printf("friend lpn 0x%04x queue %u/%u max %u drop %u poll %u latency avg %ums max %ums\n",
+               frnd->lpn, frnd->queue.count, CONFIG_BT_MESH_FRIEND_QUEUE_SIZE,
+               frnd->stat.queue_max, frnd->stat.dropped, frnd->stat.polls,
+               frnd->stat.polls ? (frnd->stat.latency_sum / frnd->stat.polls) : 0,
+               frnd->stat.latency_max);
+    }
+}
+
 int bt_mesh_friend_terminate(u16_t lpn_addr)
 {
     struct bt_mesh_friend *frnd;
@@ -1838,13 +2039,13 @@ void bt_mesh_friend_clear_incomplete(struct bt_mesh_subnet *sub, u16_t src,
         for (j = 0; j < ARRAY_SIZE(frnd->seg); j++) {
             struct bt_mesh_friend_seg *seg = &frnd->seg[j];
 
-            if (!is_seg(seg, src, *seq_auth & TRANS_SEQ_ZERO_MASK)) {
+            if (!is_seg(frnd, seg, src, *seq_auth & TRANS_SEQ_ZERO_MASK)) {
                 continue;
             }
 
             LOG_WRN("Clearing incomplete segments for 0x%04x", src);
 
-            purge_buffers(&seg->queue);
+            purge_pdus(frnd, &seg->queue);
             seg->seg_count = 0U;
             break;
         }
@@ -1864,7 +2065,7 @@ void bt_mesh_friend_buf_alloc(void)
 
     u32 buf_size;
     u32 net_buf_p, net_buf_data_p, adv_pool_p;
-    u32 frnd_p, sub_list_p, seg_p, frnd_cred_p;
+    u32 frnd_p, sub_list_p, seg_p, pdu_p, frnd_cred_p;
 
     buf_size = sizeof(struct net_buf) * FRIEND_BUF_COUNT;
     LOG_DBG("net_buf size=0x%x", buf_size);
@@ -1883,6 +2084,9 @@ void bt_mesh_friend_buf_alloc(void)
     seg_p = buf_size;
     buf_size += (sizeof(struct bt_mesh_friend_seg) * FRIEND_SEG_RX);
     LOG_DBG("seg size=0x%x", sizeof(struct bt_mesh_friend_seg) * FRIEND_SEG_RX);
+    pdu_p = buf_size;
+    buf_size += (sizeof(struct bt_mesh_friend_pdu) * FRIEND_PDU_COUNT * CONFIG_BT_MESH_FRIEND_LPN_COUNT);
+    LOG_DBG("pdu size=0x%x", sizeof(struct bt_mesh_friend_pdu) * FRIEND_PDU_COUNT * CONFIG_BT_MESH_FRIEND_LPN_COUNT);
     frnd_cred_p = buf_size;
     buf_size += bt_mesh_friend_cred_size_need();
     LOG_DBG("frnd_cred size=0x%x", bt_mesh_friend_cred_size_need());
@@ -1896,6 +2100,7 @@ void bt_mesh_friend_buf_alloc(void)
     frnd_p += net_buf_p;
     sub_list_p += net_buf_p;
     seg_p += net_buf_p;
+    pdu_p += net_buf_p;
     frnd_cred_p += net_buf_p;
 
     NET_BUF_MALLOC(friend_buf_pool,
@@ -1906,6 +2111,7 @@ void bt_mesh_friend_buf_alloc(void)
     for (int i = 0; i < CONFIG_BT_MESH_FRIEND_LPN_COUNT; i++) {
         bt_mesh.frnd[i].sub_list = (u16_t *)sub_list_p;
         bt_mesh.frnd[i].seg = (struct bt_mesh_friend_seg *)seg_p;
+        bt_mesh.frnd[i].pdu = (struct bt_mesh_friend_pdu *)pdu_p + i * FRIEND_PDU_COUNT;
     }
 
     bt_mesh_friend_cred_malloc((void *)frnd_cred_p);
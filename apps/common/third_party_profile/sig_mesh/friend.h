@@ -47,3 +47,6 @@ int bt_mesh_friend_sub_rem(struct bt_mesh_net_rx *rx,
                            struct net_buf_simple *buf);
 
 int bt_mesh_friend_init(void);
+
+/* Print Friend Queue occupancy and poll-to-response latency per LPN. */
+void bt_mesh_friend_stat_dump(void);
@@ -88,6 +88,9 @@
 #define POLL_TIMEOUT_MAX(lpn)     (POLL_TIMEOUT - \
 			  (REQ_ATTEMPTS(lpn) * REQ_RETRY_DURATION(lpn)))
 
+#define POLL_BURST_TIMEOUT        CONFIG_BT_MESH_LPN_POLL_BURST_TIMEOUT
+#define POLL_BURST_COUNT          CONFIG_BT_MESH_LPN_POLL_BURST_COUNT
+
 #define CLEAR_ATTEMPTS            3
 
 #define LPN_CRITERIA ((CONFIG_BT_MESH_LPN_MIN_QUEUE_SIZE) | \
@@ -130,18 +133,38 @@ static const char *state2str(int state)
 
 static s32_t poll_timeout(struct bt_mesh_lpn *lpn)
 {
+    s32_t timeout_max = POLL_TIMEOUT_MAX(lpn);
+
+    if (lpn->poll_latency) {
+        timeout_max = MIN(timeout_max, lpn->poll_latency);
+    }
+
     /* If we're waiting for segment acks keep polling at high freq */
     if (bt_mesh_tx_in_progress()) {
         LOG_DBG("Tx is in progress. Keep polling");
-        return MIN(POLL_TIMEOUT_MAX(lpn), 1 * MSEC_PER_SEC);
+        return MIN(timeout_max, 1 * MSEC_PER_SEC);
     }
 
-    if (lpn->poll_timeout < POLL_TIMEOUT_MAX(lpn)) {
+#if (CONFIG_BT_MESH_LPN_POLL_ADAPTIVE)
+    /* Traffic was seen recently, more is likely to follow: keep the poll
+     * interval short, then back off from there once the burst is over.
+     */
+    if (lpn->poll_burst) {
+        lpn->poll_burst--;
+        lpn->poll_timeout = MIN(timeout_max, POLL_BURST_TIMEOUT);
+
+        LOG_DBG("Burst Poll Timeout is %ums", lpn->poll_timeout);
+
+        return lpn->poll_timeout;
+    }
+#endif /* CONFIG_BT_MESH_LPN_POLL_ADAPTIVE */
+
+    if (lpn->poll_timeout < timeout_max) {
         lpn->poll_timeout *= 2;
-        lpn->poll_timeout =
-            MIN(lpn->poll_timeout, POLL_TIMEOUT_MAX(lpn));
     }
 
+    lpn->poll_timeout = MIN(lpn->poll_timeout, timeout_max);
+
     LOG_DBG("Poll Timeout is %ums", lpn->poll_timeout);
 
     return lpn->poll_timeout;
@@ -204,6 +227,16 @@ static void lpn_mesh_scan_enable(bool enable)
         return;
     }
 
+    struct bt_mesh_lpn *lpn = &bt_mesh.lpn;
+
+    if (enable && !lpn->scanning) {
+        lpn->scan_start_time = k_uptime_get_32();
+    } else if (!enable && lpn->scanning) {
+        lpn->stat_scan += k_uptime_get_32() - lpn->scan_start_time;
+    }
+
+    lpn->scanning = enable;
+
     if (enable) {
         bt_mesh_scan_enable();
     } else {
@@ -356,6 +389,7 @@ static void friend_req_send_end(int err, void *user_data)
     }
 
     lpn->adv_duration = k_uptime_get_32() - lpn->adv_start_time;
+    lpn->stat_tx += lpn->adv_duration;
 
     if (IS_ENABLED(CONFIG_BT_MESH_LPN_ESTABLISHMENT)) {
         k_work_reschedule(&lpn->timer,
@@ -433,6 +467,7 @@ static void req_send_end(int err, void *user_data)
     }
 
     lpn->adv_duration = k_uptime_get_32() - lpn->adv_start_time;
+    lpn->stat_tx += lpn->adv_duration;
 
 #if defined(CONFIG_BT_MESH_LOW_POWER_LOG_LEVEL_DBG)
     LOG_DBG("req 0x%02x duration %u err %d state %s", lpn->sent_req, lpn->adv_duration, err,
@@ -519,6 +554,7 @@ static int send_friend_poll(void)
     if (err == 0) {
         lpn->pending_poll = 0U;
         lpn->sent_req = TRANS_CTL_OP_FRIEND_POLL;
+        lpn->stat_polls++;
     }
 
     return err;
@@ -636,6 +672,12 @@ void bt_mesh_lpn_msg_received(struct bt_mesh_net_rx *rx)
         return;
     }
 
+    lpn->stat_data++;
+
+#if (CONFIG_BT_MESH_LPN_POLL_ADAPTIVE)
+    lpn->poll_burst = POLL_BURST_COUNT;
+#endif /* CONFIG_BT_MESH_LPN_POLL_ADAPTIVE */
+
     friend_response_received(lpn);
 
     LOG_DBG("Requesting more messages from Friend");
@@ -1123,6 +1165,7 @@ int bt_mesh_lpn_friend_update(struct bt_mesh_net_rx *rx,
         /* Set initial poll timeout */
         lpn->poll_timeout = MIN(POLL_TIMEOUT_MAX(lpn),
                                 POLL_TIMEOUT_INIT);
+        lpn->poll_burst = 0U;
 
         established = true;
     }
@@ -1173,6 +1216,61 @@ int bt_mesh_lpn_poll(void)
     return send_friend_poll();
 }
 
+int bt_mesh_lpn_poll_latency_set(u32_t latency_ms)
+{
+    struct bt_mesh_lpn *lpn = &bt_mesh.lpn;
+
+    /* Anything above the PollTimeout has no effect, and clamping keeps
+     * large values from wrapping negative in the s32_t field.
+     */
+    lpn->poll_latency = MIN(latency_ms, (u32_t)POLL_TIMEOUT);
+
+    if (!latency_ms || !lpn->established) {
+        return 0;
+    }
+
+    /* Pull the pending poll in if it is further away than allowed */
+    if ((lpn->state == BT_MESH_LPN_ESTABLISHED) &&
+        (lpn->poll_timeout > lpn->poll_latency)) {
+        lpn->poll_timeout = lpn->poll_latency;
+        k_work_reschedule(&lpn->timer, K_MSEC(lpn->poll_timeout));
+    }
+
+    return 0;
+}
+
+void bt_mesh_lpn_radio_stat_get(struct bt_mesh_lpn_radio_stat *stat, bool reset)
+{
+    struct bt_mesh_lpn *lpn = &bt_mesh.lpn;
+    u32_t now = k_uptime_get_32();
+    u32_t scan = lpn->stat_scan;
+
+    if (lpn->scanning) {
+        scan += now - lpn->scan_start_time;
+    }
+
+    stat->window = now - lpn->stat_start_time;
+    stat->scan = scan;
+    stat->tx = lpn->stat_tx;
+    stat->polls = lpn->stat_polls;
+    stat->data = lpn->stat_data;
+    stat->on_per_hour = stat->window ?
+                        (u32_t)((u64_t)(scan + lpn->stat_tx) * 3600000 / stat->window) : 0;
+
+    LOG_INF("radio on %ums/h (scan %u tx %u in %ums) polls %u data %u",
+            stat->on_per_hour, stat->scan, stat->tx, stat->window,
+            stat->polls, stat->data);
+
+    if (reset) {
+        lpn->stat_start_time = now;
+        lpn->scan_start_time = now;
+        lpn->stat_scan = 0;
+        lpn->stat_tx = 0;
+        lpn->stat_polls = 0;
+        lpn->stat_data = 0;
+    }
+}
+
 static void subnet_evt(struct bt_mesh_subnet *sub, enum bt_mesh_key_evt evt)
 {
     switch (evt) {
@@ -1203,6 +1301,8 @@ int bt_mesh_lpn_init(void)
 
     k_work_init_delayable(&lpn->timer, lpn_timeout);
 
+    lpn->stat_start_time = k_uptime_get_32();
+
     if (lpn->state == BT_MESH_LPN_ENABLED) {
         if (IS_ENABLED(CONFIG_BT_MESH_LPN_ESTABLISHMENT)) {
             lpn_mesh_scan_enable(false);
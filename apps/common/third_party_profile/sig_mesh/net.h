@@ -51,6 +51,42 @@ struct bt_mesh_node {
 #endif
 
 #if CONFIG_BT_MESH_FRIEND
+/* Each LPN owns one PDU slot per Friend Queue entry plus one for the last
+ * sent PDU, which sits outside of the queue for re-sending.
+ */
+#define FRIEND_PDU_COUNT        (CONFIG_BT_MESH_FRIEND_QUEUE_SIZE + 1)
+
+#if NET_BUF_USE_MALLOC
+/* The queue size is a runtime constant here: the ring is sized for the
+ * largest queue the 32-bit pdu slot map can track, and pdu[] is allocated
+ * together with the Friend structures.
+ */
+#define FRIEND_QUEUE_SIZE_MAX   30
+#else
+#define FRIEND_QUEUE_SIZE_MAX   CONFIG_BT_MESH_FRIEND_QUEUE_SIZE
+#endif /* NET_BUF_USE_MALLOC */
+
+struct bt_mesh_friend_pdu {
+    u8_t  data[BT_MESH_NET_MAX_PDU_LEN];
+    u8_t  len;
+    u8_t  encrypted: 1,
+          cred_idx: 1,
+          seg: 1,
+          seg_ack: 1;
+    u16_t app_idx;
+    u16_t uuidx;
+    u16_t src;
+    u16_t seq_zero;
+    u32_t seq;
+};
+
+/* Ring of bt_mesh_friend::pdu slot indexes */
+struct bt_mesh_friend_ring {
+    u8_t head;
+    u8_t count;
+    u8_t idx[FRIEND_QUEUE_SIZE_MAX];
+};
+
 struct bt_mesh_friend {
     u16_t lpn;
     u8_t  recv_delay;
@@ -78,7 +114,7 @@ struct bt_mesh_friend {
 
 #if NET_BUF_USE_MALLOC
     struct bt_mesh_friend_seg {
-        sys_slist_t queue;
+        struct bt_mesh_friend_ring queue;
 
         /* The target number of segments, i.e. not necessarily
          * the current number of segments, in the queue. This is
@@ -88,7 +124,7 @@ struct bt_mesh_friend {
     } *seg;
 #else
     struct bt_mesh_friend_seg {
-        sys_slist_t queue;
+        struct bt_mesh_friend_ring queue;
 
         /* The target number of segments, i.e. not necessarily
          * the current number of segments, in the queue. This is
@@ -98,10 +134,25 @@ struct bt_mesh_friend {
     } seg[FRIEND_SEG_RX];
 #endif /* NET_BUF_USE_MALLOC */
 
-    struct net_buf *last;
+#if NET_BUF_USE_MALLOC
+    struct bt_mesh_friend_pdu *pdu;
+#else
+    struct bt_mesh_friend_pdu pdu[FRIEND_PDU_COUNT];
+#endif /* NET_BUF_USE_MALLOC */
+    u32_t pdu_free;                   /* Bitmap of unused pdu[] slots */
+    u32_t seg_ack_map;                /* pdu[] slots queued with a Segment Ack */
+    u8_t  last;                       /* pdu[] slot of the last sent PDU */
+
+    struct bt_mesh_friend_ring queue;
 
-    sys_slist_t queue;
-    u32_t queue_size;
+    struct {
+        u32_t poll_time;              /* Uptime of the pending Friend Poll */
+        u32_t polls;
+        u32_t latency_sum;            /* Poll to response, in ms */
+        u16_t latency_max;
+        u16_t dropped;                /* PDUs evicted to make room */
+        u8_t  queue_max;
+    } stat;
 
     /* Friend Clear Procedure */
     struct {
@@ -155,7 +206,8 @@ struct bt_mesh_lpn {
           disable: 1,       /* Disable LPN after clearing */
           fsn: 1,           /* Friend Sequence Number */
           established: 1,   /* Friendship established */
-          clear_success: 1; /* Friend Clear Confirm received */
+          clear_success: 1, /* Friend Clear Confirm received */
+          scanning: 1;      /* Scanner enabled by the LPN */
 
     /* Friend Queue Size */
     u8_t  queue_size;
@@ -175,6 +227,20 @@ struct bt_mesh_lpn {
     /* Advertising start time. */
     u32_t adv_start_time;
 
+    /* Short polls left before backing off again */
+    u8_t  poll_burst;
+
+    /* Application latency hint, upper bound of the poll interval */
+    s32_t poll_latency;
+
+    /* Radio-on accounting, see bt_mesh_lpn_radio_stat_get() */
+    u32_t scan_start_time;
+    u32_t stat_start_time;
+    u32_t stat_scan;
+    u32_t stat_tx;
+    u32_t stat_polls;
+    u32_t stat_data;
+
     /* Next LPN related action timer */
     struct k_work_delayable timer;
 
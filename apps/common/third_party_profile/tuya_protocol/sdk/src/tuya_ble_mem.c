@@ -27,6 +27,7 @@
 #include "tuya_ble_heap.h"
 #include "tuya_ble_mem.h"
 #include "tuya_ble_internal_config.h"
+#include "system/malloc.h"
 
 
 #if (TUYA_BLE_USE_PLATFORM_MEMORY_HEAP==0)
@@ -40,7 +41,11 @@
  * */
 void *tuya_ble_malloc(uint16_t size)
 {
-    uint8_t *ptr = pvTuyaPortMalloc(size);
+    //收发包的小块内存优先用slab, 避免打碎堆
+    uint8_t *ptr = slab_try_alloc(size);
+    if (!ptr) {
+        ptr = pvTuyaPortMalloc(size);
+    }
     if (ptr) {
         memset(ptr, 0x0, size); //allocate buffer need init
     }
@@ -61,7 +66,9 @@ tuya_ble_status_t tuya_ble_free(uint8_t *ptr)
         return TUYA_BLE_SUCCESS;
     }
 
-    vTuyaPortFree(ptr);
+    if (!slab_try_free(ptr)) {
+        vTuyaPortFree(ptr);
+    }
     return TUYA_BLE_SUCCESS;
 }
 
@@ -108,7 +115,11 @@ void tuya_ble_free_n(void *ptr)
  * */
 void *tuya_ble_malloc(uint16_t size)
 {
-    uint8_t *ptr = tuya_ble_port_malloc(size);
+    //收发包的小块内存优先用slab, 避免打碎堆
+    uint8_t *ptr = slab_try_alloc(size);
+    if (!ptr) {
+        ptr = tuya_ble_port_malloc(size);
+    }
     if (ptr) {
         memset(ptr, 0x0, size); //allocate buffer need init
     }
@@ -129,7 +140,9 @@ tuya_ble_status_t tuya_ble_free(uint8_t *ptr)
         return TUYA_BLE_SUCCESS;
     }
 
-    tuya_ble_port_free(ptr);
+    if (!slab_try_free(ptr)) {
+        tuya_ble_port_free(ptr);
+    }
     return TUYA_BLE_SUCCESS;
 }
 
@@ -66,6 +66,12 @@ const struct task_info task_info_table[] = {
 #endif
 #if (CONFIG_APP_HILINK)
     {"hilink_task",         2,     0,   1024,   0},//定义线程 hilink任务调度
+#endif
+#if CONFIG_DLOG_ENABLE
+    {"dlog",                1,     0,   256,   0    },
+#endif
+#if CONFIG_IIC_QUEUE_ENABLE
+    {"iic_queue",           2,     0,   256,   0    },
 #endif
     {"user_init",           3,     0,   512,    512},
     {0, 0},
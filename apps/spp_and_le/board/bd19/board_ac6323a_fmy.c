@@ -25,6 +25,9 @@
 #include "debug.h"
 
 #define AT_UART_PORT_ID        3  // wakeup_param 里面的port id
+#define GSENSOR_INT_PORT_ID    4  // wakeup_param 里面的port id
+
+#define GSENSOR_INT_WAKEUP_EN  (TCFG_GSENSOR_ENABLE && (TCFG_GSENSOR_INT_PORT != NO_CONFIG_PORT))
 
 void board_power_init(void);
 
@@ -514,6 +517,9 @@ static void close_gpio(u8 is_softoff)
 #endif
 #ifdef GSENSOR_POWER_IO
         port_protect(port_group, GSENSOR_POWER_IO);
+#endif
+#if GSENSOR_INT_WAKEUP_EN
+        port_protect(port_group, TCFG_GSENSOR_INT_PORT);
 #endif
     }
 
@@ -642,6 +648,16 @@ struct port_wakeup at_uart_port = {
     .filter             = PORT_FLT_256us,
 };
 
+#if GSENSOR_INT_WAKEUP_EN
+struct port_wakeup gsensor_int_port = {
+	.pullup_down_enable = DISABLE,                           //配置I/O 内部上下拉是否使能
+	.edge               = RISING_EDGE,                       //FIFO到达水位INT输出高电平
+    .both_edge          = 0,
+	.iomap              = TCFG_GSENSOR_INT_PORT,             //唤醒口选择
+    .filter             = PORT_FLT_256us,
+};
+#endif
+
 
 const struct wakeup_param wk_param = {
 
@@ -664,6 +680,10 @@ const struct wakeup_param wk_param = {
     .port[AT_UART_PORT_ID] = &at_uart_port,
 #endif
 
+#if GSENSOR_INT_WAKEUP_EN
+    .port[GSENSOR_INT_PORT_ID] = &gsensor_int_port,
+#endif
+
 #if TCFG_CHARGE_ENABLE
     .aport[0] = &charge_port,
     .aport[1] = &vbat_port,
@@ -690,6 +710,10 @@ void board_set_soft_poweroff(void)
 	power_wakeup_index_enable(AT_UART_PORT_ID);
 #endif
 
+#if GSENSOR_INT_WAKEUP_EN
+	power_wakeup_index_disable(GSENSOR_INT_PORT_ID);
+#endif
+
 	close_gpio(1);
 }
 
@@ -770,6 +794,12 @@ static void port_wakeup_callback(u8 index, u8 gpio)
                 sys_timeout_add(0,board_time_to_idle,10000);//delay 给uart 指令退出低功耗
             }
             break;
+#endif
+#if GSENSOR_INT_WAKEUP_EN
+        case GSENSOR_INT_PORT_ID:
+            extern void gsensor_int_isr(void);
+            gsensor_int_isr();
+            break;
 #endif
         default:
             break;
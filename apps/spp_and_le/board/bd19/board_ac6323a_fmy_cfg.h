@@ -355,6 +355,9 @@
 
 #define TCFG_GSENOR_USER_IIC_TYPE                 0     //0:软件IIC  1:硬件IIC 目前只适配软件IIC
 
+#define TCFG_GSENSOR_INT_PORT                     NO_CONFIG_PORT // gsensor INT1脚, 配置后使用FIFO水位中断唤醒读取数据, 不配置则由上层定时读取
+#define TCFG_GSENSOR_FIFO_WTM                     25    // FIFO水位(组), sc7a20(25Hz)约1s唤醒一次, msa310(125Hz)约200ms唤醒一次
+
 //*********************************************************************************//
 //                                  系统配置                                         //
 //*********************************************************************************//
@@ -12,6 +12,9 @@
 #include "user_cfg.h"
 #include "usb/otg.h"
 #include "norflash.h"
+#if TCFG_OMSENSOR_ENABLE
+#include "OMSensor_manage.h"
+#endif
 
 #define LOG_TAG_CONST       BOARD
 #define LOG_TAG             "[BOARD]"
@@ -247,6 +250,19 @@ NORFLASH_DEV_PLATFORM_DATA_BEGIN(norflash_fat_dev_data)
 NORFLASH_DEV_PLATFORM_DATA_END()
 
 
+/************************** optical mouse sensor ****************************/
+#if TCFG_OMSENSOR_ENABLE
+OMSENSOR_PLATFORM_DATA_BEGIN(omsensor_data)
+#if TCFG_HAL3205_EN
+    .OMSensor_id = "hal3205",
+#elif TCFG_HAL3212_EN
+    .OMSensor_id = "hal3212",
+#endif
+    .OMSensor_sclk_io = TCFG_OMSENSOR_SCLK_PORT,
+    .OMSensor_data_io = TCFG_OMSENSOR_DATA_PORT,
+    .OMSensor_int_io = TCFG_OMSENSOR_INT_PORT,
+OMSENSOR_PLATFORM_DATA_END()
+#endif
 
 /************************** otg data****************************/
 #if TCFG_OTG_MODE
@@ -328,6 +344,10 @@ static void board_devices_init(void)
     alarm_init(&rtc_data);
 #endif
 
+#if TCFG_OMSENSOR_ENABLE
+    optical_mouse_sensor_init(&omsensor_data);
+#endif
+
 }
 
 //maskrom 使用到的io
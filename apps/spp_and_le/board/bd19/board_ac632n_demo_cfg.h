@@ -338,6 +338,16 @@
 #define TCFG_STK8321_EN                           0
 #define TCFG_GSENOR_USER_IIC_TYPE                 0     //0:软件IIC  1:硬件IIC
 
+//*********************************************************************************//
+//                                 光电鼠标传感器配置                              //
+//*********************************************************************************//
+#define TCFG_OMSENSOR_ENABLE                      0     //光电鼠标传感器使能, 配合conn_24g按连接事件上报位移
+#define TCFG_HAL3205_EN                           0
+#define TCFG_HAL3212_EN                           0
+#define TCFG_OMSENSOR_SCLK_PORT                   IO_PORTA_03
+#define TCFG_OMSENSOR_DATA_PORT                   IO_PORTA_04
+#define TCFG_OMSENSOR_INT_PORT                    IO_PORTB_05
+
 //*********************************************************************************//
 //                                  系统配置                                         //
 //*********************************************************************************//
@@ -30,6 +30,7 @@
 /* #define LOG_DUMP_ENABLE */
 #define LOG_CLI_ENABLE
 #include "debug.h"
+#include "generic/dlog.h"
 
 struct at_uart {
     u32 baudrate;
@@ -100,8 +101,8 @@ void at_cmd_rx_handler(void)
         __this->data_length += __this->udev->read(&__this->pRxBuffer[__this->data_length], -1, 0);
     }
 
-    log_info("AT CMD RX");
-    log_info_hexdump(__this->pRxBuffer, __this->data_length);
+    log_info_defer("AT CMD RX");
+    log_info_hexdump_defer(__this->pRxBuffer, __this->data_length);
     if (__this->data_length > UART_RX_SIZE) {
         log_error("Wired");
     }
@@ -182,8 +183,8 @@ static void ct_uart_write(char *buf, u16 len)
 
 int ct_uart_send_packet(const u8 *packet, int size)
 {
-    log_info("ct_uart_send_packet:%d", size);
-    log_info_hexdump(packet, size);
+    log_info_defer("ct_uart_send_packet:%d", size);
+    log_info_hexdump_defer(packet, size);
 
 #if 0
     int i = 0;
@@ -31,6 +31,9 @@
 #include "btstack/btstack_event.h"
 #include "gatt_common/le_gatt_common.h"
 #include "ble_24g_profile.h"
+#if TCFG_OMSENSOR_ENABLE
+#include "optical_mouse_sensor/include/OMSensor_manage.h"
+#endif
 
 #if CONFIG_APP_CONN_24G && CONFIG_BT_GATT_SERVER_NUM
 
@@ -235,6 +238,26 @@ static void conn_24g_resume_all_ccc_enable(u16 conn_handle, u8 update_request)
     }
 }
 
+#if TCFG_OMSENSOR_ENABLE
+//每个连接事件发送一次合并后的鼠标位移, 格式: x(s16) + y(s16), 小端
+static void conn_24g_mouse_motion_send(u16 conn_handle)
+{
+    u8 report[4];
+    s16 x, y;
+
+    //发送缓存满时不取, 位移继续累加到下一个连接事件
+    if (!ble_comm_att_check_send(conn_handle, sizeof(report))) {
+        return;
+    }
+    if (!optical_mouse_sensor_motion_take(&x, &y, 0x7fff)) {
+        return;
+    }
+    little_endian_store_16(report, 0, x);
+    little_endian_store_16(report, 2, y);
+    ble_comm_att_send_data(conn_handle, ATT_CHARACTERISTIC_ae02_01_VALUE_HANDLE, report, sizeof(report), ATT_OP_AUTO_READ_CCC);
+}
+#endif
+
 //-------------------------------------------------------------------------------------
 //处理gatt_common 模块返回的事件，hci & gatt
 static int conn_24g_event_packet_handler(int event, u8 *packet, u16 size, u8 *ext_param)
@@ -254,10 +277,17 @@ static int conn_24g_event_packet_handler(int event, u8 *packet, u16 size, u8 *ex
         conn_24g_server_pair_vm_do(pair_bond_info, sizeof(pair_bond_info), 1);
         pair_bond_enalbe = 0;
         __ble_state_to_user(BLE_ST_CONNECT, conn_24g_handle);
+#if TCFG_OMSENSOR_ENABLE
+        ble_vendor_interval_event_enable(conn_24g_handle, 1);
+        optical_mouse_sensor_pipeline_enable(1);
+#endif
         break;
 
     case GATT_COMM_EVENT_DISCONNECT_COMPLETE:
         log_info("disconnect_handle:%04x,reason= %02x\n", little_endian_read_16(packet, 0), packet[2]);
+#if TCFG_OMSENSOR_ENABLE
+        optical_mouse_sensor_pipeline_enable(0);
+#endif
         if (packet[2] == 8) {
             if (pair_bond_info[0] == PAIR_BOND_TAG) {
                 direct_adv_count = DIRECT_ADV_MAX_CNT;
@@ -302,6 +332,12 @@ static int conn_24g_event_packet_handler(int event, u8 *packet, u16 size, u8 *ex
 
         break;
 
+    case GATT_COMM_EVENT_CONNECTION_INTERVAL:
+#if TCFG_OMSENSOR_ENABLE
+        conn_24g_mouse_motion_send(little_endian_read_16(packet, 0));
+#endif
+        break;
+
     case GATT_COMM_EVENT_DIRECT_ADV_TIMEOUT:
         log_info("DIRECT_ADV_TIMEOUT:%d", direct_adv_count);
 #if PEER_INFO_BOND
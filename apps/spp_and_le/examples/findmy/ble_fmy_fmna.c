@@ -920,6 +920,7 @@ static int fmy_set_user_infomation(void)
     fmna_input_cfg_t input_cfg;
 
     mem_stats();
+    mem_slab_stats();
     //设置配置区的路径,配置区在xxx_build_cfg.h定义
     //patch, product, crypto_enc_key,每次上电都要配置一下
     fmna_user_cfg_set_patch(fmy_user_config_path);
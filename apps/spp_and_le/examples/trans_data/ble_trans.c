@@ -250,6 +250,246 @@ static void trans_test_send_audio_data(int init_flag)
 
 #endif
 
+#if (TRANS_VOICE_UPLINK_EN && TCFG_AUDIO_ENABLE)
+#include "audio_encode/audio_encode.h"
+
+#define VOICE_UPLINK_HANDLE        ATT_CHARACTERISTIC_ae3c_01_VALUE_HANDLE
+#define VOICE_UPLINK_CODING        AUDIO_CODING_OPUS
+#define VOICE_UPLINK_QUEUE_SIZE    (1024) //每个连接待发送的编码帧缓存
+#define VOICE_PKT_HEAD_SIZE        (3)    //seq(2byte,小端) + 帧信息(1byte)
+//帧信息: bit7为0时是本包整帧数; bit7为1时本包是一帧的分片, bit6表示最后一片, bit0~5为分片序号
+#define VOICE_PKT_FRAG             BIT(7)
+#define VOICE_PKT_FRAG_LAST        BIT(6)
+#define VOICE_PKT_FRAG_IDX_MASK    (0x3f)
+#define VOICE_STAT_PERIOD_MS       (1000)
+
+struct voice_uplink {
+    u16 con_handle;
+    u16 mtu;
+    u16 seq;
+    u16 frame_len;
+    u16 frag_off;       //队头帧已分片发出的字节数
+    u8 frag_idx;
+    u8 start;
+    cbuffer_t queue;
+    u8 queue_buf[VOICE_UPLINK_QUEUE_SIZE];
+    u8 pkt[ATT_LOCAL_MTU_SIZE];
+    u32 frames;
+    u32 drop_frames;
+    u32 pkts;
+    u32 backlog_max;
+};
+
+static struct voice_uplink voice_uplink[SUPPORT_MAX_GATT_SERVER];
+static OS_MUTEX voice_uplink_mutex;
+static u16 voice_uplink_stat_timer;
+static u8 voice_uplink_active;
+
+//按连接查找上行通道, alloc置1时没有则分配空闲通道(连接断开时释放)
+static struct voice_uplink *trans_voice_uplink_get(u16 con_handle, u8 alloc)
+{
+    struct voice_uplink *idle = NULL;
+
+    for (int i = 0; i < SUPPORT_MAX_GATT_SERVER; i++) {
+        if (voice_uplink[i].con_handle == con_handle) {
+            return &voice_uplink[i];
+        }
+        if (!idle && !voice_uplink[i].con_handle) {
+            idle = &voice_uplink[i];
+        }
+    }
+    if (!alloc || !idle) {
+        return NULL;
+    }
+    idle->con_handle = con_handle;
+    idle->mtu = 23;
+    return idle;
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief      把队列里的整帧按MTU打包发送, 帧长超过一包时按MTU分片
+ *
+ *  \param      [in]
+ *
+ *  \return
+ *
+ *  \note      编码任务出帧和协议栈CAN_SEND_NOW都会调用, 链路空闲时立即发送, 不额外等待凑包
+ */
+/*************************************************************************************************/
+static void trans_voice_uplink_send(struct voice_uplink *vu)
+{
+    u32 data_len, payload, pkt_len;
+    u8 info;
+
+    if (!vu->start || !vu->frame_len) {
+        return;
+    }
+
+    os_mutex_pend(&voice_uplink_mutex, 0);
+    while (1) {
+        data_len = cbuf_get_data_size(&vu->queue);
+        payload = vu->mtu - 3 - VOICE_PKT_HEAD_SIZE;
+        if (vu->frag_off || vu->frame_len > payload) {
+            //MTU交换前(默认23)放不下一帧, 分片发送, 队列里总是整帧
+            if (data_len == 0) {
+                break;
+            }
+            payload = MIN(payload, vu->frame_len - vu->frag_off);
+            info = VOICE_PKT_FRAG | (vu->frag_idx & VOICE_PKT_FRAG_IDX_MASK);
+            if (vu->frag_off + payload == vu->frame_len) {
+                info |= VOICE_PKT_FRAG_LAST;
+            }
+        } else {
+            if (payload > data_len) {
+                payload = data_len;
+            }
+            payload -= payload % vu->frame_len;
+            if (payload == 0) {
+                break;
+            }
+            info = payload / vu->frame_len;
+        }
+
+        pkt_len = VOICE_PKT_HEAD_SIZE + payload;
+        if (!ble_comm_att_check_send(vu->con_handle, pkt_len)) {
+            break;
+        }
+
+        little_endian_store_16(vu->pkt, 0, vu->seq);
+        vu->pkt[2] = info;
+        cbuf_read_alloc_len(&vu->queue, vu->pkt + VOICE_PKT_HEAD_SIZE, payload);
+        if (ble_comm_att_send_data(vu->con_handle, VOICE_UPLINK_HANDLE, vu->pkt, pkt_len, ATT_OP_AUTO_READ_CCC)) {
+            break;
+        }
+        cbuf_read_alloc_len_updata(&vu->queue, payload);
+        if (info & VOICE_PKT_FRAG) {
+            vu->frag_off += payload;
+            vu->frag_idx++;
+            if (info & VOICE_PKT_FRAG_LAST) {
+                vu->frag_off = 0;
+                vu->frag_idx = 0;
+            }
+        }
+        vu->seq++;
+        vu->pkts++;
+    }
+
+    //积压 = 待打包数据 + 协议栈里还没发出的数据
+    data_len = cbuf_get_data_size(&vu->queue) + ATT_SEND_CBUF_SIZE - ble_comm_cbuffer_vaild_len(vu->con_handle);
+    if (data_len > vu->backlog_max) {
+        vu->backlog_max = data_len;
+    }
+    os_mutex_post(&voice_uplink_mutex);
+}
+
+static int trans_voice_enc_output(void *priv, void *buf, int len)
+{
+    struct voice_uplink *vu;
+
+    for (int i = 0; i < SUPPORT_MAX_GATT_SERVER; i++) {
+        vu = &voice_uplink[i];
+        if (!vu->start) {
+            continue;
+        }
+        //queue和frame_len与CAN_SEND_NOW里的打包发送共用, 写入也要持锁
+        os_mutex_pend(&voice_uplink_mutex, 0);
+        if (vu->frame_len != len) {
+            if (cbuf_get_data_size(&vu->queue)) {
+                //帧长变化时不混包, 丢弃这一帧
+                vu->drop_frames++;
+                os_mutex_post(&voice_uplink_mutex);
+                continue;
+            }
+            vu->frame_len = len;
+        }
+        vu->frames++;
+        if (cbuf_write(&vu->queue, buf, len) != len) {
+            //链路发不出去, 积压的旧帧已经没有意义, 清空队列从新帧开始
+            vu->drop_frames += cbuf_get_data_size(&vu->queue) / len + 1;
+            cbuf_clear(&vu->queue);
+            vu->frag_off = 0;
+            vu->frag_idx = 0;
+        }
+        os_mutex_post(&voice_uplink_mutex);
+        trans_voice_uplink_send(vu);
+    }
+    return len;
+}
+
+static void trans_voice_uplink_stat(void *priv)
+{
+    struct audio_demo_enc_stat enc = {0};
+    struct voice_uplink *vu;
+
+    audio_demo_enc_stat_get(&enc, 1);
+    log_info("voice enc: frames %d, lat avg %d max %d ms, pcm over %d under %d\n",
+             enc.frames, enc.frames ? enc.lat_sum_ms / enc.frames : 0, enc.lat_max_ms,
+             enc.pcm_overrun, enc.pcm_underrun);
+
+    for (int i = 0; i < SUPPORT_MAX_GATT_SERVER; i++) {
+        vu = &voice_uplink[i];
+        if (!vu->start) {
+            continue;
+        }
+        log_info("voice[%04x]: mtu %d, frames %d, drop %d, pkts %d, seq %d, backlog max %d\n",
+                 vu->con_handle, vu->mtu, vu->frames, vu->drop_frames, vu->pkts, vu->seq, vu->backlog_max);
+        vu->frames = 0;
+        vu->drop_frames = 0;
+        vu->pkts = 0;
+        vu->backlog_max = 0;
+    }
+}
+
+static void trans_voice_uplink_start(u16 con_handle)
+{
+    struct voice_uplink *vu = trans_voice_uplink_get(con_handle, 1);
+
+    if (!vu || vu->start) {
+        return;
+    }
+
+    log_info("voice uplink start:%04x\n", con_handle);
+    vu->seq = 0;
+    vu->frame_len = 0;
+    vu->frag_off = 0;
+    vu->frag_idx = 0;
+    cbuf_init(&vu->queue, vu->queue_buf, sizeof(vu->queue_buf));
+    vu->start = 1;
+
+    if (voice_uplink_active++ == 0) {
+        os_mutex_create(&voice_uplink_mutex);
+        audio_demo_enc_open(trans_voice_enc_output, VOICE_UPLINK_CODING, 0);
+        voice_uplink_stat_timer = sys_timer_add(NULL, trans_voice_uplink_stat, VOICE_STAT_PERIOD_MS);
+    }
+}
+
+static void trans_voice_uplink_stop(u16 con_handle)
+{
+    struct voice_uplink *vu = trans_voice_uplink_get(con_handle, 0);
+
+    if (!vu || !vu->start) {
+        return;
+    }
+
+    log_info("voice uplink stop:%04x\n", con_handle);
+    vu->start = 0;
+    if (--voice_uplink_active == 0) {
+        sys_timer_del(voice_uplink_stat_timer);
+        voice_uplink_stat_timer = 0;
+        audio_demo_enc_close();
+        os_mutex_del(&voice_uplink_mutex, 0);
+    }
+}
+
+static void trans_voice_uplink_can_send(void)
+{
+    for (int i = 0; i < SUPPORT_MAX_GATT_SERVER; i++) {
+        trans_voice_uplink_send(&voice_uplink[i]);
+    }
+}
+#endif
+
 /*************************************************************************************************/
 /*!
  *  \brief      串口接收转发到BLE
@@ -362,6 +602,9 @@ static int trans_event_packet_handler(int event, u8 *packet, u16 size, u8 *ext_p
     case GATT_COMM_EVENT_CAN_SEND_NOW:
 #if TEST_AUDIO_DATA_UPLOAD
         trans_test_send_audio_data(0);
+#endif
+#if (TRANS_VOICE_UPLINK_EN && TCFG_AUDIO_ENABLE)
+        trans_voice_uplink_can_send();
 #endif
         break;
 
@@ -412,6 +655,15 @@ static int trans_event_packet_handler(int event, u8 *packet, u16 size, u8 *ext_p
 #endif
             trans_con_handle = 0;
         }
+#if (TRANS_VOICE_UPLINK_EN && TCFG_AUDIO_ENABLE)
+        {
+            struct voice_uplink *vu = trans_voice_uplink_get(little_endian_read_16(packet, 0), 0);
+            if (vu) {
+                trans_voice_uplink_stop(vu->con_handle);
+                vu->con_handle = 0;
+            }
+        }
+#endif
         break;
 
     case GATT_COMM_EVENT_ENCRYPTION_CHANGE:
@@ -437,6 +689,15 @@ static int trans_event_packet_handler(int event, u8 *packet, u16 size, u8 *ext_p
 
     case GATT_COMM_EVENT_MTU_EXCHANGE_COMPLETE:
         log_info("con_handle= %02x, ATT MTU = %u\n", little_endian_read_16(packet, 0), little_endian_read_16(packet, 2));
+#if (TRANS_VOICE_UPLINK_EN && TCFG_AUDIO_ENABLE)
+        {
+            struct voice_uplink *vu = trans_voice_uplink_get(little_endian_read_16(packet, 0), 1);
+            if (vu) {
+                //按协商后的MTU打包, 不超过本地发送buffer
+                vu->mtu = MIN(little_endian_read_16(packet, 2), ATT_LOCAL_MTU_SIZE);
+            }
+        }
+#endif
         break;
 
     case GATT_COMM_EVENT_SERVER_STATE:
@@ -658,6 +919,13 @@ static int trans_att_write_callback(hci_con_handle_t connection_handle, uint16_t
         if (0 == memcmp(buffer, "start", 5)) {
             trans_test_send_audio_data(1);
         }
+#endif
+#if (TRANS_VOICE_UPLINK_EN && TCFG_AUDIO_ENABLE)
+        if (0 == memcmp(buffer, "vstart", 6)) {
+            trans_voice_uplink_start(connection_handle);
+        } else if (0 == memcmp(buffer, "vstop", 5)) {
+            trans_voice_uplink_stop(connection_handle);
+        }
 #endif
         break;
 
@@ -16,6 +16,22 @@
 
 #define CONFIG_DEBUG_ENABLE
 
+//延迟二进制日志: 热路径只把格式串ID和参数写入ring buffer, 由低优先级任务输出,
+//使能后串口上为二进制帧与普通文本混合, 需用cpu/bd19/tools/dlog_decode.py配合sdk.elf解码;
+//默认关闭, 此时log_xxx_defer直接走普通log_print输出
+#define CONFIG_DLOG_ENABLE                0
+
+//slab内存池各尺寸档的块数(0为不使用该档), 协议栈/profile按包申请的小块内存走slab_malloc,
+//用完或超过256字节时退回malloc, 用mem_slab_stats()查看各档高水位后再调整
+#define MEM_SLAB_32_NUM                   16
+#define MEM_SLAB_64_NUM                   8
+#define MEM_SLAB_128_NUM                  4
+#define MEM_SLAB_256_NUM                  2
+
+//iic传输队列: 传感器的iic读写交给iic_queue任务按设备轮流执行, 读写期间不关中断,
+//调用者可异步提交并在回调中处理结果, 用iic_queue_stat_dump()查看各设备等待/占用总线时间
+#define CONFIG_IIC_QUEUE_ENABLE           1
+
 #define TCFG_MEDIA_LIB_USE_MALLOC		    1
 //apps example 选择,只能选1个,要配置对应的board_config.h
 #define CONFIG_APP_SPP_LE                 0 //SPP + LE or LE's client
@@ -57,6 +73,7 @@
 #define DOUBLE_BT_SAME_MAC                 0 //同地址
 #define CONFIG_APP_SPP_LE_TO_IDLE          0 //SPP_AND_LE To IDLE Use
 #define CONFIG_BLE_HIGH_SPEED              0 //BLE提速模式: 使能DLE+2M, payload要匹配pdu的包长
+#define TRANS_VOICE_UPLINK_EN              0 //语音上行: mic->编码->按MTU打包->notify, 需打开TCFG_AUDIO_ENABLE
 
 //蓝牙BLE配置
 #define CONFIG_BT_GATT_COMMON_ENABLE       1 //配置使用gatt公共模块
@@ -21,6 +21,18 @@
 
 #define TONE_DEFAULT_VOL   SYS_MAX_VOL
 
+#define TONE_PCM_CACHE_EN           1           //常用提示音PCM缓存, 命中时不经过解码器直接输出
+#define TONE_PCM_CACHE_NUM          2           //可缓存的提示音个数
+#define TONE_PCM_CACHE_MAX_LEN      (4 * 1024)  //单个提示音缓存上限(字节), 16K采样率约128ms
+
+struct tone_latency_stat {
+    u32 play_cnt;       // 提示音播放次数
+    u32 cache_hit;      // 其中缓存命中次数
+    u32 total_ms;       // 启动延时累计
+    u16 last_ms;        // 最近一次启动延时
+    u16 max_ms;         // 最大启动延时
+};
+
 enum {
     IDEX_TONE_NUM_0,
     IDEX_TONE_NUM_1,
@@ -156,6 +168,9 @@ int tone_play_by_path(const char *name, u8 preemption);
 
 int tone_dec_wait_stop(u32 timeout_ms);
 
+int tone_pcm_cache_add(const char *name);
+int tone_latency_stat_get(struct tone_latency_stat *stat);
+
 // 按序列号播放提示音
 int tone_play_with_callback_by_index(u8 index, // 序列号
                                      u8 preemption, // 打断标记
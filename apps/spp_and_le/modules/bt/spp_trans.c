@@ -19,6 +19,7 @@
 /* #define LOG_DUMP_ENABLE */
 #define LOG_CLI_ENABLE
 #include "debug.h"
+#include "generic/dlog.h"
 
 #define TEST_SPP_DATA_RATE        0
 
@@ -54,7 +55,7 @@ static u16 spp_channel;
 int transport_spp_send_data(u8 *data, u16 len)
 {
     if (spp_api) {
-        log_info("spp_api_tx(%d) \n", len);
+        log_info_defer("spp_api_tx(%d)", len);
         /* log_info_hexdump(data, len); */
         /* clear_sniff_cnt(); */
         bt_comm_edr_sniff_clean();
@@ -114,8 +115,8 @@ static void transport_spp_send_wakeup(void)
 static void transport_spp_recieve_cbk(void *priv, u8 *buf, u16 len)
 {
     spp_channel = (u16)priv;
-    log_info("spp_api_rx(%d) \n", len);
-    log_info_hexdump(buf, len);
+    log_info_defer("spp_api_rx(%d)", len);
+    log_info_hexdump_defer(buf, len);
     /* clear_sniff_cnt(); */
     bt_comm_edr_sniff_clean();
 
@@ -129,7 +130,7 @@ static void transport_spp_recieve_cbk(void *priv, u8 *buf, u16 len)
 
     //loop send data for test
     if (transport_spp_send_data_check(len)) {
-        log_info("-loop send\n");
+        log_info_defer("-loop send");
         transport_spp_send_data(buf, len);
     }
 }
@@ -27,6 +27,7 @@ enum {
 #define VBAT_DETECT_CNT       (2*1) //2*N
 #define VBAT_DETECT_ADC_MS    (10)  //unint:ms
 #define VBAT_PERIOD_CHECK_S   (30)  //unint:s
+#define VBAT_PERIOD_SLACK_MS  (5000) //unint:ms, 慢速检测允许延后, 与其它定时任务合并唤醒
 
 static int vbat_slow_timer = 0;
 static int vbat_fast_timer = 0;
@@ -180,18 +181,18 @@ void vbat_check_slow(void *priv)
         vbat_fast_timer = usr_timer_add(NULL, vbat_check, VBAT_DETECT_ADC_MS, 1);
     }
     if (get_charge_online_flag()) {
-        sys_timer_modify(vbat_slow_timer, 60 * 1000);
+        sys_slack_timer_modify(vbat_slow_timer, 60 * 1000);
     } else {
-        sys_timer_modify(vbat_slow_timer, VBAT_PERIOD_CHECK_S * 1000);
+        sys_slack_timer_modify(vbat_slow_timer, VBAT_PERIOD_CHECK_S * 1000);
     }
 }
 
 void vbat_check_init(void)
 {
     if (vbat_slow_timer == 0) {
-        vbat_slow_timer = sys_timer_add(NULL, vbat_check_slow, VBAT_PERIOD_CHECK_S * 1000);
+        vbat_slow_timer = sys_slack_timer_add(NULL, vbat_check_slow, VBAT_PERIOD_CHECK_S * 1000, VBAT_PERIOD_SLACK_MS);
     } else {
-        sys_timer_modify(vbat_slow_timer, VBAT_PERIOD_CHECK_S * 1000);
+        sys_slack_timer_modify(vbat_slow_timer, VBAT_PERIOD_CHECK_S * 1000);
     }
 
     if (vbat_fast_timer == 0) {
@@ -202,7 +203,7 @@ void vbat_check_init(void)
 void vbat_timer_delete(void)
 {
     if (vbat_slow_timer) {
-        sys_timer_del(vbat_slow_timer);
+        sys_slack_timer_del(vbat_slow_timer);
         vbat_slow_timer = 0;
     }
     if (vbat_fast_timer) {
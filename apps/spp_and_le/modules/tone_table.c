@@ -181,10 +181,26 @@ int tone_play_index_with_callback(u8 index, u8 preemption, void (*user_evt_handl
 
 
 
+#if TONE_PCM_CACHE_EN
+/*
+ * 需要PCM缓存的提示音(按键音等频繁播放的短提示音), 个数不超过TONE_PCM_CACHE_NUM,
+ * 长度超过TONE_PCM_CACHE_MAX_LEN的不会被缓存; 正弦提示音(DEFAULT_SINE_TONE)不走文件解码, 不需要登记
+ */
+static const u8 tone_pcm_cache_index[] = {
+    IDEX_TONE_BT_CONN,
+    IDEX_TONE_BT_DISCONN,
+};
+#endif
+
 __BANK_INIT_ENTRY
 int tone_table_init()
 {
     tone_play_set_sine_param_handler(get_sine_param_by_index);
+#if TONE_PCM_CACHE_EN
+    for (int i = 0; i < ARRAY_SIZE(tone_pcm_cache_index); i++) {
+        tone_pcm_cache_add(tone_index[tone_pcm_cache_index[i]]);
+    }
+#endif
     return 0;
 }
 __initcall(tone_table_init);
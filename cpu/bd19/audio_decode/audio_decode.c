@@ -6,6 +6,9 @@
 #include "audio_config.h"
 #include "audio_decode.h"
 #include "app_main.h"
+#if DEMO_FRAME_PLC_EN
+#include "audio_plc.h"
+#endif
 /* #include "audio_dec.h" */
 /* #include "clock_cfg.h" */
 
@@ -19,6 +22,7 @@ struct demo_frame_decoder {
     struct audio_mixer_ch mix_ch;	// 叠加句柄
     struct audio_stream *stream;	// 音频流
     struct audio_fmt *fmt;        //解码参数配置
+    u8 repair;          // 当前帧为丢包补帧
 #ifndef CONFIG_MEDIA_DEVELOP_ENABLE
     u8 remain;
     struct audio_src_handle *src_sync;
@@ -42,12 +46,44 @@ int demo_frame_dec_close(void);
 
 struct demo_frame_media_rx_bulk {
     struct list_head entry;
+    u16 seq;            // 帧序号
     int data_len;
     u8 data[0];
 };
+
+/*
+ * 抖动缓冲
+ * 入队时按序号插入链表(乱序到达的帧在这里排好), 迟到/重复帧直接丢弃;
+ * 出队时缓冲深度达到target才开始出数, 链表头序号不连续时用上一个好帧
+ * 重复解码并标记repair, 由输出端做PLC.
+ * target在迟到/缓冲空时加大, 一个统计窗口内都平稳则减小, 多余的延时丢帧收回.
+ */
+struct demo_frame_jitter {
+    u8 prefill;         // 缓冲中, 深度达到target才出数
+    u8 seq_valid;       // next_seq有效
+    u8 target;          // 目标缓冲深度(帧)
+    u8 depth;           // 当前缓冲帧数
+    u8 depth_min;       // 统计窗口内出数后的最小深度
+    u8 plc_cnt;         // 连续补帧数
+    u8 repair;          // 最近一次出数为补帧
+    u16 next_seq;       // 下一个应该播放的序号
+    u16 win_cnt;        // 统计窗口计数
+    u16 last_len;
+    u8 last_frame[DEMO_FRAME_MAX_LEN];  // 上一个好帧, 丢包时重复送给解码器
+    struct demo_frame_jb_stat stat;
+};
+
+#define DEMO_JB_SEQ_BEFORE(a, b)    ((s16)((u16)(a) - (u16)(b)) < 0)
+
 //697n 耳机sdk 调用此解码demo时要注意时钟要大于等于48M，不然时钟容易不够跑
 static u32 *demo_frame_media_buf = NULL;
 static LIST_HEAD(demo_frame_media_head);
+static struct demo_frame_jitter demo_frame_jb = {
+    .prefill = 1,
+    .target = DEMO_JB_TARGET_INIT,
+    .depth_min = 0xff,
+};
+static u16 demo_frame_seq = 0;
 u16 demo_frame_test_tmr = 0;
 static u32 demo_frame_cnt = 0;
 #define DEMO_FRAME_TIME		5
@@ -116,6 +152,7 @@ static int demo_frame_dec_get_frame(struct audio_decoder *decoder, u8 **frame)
     }
 
     *frame = packet;
+    dec->repair = demo_frame_jb.repair;
 
     return len;
 }
@@ -125,7 +162,7 @@ static void demo_frame_dec_put_frame(struct audio_decoder *decoder, u8 *frame)
 {
     struct demo_frame_decoder *dec = container_of(decoder, struct demo_frame_decoder, decoder);
 
-    if (frame) {
+    if (frame && frame != demo_frame_jb.last_frame) {
         demo_frame_media_free_packet((void *)(frame));
     }
 }
@@ -196,6 +233,23 @@ static int demo_frame_dec_post_handler(struct audio_decoder *decoder)
 
 //解码后输出
 #ifndef CONFIG_MEDIA_DEVELOP_ENABLE
+#if !DEMO_FRAME_PLC_EN
+// 没有链接PLC库时的简单补帧: 重复帧的解码输出按连续丢包数逐级衰减, 避免重复音,
+// 最后一个补帧(cnt == DEMO_JB_PLC_MAX)静音, 之后同步到新序号从0开始
+static void demo_frame_plc_fade(s16 *data, int len, u8 cnt)
+{
+    int i;
+
+    if (cnt >= DEMO_JB_PLC_MAX) {
+        memset(data, 0, len);
+        return;
+    }
+    for (i = 0; i < len / 2; i++) {
+        data[i] >>= cnt;
+    }
+}
+#endif
+
 static int demo_frame_dec_output_handler(struct audio_decoder *decoder, s16 *data, int len, void *priv)
 {
     struct demo_frame_decoder *dec = container_of(decoder, struct demo_frame_decoder, decoder);
@@ -208,6 +262,13 @@ static int demo_frame_dec_output_handler(struct audio_decoder *decoder, s16 *dat
         r_printf("decoder NULL");
     }
     wdt_clear();
+#if DEMO_FRAME_PLC_EN
+    audio_plc_run(data, len, dec->repair);
+#else
+    if (dec->repair) {
+        demo_frame_plc_fade(data, len, demo_frame_jb.plc_cnt);
+    }
+#endif
     printf("demo data len:%d \n", len);
     put_buf(data, len);
     return len;
@@ -248,6 +309,9 @@ static void demo_frame_audio_res_close(void)
 
     // 关闭数据流节点
     demo_frame_dec->start = 0;
+#if DEMO_FRAME_PLC_EN
+    audio_plc_close();
+#endif
 #if 0
     audio_decoder_close(&demo_frame_dec->decoder);
     audio_mixer_ch_close(&demo_frame_dec->mix_ch);
@@ -375,6 +439,9 @@ static int demo_frame_dec_start(void)
     app_audio_state_switch(APP_AUDIO_STATE_MUSIC, get_max_sys_vol());
     app_audio_set_volume(APP_AUDIO_STATE_MUSIC, 16, 1);
 #endif
+#endif
+#if DEMO_FRAME_PLC_EN
+    audio_plc_open(dec->sr);
 #endif
     // 开始解码
     dec->start = 1;
@@ -390,6 +457,9 @@ static int demo_frame_dec_start(void)
 
 __err3:
     dec->start = 0;
+#if DEMO_FRAME_PLC_EN
+    audio_plc_close();
+#endif
 
 #if 0
     audio_mixer_ch_close(&dec->mix_ch);
@@ -490,23 +560,203 @@ int demo_frame_dec_close(void)
 }
 
 
+// 迟到或者缓冲空时加大目标深度, 重新开始统计窗口
+static void demo_frame_jb_target_inc(struct demo_frame_jitter *jb)
+{
+    if (jb->target < DEMO_JB_TARGET_MAX) {
+        jb->target++;
+    }
+    jb->win_cnt = 0;
+    jb->depth_min = 0xff;
+}
+
+// 每个统计窗口结束时调整: 窗口内都平稳则减小目标深度, 深度一直多于目标则丢一帧收回延时
+static struct demo_frame_media_rx_bulk *demo_frame_jb_adapt(struct demo_frame_jitter *jb)
+{
+    struct demo_frame_media_rx_bulk *drop = NULL;
+
+    if (jb->depth < jb->depth_min) {
+        jb->depth_min = jb->depth;
+    }
+    if (++jb->win_cnt < DEMO_JB_ADAPT_WIN) {
+        return NULL;
+    }
+    if (jb->depth_min > jb->target && jb->depth) {
+        drop = list_first_entry(&demo_frame_media_head, typeof(*drop), entry);
+        list_del(&drop->entry);
+        jb->depth--;
+        jb->next_seq = drop->seq + 1;
+        jb->stat.drop++;
+    }
+    if (jb->target > DEMO_JB_TARGET_MIN) {
+        jb->target--;
+    }
+    jb->win_cnt = 0;
+    jb->depth_min = 0xff;
+
+    return drop;
+}
+
 // 获取frame数据
 int demo_frame_media_get_packet(u8 **frame)
 {
+    struct demo_frame_jitter *jb = &demo_frame_jb;
     struct demo_frame_media_rx_bulk *p;
+    struct demo_frame_media_rx_bulk *drop = NULL;
+    int len;
+
     local_irq_disable();
-    if (demo_frame_media_head.next != &demo_frame_media_head) {
-        p = list_entry((&demo_frame_media_head)->next, typeof(*p), entry);
-        list_del(&p->entry);
-        *frame = p->data;
+    jb->repair = 0;
+    if (jb->depth == 0) {
+        // 缓冲空, 重新缓冲到target再出数
+        if (!jb->prefill) {
+            jb->prefill = 1;
+            jb->stat.underrun++;
+            demo_frame_jb_target_inc(jb);
+        }
         local_irq_enable();
-        return p->data_len;
+        return 0;
     }
+    if (jb->prefill) {
+        if (jb->depth < jb->target) {
+            local_irq_enable();
+            return 0;
+        }
+        jb->prefill = 0;
+    }
+
+    p = list_first_entry(&demo_frame_media_head, typeof(*p), entry);
+    if (jb->seq_valid && p->seq != jb->next_seq) {
+        // 序号不连续: 比next_seq旧的帧入队时已经丢弃, 这里是中间丢了帧
+        if (jb->last_len && jb->plc_cnt < DEMO_JB_PLC_MAX) {
+            jb->plc_cnt++;
+            jb->repair = 1;
+            jb->next_seq++;
+            jb->stat.lost++;
+            *frame = jb->last_frame;
+            local_irq_enable();
+            return jb->last_len;
+        }
+        // 还没有好帧或者连续丢得太多(对端重启等), 直接同步到新序号
+        jb->stat.lost += (u16)(p->seq - jb->next_seq);
+    }
+
+    list_del(&p->entry);
+    jb->depth--;
+    jb->seq_valid = 1;
+    jb->next_seq = p->seq + 1;
+    jb->plc_cnt = 0;
+    jb->last_len = p->data_len;
+    memcpy(jb->last_frame, p->data, p->data_len);
+    drop = demo_frame_jb_adapt(jb);
+    *frame = p->data;
+    len = p->data_len;
     local_irq_enable();
 
+    if (drop) {
+        lbuf_free(drop);
+    }
+
+    return len;
+}
+
+/* --------------------------------------------------------------------------*/
+/**
+ * @brief 收到一帧编码数据, 按序号放入抖动缓冲并通知解码
+ *
+ * @param [in] seq 帧序号(u16回绕)
+ * @param [in] data 编码数据
+ * @param [in] len 数据长度, 不能大于DEMO_FRAME_MAX_LEN
+ *
+ * @return 0:成功 <0:丢弃(迟到/重复/缓冲满/没有空间)
+ */
+/* ----------------------------------------------------------------------------*/
+int demo_frame_media_push(u16 seq, const u8 *data, int len)
+{
+    struct demo_frame_jitter *jb = &demo_frame_jb;
+    struct demo_frame_media_rx_bulk *p;
+    struct demo_frame_media_rx_bulk *pos;
+    int err = 0;
+
+    if (!demo_frame_media_buf || len <= 0 || len > DEMO_FRAME_MAX_LEN) {
+        return -EINVAL;
+    }
+    p = lbuf_alloc((struct lbuff_head *)demo_frame_media_buf, sizeof(*p) + len);
+    if (!p) {
+        return -ENOMEM;
+    }
+    p->seq = seq;
+    p->data_len = len;
+    memcpy(p->data, data, len);
+
+    local_irq_disable();
+    jb->stat.recv++;
+    if (jb->seq_valid && DEMO_JB_SEQ_BEFORE(seq, jb->next_seq)) {
+        // 已经播放过(或者已经补过帧)的序号
+        jb->stat.late++;
+        demo_frame_jb_target_inc(jb);
+        err = -ETIMEDOUT;
+        goto __exit;
+    }
+    if (jb->depth >= DEMO_JB_DEPTH_MAX) {
+        jb->stat.overflow++;
+        err = -ENOSPC;
+        goto __exit;
+    }
+    // 从尾部往前找插入位置, 顺序到达时直接挂到尾部
+    list_for_each_entry_reverse(pos, &demo_frame_media_head, entry) {
+        if (pos->seq == seq) {
+            jb->stat.dup++;
+            err = -EEXIST;
+            goto __exit;
+        }
+        if (DEMO_JB_SEQ_BEFORE(pos->seq, seq)) {
+            break;
+        }
+    }
+    list_add(&p->entry, &pos->entry);
+    jb->depth++;
+__exit:
+    local_irq_enable();
+
+    if (err) {
+        lbuf_free(p);
+        return err;
+    }
+    // 告诉上层有数据
+    demo_frame_media_rx_notice_to_decode();
+    return 0;
+}
+
+static void demo_frame_jb_reset(void)
+{
+    memset(&demo_frame_jb, 0, sizeof(demo_frame_jb));
+    demo_frame_jb.prefill = 1;
+    demo_frame_jb.target = DEMO_JB_TARGET_INIT;
+    demo_frame_jb.depth_min = 0xff;
+}
+
+int demo_frame_jb_stat_get(struct demo_frame_jb_stat *stat)
+{
+    local_irq_disable();
+    memcpy(stat, &demo_frame_jb.stat, sizeof(*stat));
+    stat->depth = demo_frame_jb.depth;
+    stat->target = demo_frame_jb.target;
+    local_irq_enable();
+    stat->latency_ms = stat->depth * DEMO_FRAME_DMS / 10;
     return 0;
 }
 
+static void demo_frame_jb_stat_dump(void)
+{
+    struct demo_frame_jb_stat stat;
+
+    demo_frame_jb_stat_get(&stat);
+    printf("jb recv:%d late:%d dup:%d lost:%d drop:%d ovf:%d udr:%d depth:%d/%d %dms\n",
+           stat.recv, stat.late, stat.dup, stat.lost, stat.drop, stat.overflow,
+           stat.underrun, stat.depth, stat.target, stat.latency_ms);
+}
+
 // 释放frame数据
 void demo_frame_media_free_packet(void *data)
 {
@@ -548,14 +798,7 @@ void *demo_frame_media_fetch_packet(int *len, void *prev_packet)
 // 获取数据量
 int demo_frame_media_get_packet_num(void)
 {
-    struct demo_frame_media_rx_bulk *p;
-    u32 num = 0;
-    local_irq_disable();
-    list_for_each_entry(p, &demo_frame_media_head, entry) {
-        num++;
-    }
-    local_irq_enable();
-    return num;
+    return demo_frame_jb.depth;
 }
 
 
@@ -567,17 +810,13 @@ int demo_frame_media_get_packet_num(void)
 // 用timer模拟填数
 static void demo_frame_test_time_func(void *param)
 {
-    struct demo_frame_media_rx_bulk *p;
     while (1) {
-        p = lbuf_alloc((struct lbuff_head *)demo_frame_media_buf, sizeof(*p) + DEC_DATA_POINTS);
-        if (!p) {
-            break;
-        }
         u32 data_num = DEC_DATA_POINTS > sizeof(enc_data) ? sizeof(enc_data) : DEC_DATA_POINTS;
         // 填数
-        p->data_len = data_num;
-        memcpy(p->data, &enc_data[demo_frame_cnt * data_num], data_num);
-
+        if (demo_frame_media_push(demo_frame_seq, &enc_data[demo_frame_cnt * data_num], data_num)) {
+            break;
+        }
+        demo_frame_seq++;
 
         demo_frame_cnt ++;
         if (demo_frame_cnt >= sizeof(enc_data) / data_num) {
@@ -585,12 +824,6 @@ static void demo_frame_test_time_func(void *param)
 
             demo_frame_cnt  = 0;
         }
-
-        local_irq_disable();
-        list_add_tail(&p->entry, &demo_frame_media_head);
-        local_irq_enable();
-        // 告诉上层有数据
-        demo_frame_media_rx_notice_to_decode();
     }
 }
 
@@ -603,8 +836,10 @@ static void demo_frame_test_close(void *param)
         demo_frame_test_tmr = 0;
     }
     demo_frame_dec_close();
+    demo_frame_jb_stat_dump();
     local_irq_disable();
     list_del_init(&demo_frame_media_head);
+    demo_frame_jb_reset();
     if (demo_frame_media_buf) {
         free(demo_frame_media_buf);
         demo_frame_media_buf = NULL;
@@ -6,7 +6,34 @@
 #include "media/includes.h"
 #include "system/includes.h"
 
+#define DEMO_FRAME_PLC_EN       0       //使用audio_plc库做丢包补偿(需要链接PLC库), 否则重复帧衰减输出
+#define DEMO_FRAME_MAX_LEN      128     //一帧编码数据最大字节数
+#define DEMO_FRAME_DMS          50      //一帧时长, 单位0.1ms
+
+#define DEMO_JB_TARGET_INIT     3       //抖动缓冲初始目标深度(帧)
+#define DEMO_JB_TARGET_MIN      2
+#define DEMO_JB_TARGET_MAX      12
+#define DEMO_JB_DEPTH_MAX       24      //缓冲帧数上限, 超过丢新帧
+#define DEMO_JB_ADAPT_WIN       400     //自适应统计窗口(帧)
+#define DEMO_JB_PLC_MAX         4       //连续补帧上限, 超过直接同步到新序号
+
+struct demo_frame_jb_stat {
+    u32 recv;           // 收到帧数
+    u32 late;           // 迟到丢弃
+    u32 dup;            // 重复丢弃
+    u32 lost;           // 丢失(补帧)
+    u32 drop;           // 收回延时丢弃
+    u32 overflow;       // 缓冲满丢弃
+    u32 underrun;       // 缓冲空次数
+    u8 depth;           // 当前深度(帧)
+    u8 target;          // 当前目标深度(帧)
+    u16 latency_ms;     // 当前缓冲延时
+};
+
 
 int audio_dec_init();
 
+int demo_frame_media_push(u16 seq, const u8 *data, int len);
+int demo_frame_jb_stat_get(struct demo_frame_jb_stat *stat);
+
 #endif/*_AUDIO_DEC_H_*/
@@ -10,6 +10,7 @@
 #include "audio_config.h"
 #include "audio_encode.h"
 #include "sbc_enc.h"
+#include "app_config.h"
 /* #include "api/mesh_config.h" */
 
 const unsigned char sin44K[88] ALIGNED(4) = {
@@ -26,7 +27,11 @@ extern struct audio_encoder_task *encode_task;
 #define ENC_ADC_IRQ_POINTS     (160)
 #define ENC_ADC_BUFS_SIZE      (ENC_BUF_NUM * ENC_ADC_IRQ_POINTS)
 
-#define MIC_USE_MIC_CHANNEL    (0)
+#if TRANS_VOICE_UPLINK_EN
+#define MIC_USE_MIC_CHANNEL    (1)  //语音上行编码mic数据
+#else
+#define MIC_USE_MIC_CHANNEL    (0)  //用timer模拟填正弦数据
+#endif
 #define ENC_IN_SIZE		(ENC_ADC_IRQ_POINTS * 2)
 #define ENC_OUT_SIZE       (ENC_ADC_IRQ_POINTS)
 #define ENC_CLK  96 * 1000000L    //编码时候的时钟
@@ -50,7 +55,8 @@ struct demo_enc_hdl {
     s16 adc_buf[ENC_ADC_BUFS_SIZE];    //align 4Bytes
 #endif
     int (*demo_output)(void *priv, void *buf, int len);
-
+    u32 frame_ts;   //当前编码帧首次取PCM的时间
+    struct audio_demo_enc_stat stat;
 };
 
 static struct demo_enc_hdl *demo_enc = NULL;
@@ -95,6 +101,9 @@ static int demo_enc_pcm_get(struct audio_encoder *encoder, s16 **frame, u16 fram
 
     if (pcm_len != frame_len) {
         putchar('L');
+        demo_enc->stat.pcm_underrun++;
+    } else if (!demo_enc->frame_ts) {
+        demo_enc->frame_ts = sys_timer_get_ms();
     }
     /* putchar('D'); */
 
@@ -122,10 +131,24 @@ static int demo_enc_output_handler(struct audio_encoder *encoder, u8 *frame, int
         r_printf("encoder NULL");
     }
     wdt_clear();
+    if (demo_enc == NULL) {
+        return len;
+    }
+    if (demo_enc->frame_ts) {
+        //编码延时: 取第一笔PCM到输出编码帧
+        u32 lat = sys_timer_get_ms() - demo_enc->frame_ts;
+        demo_enc->frame_ts = 0;
+        demo_enc->stat.lat_sum_ms += lat;
+        if (lat > demo_enc->stat.lat_max_ms) {
+            demo_enc->stat.lat_max_ms = lat;
+        }
+    }
+    demo_enc->stat.frames++;
+    demo_enc->stat.bytes += len;
+    if (demo_enc->demo_output) {
+        return demo_enc->demo_output(NULL, frame, len);
+    }
     printf("demo frame len:%d \n", len);
-    /* if (demo_enc && demo_enc->demo_output) { */
-    /* demo_enc->demo_output(NULL, frame, len); */
-    /* } */
     put_buf(frame, len);
     return len;
 }
@@ -177,12 +200,15 @@ static void adc_mic_output_handler(void *priv, s16 *data, int len)
         u16 wlen = cbuf_write(&demo_enc->pcm_in_cbuf, data, len);
         if (wlen != len) {
             putchar('@');
+            demo_enc->stat.pcm_overrun++;
         }
         audio_encoder_resume(&demo_enc->encoder);
         demo_enc_resume();
     }
 }
 
+#define DEMO_FRAME_TEST_MS      10  //320字节=16k单声道10ms, 按实时速率喂数
+
 static void demo_frame_test_time_func(void *param)
 {
     u32 len = 320; //每次写的字节数
@@ -194,6 +220,7 @@ static void demo_frame_test_time_func(void *param)
         u16 wlen = cbuf_write(&demo_enc->pcm_in_cbuf, pcm_frames, len);
         if (wlen != len) {
             putchar('@');
+            demo_enc->stat.pcm_overrun++;
         }
 
         audio_encoder_resume(&demo_enc->encoder);
@@ -321,10 +348,12 @@ int audio_demo_enc_open(int (*demo_output)(void *priv, void *buf, int len), u32
     }
 
     int start_err = audio_encoder_start(&demo_enc->encoder);
+#if !MIC_USE_MIC_CHANNEL
     // 用timer模拟填数,填入需要编码的源数据
-    demo_frame_test_tmr = sys_hi_timer_add(NULL, demo_frame_test_time_func, 40);
+    demo_frame_test_tmr = sys_hi_timer_add(NULL, demo_frame_test_time_func, DEMO_FRAME_TEST_MS);
     /* demo_frame_test_time_func(NULL); */
     printf("id:%d \n", demo_frame_test_tmr);
+#endif
 //把mic采到的数据编码
 #if MIC_USE_MIC_CHANNEL
     demo_enc->clk_before = clk_get("sys");
@@ -368,6 +397,10 @@ int audio_demo_enc_close()
         return -1;
     }
     printf("audio_demo_enc_close\n");
+    if (demo_frame_test_tmr) {
+        sys_hi_timer_del(demo_frame_test_tmr);
+        demo_frame_test_tmr = 0;
+    }
 #if MIC_USE_MIC_CHANNEL
     clk_set("sys", demo_enc->clk_before);
     audio_adc_mic_close(&demo_enc->mic_ch);
@@ -390,6 +423,18 @@ int audio_demo_enc_close()
     return 0;
 }
 
+int audio_demo_enc_stat_get(struct audio_demo_enc_stat *stat, u8 reset)
+{
+    if (!demo_enc) {
+        return -1;
+    }
+    memcpy(stat, &demo_enc->stat, sizeof(*stat));
+    if (reset) {
+        memset(&demo_enc->stat, 0, sizeof(demo_enc->stat));
+    }
+    return 0;
+}
+
 int audio_enc_init()
 {
     printf("audio_enc_init\n");
@@ -7,6 +7,18 @@
 #include "system/includes.h"
 
 
+struct audio_demo_enc_stat {
+    u32 frames;         //输出编码帧数
+    u32 bytes;          //输出编码字节数
+    u32 pcm_overrun;    //PCM输入缓存满丢数次数
+    u32 pcm_underrun;   //编码取数不足次数
+    u32 lat_max_ms;     //编码延时最大值
+    u32 lat_sum_ms;     //编码延时累计,除以frames得平均值
+};
+
 int audio_enc_init();
+int audio_demo_enc_open(int (*demo_output)(void *priv, void *buf, int len), u32 code_type, u8 ai_type);
+int audio_demo_enc_close();
+int audio_demo_enc_stat_get(struct audio_demo_enc_stat *stat, u8 reset);
 
 #endif/*_AUDIO_ENC_H_*/
@@ -0,0 +1,551 @@
+#include "asm/includes.h"
+#include "asm/iic_hw.h"
+#include "asm/iic_soft.h"
+#include "asm/iic_queue.h"
+#include "system/includes.h"
+#include "generic/jiffies.h"
+#include "app_config.h"
+
+/*
+ * iic传输队列
+ *
+ * 各传感器原来在自己的任务/定时中断里逐字节阻塞读写, 软件iic还要关中断(spin_lock)保证总线互斥.
+ * 这里所有传输都交给iic_queue任务执行:
+ *   - 每个从设备(client)一个FIFO, 任务每次从下一个有传输的client取一条, 多个设备公平分享总线,
+ *     一个设备连续提交也不会饿死其他设备;
+ *   - 一条传输是一次完整的"写 + repeated start + 读", 整段读用read_buf连续读出;
+ *   - 总线操作在任务里做, 不关中断, 高优先级任务和中断不受影响.
+ * bd19硬件iic主机模式没有接收DMA, 仍是逐字节等pending, 只是挪到了iic_queue任务中.
+ */
+
+#define LOG_TAG             "[IIC_QUEUE]"
+#define LOG_ERROR_ENABLE
+#define LOG_INFO_ENABLE
+#include "debug.h"
+
+#if CONFIG_IIC_QUEUE_ENABLE
+
+#define IIC_QUEUE_TASK_NAME     "iic_queue"
+
+#ifndef IIC_QUEUE_CLIENT_NUM
+#define IIC_QUEUE_CLIENT_NUM    4
+#endif
+
+#ifndef IIC_QUEUE_MOCK_BUS_ENABLE
+#define IIC_QUEUE_MOCK_BUS_ENABLE   0
+#endif
+
+//硬件iic驱动(iic_hw.c)在本SDK中整体被#if 0屏蔽, 库里也没有hw_iic_xxx, 默认不接硬件iic
+#ifndef IIC_QUEUE_HW_BUS_ENABLE
+#define IIC_QUEUE_HW_BUS_ENABLE     0
+#endif
+
+struct iic_bus_ops {
+    void (*start)(int iic);
+    void (*stop)(int iic);
+    u8(*tx_byte)(int iic, u8 byte);
+    int (*read_buf)(int iic, void *buf, int len);
+};
+
+struct iic_client_stat {
+    u32 xfer;           //执行的传输数
+    u32 err;            //出错的传输数
+    u32 bytes;          //读写字节数(不含地址)
+    u32 wait_sum;       //提交到开始执行的等待时间累计, 0.5ms
+    u32 bus_sum;        //占用总线时间累计, 0.5ms
+    u16 wait_max;
+    u16 bus_max;
+    u8 max_queued;
+};
+
+struct iic_client {
+    const char *name;
+    const struct iic_bus_ops *ops;
+    struct iic_xfer *head;
+    struct iic_xfer *tail;
+    u8 used;
+    u8 closing;
+    u8 iic;
+    u8 addr;
+    u8 byte_delay;
+    u8 queued;
+    struct iic_client_stat stat;
+};
+
+static struct {
+    struct iic_client client[IIC_QUEUE_CLIENT_NUM];
+    struct iic_client *busy;
+    OS_SEM sem;
+    u16 queued;
+    u8 rr;              //下一次从该client开始找
+    u8 init;
+    u32 wakeup;
+} iic_queue;
+
+static const struct iic_bus_ops iic_soft_bus_ops = {
+    .start      = soft_iic_start,
+    .stop       = soft_iic_stop,
+    .tx_byte    = soft_iic_tx_byte,
+    .read_buf   = soft_iic_read_buf,
+};
+
+#if IIC_QUEUE_HW_BUS_ENABLE
+static const struct iic_bus_ops iic_hw_bus_ops = {
+    .start      = hw_iic_start,
+    .stop       = hw_iic_stop,
+    .tx_byte    = hw_iic_tx_byte,
+    .read_buf   = hw_iic_read_buf,
+};
+#endif
+
+#if IIC_QUEUE_MOCK_BUS_ENABLE
+/*
+ * 模拟总线: 只挂一个从设备, 第一个写字节为寄存器地址, 之后读写都自增
+ */
+enum {
+    MOCK_IDLE = 0,
+    MOCK_ADDR,
+    MOCK_REG,
+    MOCK_WRITE,
+    MOCK_READ,
+};
+
+static struct {
+    u8 *regs;
+    u16 size;
+    u16 byte_delay;
+    u8 addr;
+    u8 ptr;
+    u8 state;
+} iic_mock;
+
+void iic_queue_mock_attach(u8 addr, u8 *regs, u16 size, u16 byte_delay)
+{
+    iic_mock.addr = addr;
+    iic_mock.regs = regs;
+    iic_mock.size = size;
+    iic_mock.byte_delay = byte_delay;
+    iic_mock.state = MOCK_IDLE;
+}
+
+static void iic_mock_start(int iic)
+{
+    iic_mock.state = MOCK_ADDR;
+}
+
+static void iic_mock_stop(int iic)
+{
+    iic_mock.state = MOCK_IDLE;
+}
+
+static u8 iic_mock_tx_byte(int iic, u8 byte)
+{
+    delay(iic_mock.byte_delay);
+
+    switch (iic_mock.state) {
+    case MOCK_ADDR:
+        if (!iic_mock.regs || (byte >> 1) != iic_mock.addr) {
+            iic_mock.state = MOCK_IDLE;
+            return 0;
+        }
+        iic_mock.state = (byte & 1) ? MOCK_READ : MOCK_REG;
+        return 1;
+    case MOCK_REG:
+        iic_mock.ptr = byte;
+        iic_mock.state = MOCK_WRITE;
+        return 1;
+    case MOCK_WRITE:
+        iic_mock.regs[iic_mock.ptr % iic_mock.size] = byte;
+        iic_mock.ptr++;
+        return 1;
+    default:
+        return 0;
+    }
+}
+
+static int iic_mock_read_buf(int iic, void *buf, int len)
+{
+    int i;
+
+    if (!buf || !len) {
+        return -1;
+    }
+    for (i = 0; i < len; i++) {
+        delay(iic_mock.byte_delay);
+        if (iic_mock.state == MOCK_READ) {
+            ((u8 *)buf)[i] = iic_mock.regs[iic_mock.ptr % iic_mock.size];
+            iic_mock.ptr++;
+        } else {
+            ((u8 *)buf)[i] = 0xff;
+        }
+    }
+    return len;
+}
+
+static const struct iic_bus_ops iic_mock_bus_ops = {
+    .start      = iic_mock_start,
+    .stop       = iic_mock_stop,
+    .tx_byte    = iic_mock_tx_byte,
+    .read_buf   = iic_mock_read_buf,
+};
+#endif
+
+static int iic_queue_run_one(void);
+
+static void iic_queue_task(void *p)
+{
+    while (1) {
+        os_sem_pend(&iic_queue.sem, 0);
+        iic_queue.wakeup++;
+        while (iic_queue_run_one());
+    }
+}
+
+static int iic_queue_init(void)
+{
+    int err;
+
+    if (iic_queue.init) {
+        return 0;
+    }
+    os_sem_create(&iic_queue.sem, 0);
+    err = task_create(iic_queue_task, NULL, IIC_QUEUE_TASK_NAME);
+    if (err) {
+        log_error("task create err %d", err);
+        return err;
+    }
+    iic_queue.init = 1;
+    return 0;
+}
+
+iic_client_t iic_client_open(const char *name, u8 bus, u8 iic, u8 addr, u8 byte_delay)
+{
+    const struct iic_bus_ops *ops;
+    struct iic_client *c = NULL;
+    int i;
+
+    switch (bus) {
+    case IIC_QUEUE_BUS_SOFT:
+        ops = &iic_soft_bus_ops;
+        break;
+#if IIC_QUEUE_HW_BUS_ENABLE
+    case IIC_QUEUE_BUS_HW:
+        ops = &iic_hw_bus_ops;
+        break;
+#endif
+#if IIC_QUEUE_MOCK_BUS_ENABLE
+    case IIC_QUEUE_BUS_MOCK:
+        ops = &iic_mock_bus_ops;
+        break;
+#endif
+    default:
+        log_error("%s: bus %d not supported", name, bus);
+        return NULL;
+    }
+    if (iic_queue_init()) {
+        return NULL;
+    }
+
+    local_irq_disable();
+    for (i = 0; i < IIC_QUEUE_CLIENT_NUM; i++) {
+        if (!iic_queue.client[i].used) {
+            c = &iic_queue.client[i];
+            memset(c, 0, sizeof(*c));
+            c->name = name;
+            c->ops = ops;
+            c->iic = iic;
+            c->addr = addr;
+            c->byte_delay = byte_delay;
+            c->used = 1;
+            break;
+        }
+    }
+    local_irq_enable();
+
+    if (!c) {
+        log_error("no free client for %s", name);
+    }
+    return c;
+}
+
+static void iic_client_free(struct iic_client *c)
+{
+    c->closing = 0;
+    c->used = 0;
+}
+
+void iic_client_close(iic_client_t c)
+{
+    struct iic_xfer *x;
+    struct iic_xfer *next;
+
+    if (!c || !c->used) {
+        return;
+    }
+    local_irq_disable();
+    x = c->head;
+    c->head = NULL;
+    c->tail = NULL;
+    iic_queue.queued -= c->queued;
+    c->queued = 0;
+    if (iic_queue.busy == c) {
+        //正在执行的传输完成后由iic_queue任务释放
+        c->closing = 1;
+    } else {
+        iic_client_free(c);
+    }
+    local_irq_enable();
+
+    for (; x; x = next) {
+        next = x->next;
+        x->pending = 0;
+        if (x->cb) {
+            x->cb(x, -EINTR);
+        }
+    }
+}
+
+int iic_xfer_submit(iic_client_t c, struct iic_xfer *x)
+{
+    u8 kick;
+
+    if (!c || !x || (!x->wlen && !x->rlen)) {
+        return -EINVAL;
+    }
+
+    local_irq_disable();
+    if (!c->used || c->closing) {
+        local_irq_enable();
+        return -EINVAL;
+    }
+    if (x->pending) {
+        local_irq_enable();
+        return -EBUSY;
+    }
+    x->pending = 1;
+    x->next = NULL;
+    x->submit_hms = jiffies_half_msec();
+    if (c->tail) {
+        c->tail->next = x;
+    } else {
+        c->head = x;
+    }
+    c->tail = x;
+    c->queued++;
+    if (c->queued > c->stat.max_queued) {
+        c->stat.max_queued = c->queued;
+    }
+    //队列由空变非空才唤醒任务, 任务会一直取到队列为空
+    kick = (iic_queue.queued++ == 0);
+    local_irq_enable();
+
+    if (kick) {
+        os_sem_post(&iic_queue.sem);
+    }
+    return 0;
+}
+
+static int iic_xfer_exec(struct iic_client *c, struct iic_xfer *x)
+{
+    const struct iic_bus_ops *ops = c->ops;
+    int ret = 0;
+    int i;
+
+    ops->start(c->iic);
+    if (x->wlen) {
+        if (!ops->tx_byte(c->iic, c->addr << 1)) {
+            ret = -ENXIO;
+            goto __stop;
+        }
+        for (i = 0; i < x->wlen; i++) {
+            delay(c->byte_delay);
+            if (!ops->tx_byte(c->iic, x->wbuf[i])) {
+                ret = -EIO;
+                goto __stop;
+            }
+        }
+        ret = x->wlen;
+    }
+    if (x->rlen) {
+        if (x->wlen) {
+            //repeated start
+            ops->start(c->iic);
+        }
+        if (!ops->tx_byte(c->iic, (c->addr << 1) | 1)) {
+            ret = -ENXIO;
+            goto __stop;
+        }
+        delay(c->byte_delay);
+        ret = ops->read_buf(c->iic, x->rbuf, x->rlen);
+        if (ret != x->rlen) {
+            ret = -EIO;
+        }
+    }
+
+__stop:
+    ops->stop(c->iic);
+    delay(c->byte_delay);
+    return ret;
+}
+
+static void iic_client_stat_update(struct iic_client *c, struct iic_xfer *x, int ret,
+                                   u32 start_hms, u32 end_hms)
+{
+    struct iic_client_stat *s = &c->stat;
+    u32 wait = start_hms - x->submit_hms;
+    u32 bus = end_hms - start_hms;
+
+    s->xfer++;
+    if (ret < 0) {
+        s->err++;
+    } else {
+        s->bytes += x->wlen + x->rlen;
+    }
+    s->wait_sum += wait;
+    s->bus_sum += bus;
+    if (wait > s->wait_max) {
+        s->wait_max = wait > 0xffff ? 0xffff : wait;
+    }
+    if (bus > s->bus_max) {
+        s->bus_max = bus > 0xffff ? 0xffff : bus;
+    }
+}
+
+/*
+ * 从rr开始找下一个有传输的client, 执行一条
+ * @return 1 执行了一条，0 队列为空
+ */
+static int iic_queue_run_one(void)
+{
+    struct iic_client *c = NULL;
+    struct iic_xfer *x;
+    u32 start_hms;
+    int ret;
+    int i;
+
+    local_irq_disable();
+    for (i = 0; i < IIC_QUEUE_CLIENT_NUM; i++) {
+        c = &iic_queue.client[(iic_queue.rr + i) % IIC_QUEUE_CLIENT_NUM];
+        if (c->used && c->head) {
+            break;
+        }
+        c = NULL;
+    }
+    if (!c) {
+        local_irq_enable();
+        return 0;
+    }
+    iic_queue.rr = (c - iic_queue.client + 1) % IIC_QUEUE_CLIENT_NUM;
+    x = c->head;
+    c->head = x->next;
+    if (!c->head) {
+        c->tail = NULL;
+    }
+    c->queued--;
+    iic_queue.queued--;
+    iic_queue.busy = c;
+    local_irq_enable();
+
+    start_hms = jiffies_half_msec();
+    ret = iic_xfer_exec(c, x);
+    iic_client_stat_update(c, x, ret, start_hms, jiffies_half_msec());
+
+    local_irq_disable();
+    iic_queue.busy = NULL;
+    if (c->closing) {
+        iic_client_free(c);
+    }
+    x->pending = 0;
+    local_irq_enable();
+
+    if (x->cb) {
+        x->cb(x, ret);
+    }
+    return 1;
+}
+
+struct iic_xfer_sync_ctx {
+    OS_SEM sem;
+    int result;
+};
+
+static void iic_xfer_sync_done(struct iic_xfer *x, int result)
+{
+    struct iic_xfer_sync_ctx *ctx = (struct iic_xfer_sync_ctx *)x->priv;
+
+    ctx->result = result;
+    os_sem_post(&ctx->sem);
+}
+
+int iic_xfer_sync(iic_client_t c, struct iic_xfer *x)
+{
+    struct iic_xfer_sync_ctx ctx;
+    int ret;
+
+    if (cpu_in_irq()) {
+        return -EINVAL;
+    }
+    if (!strcmp(os_current_task(), IIC_QUEUE_TASK_NAME)) {
+        //在传输完成回调里再发起同步传输, 总线此时空闲, 直接执行
+        u32 start_hms = jiffies_half_msec();
+        ret = iic_xfer_exec(c, x);
+        iic_client_stat_update(c, x, ret, start_hms, jiffies_half_msec());
+        return ret;
+    }
+
+    os_sem_create(&ctx.sem, 0);
+    ctx.result = 0;
+    x->cb = iic_xfer_sync_done;
+    x->priv = &ctx;
+    ret = iic_xfer_submit(c, x);
+    if (ret == 0) {
+        os_sem_pend(&ctx.sem, 0);
+        ret = ctx.result;
+    }
+    os_sem_del(&ctx.sem, 0);
+    return ret;
+}
+
+int iic_reg_read(iic_client_t c, u8 reg, u8 *buf, u16 len)
+{
+    struct iic_xfer x;
+
+    iic_xfer_init(&x, &reg, 1, buf, len, NULL, NULL);
+    return iic_xfer_sync(c, &x);
+}
+
+int iic_reg_write(iic_client_t c, u8 reg, u8 val)
+{
+    struct iic_xfer x;
+    u8 buf[2] = {reg, val};
+    int ret;
+
+    iic_xfer_init(&x, buf, 2, NULL, 0, NULL, NULL);
+    ret = iic_xfer_sync(c, &x);
+    return ret < 0 ? ret : 0;
+}
+
+void iic_queue_stat_dump(void)
+{
+    struct iic_client_stat s;
+    struct iic_client *c;
+    int i;
+
+    log_info("wakeup %d, queued %d", iic_queue.wakeup, iic_queue.queued);
+    for (i = 0; i < IIC_QUEUE_CLIENT_NUM; i++) {
+        c = &iic_queue.client[i];
+        if (!c->used) {
+            continue;
+        }
+        local_irq_disable();
+        memcpy(&s, &c->stat, sizeof(s));
+        local_irq_enable();
+        log_info("%s(0x%x): xfer %d, err %d, bytes %d, max_queued %d", c->name, c->addr,
+                 s.xfer, s.err, s.bytes, s.max_queued);
+        log_info("%s(0x%x): wait avg %d max %d, bus avg %d max %d (0.5ms)", c->name, c->addr,
+                 s.xfer ? s.wait_sum / s.xfer : 0, s.wait_max,
+                 s.xfer ? s.bus_sum / s.xfer : 0, s.bus_max);
+    }
+}
+
+#endif
@@ -0,0 +1,194 @@
+#include "asm/includes.h"
+#include "system/includes.h"
+#include "os/os_api.h"
+#include "app_config.h"
+#include <stdarg.h>
+
+/*
+ * 句柄方式taskq
+ *
+ * 与rom里的__os_taskq_post()使用同一个任务queue和同一种消息格式:
+ *   头: (type << 8) | argc, 后跟argc个int参数, 每项4字节
+ * 区别只在于任务和queue在get_handle时解析一次, 发送时不再按名字查找.
+ */
+
+#define LOG_TAG             "[OS_TASKQ]"
+#define LOG_ERROR_ENABLE
+#define LOG_INFO_ENABLE
+#include "debug.h"
+
+#define OS_TASKQ_HANDLE_NUM     8
+
+struct os_taskq_stat {
+    u32 post;           /*成功发送的消息条数*/
+    u32 full;           /*queue空间不足的次数*/
+    u16 max_depth;      /*发送后queue中的最大项数(4字节为一项)*/
+    u32 max_cost;       /*单次发送最大耗时(TICK_CNT计数)*/
+};
+
+struct os_taskq_hdl {
+    const char *name;
+    void *task;
+    void *queue;
+    struct os_taskq_stat stat;
+};
+
+/*rom接口*/
+extern void *xTaskGetHandle(const char *name);
+extern void *get_taskq(void *task);
+extern long xQueueGenericSendFromISR(void *queue, const void *item, long *woken, long pos);
+extern unsigned long uxQueueSpacesAvailable(const void *queue);
+extern unsigned long uxQueueMessagesWaiting(const void *queue);
+extern void vPortYield(void);
+
+static struct os_taskq_hdl taskq_hdl[OS_TASKQ_HANDLE_NUM];
+
+static inline u32 taskq_tick_diff(u32 begin, u32 end)
+{
+    return end >= begin ? end - begin : end + TICK_PRD - begin;
+}
+
+os_taskq_t os_taskq_get_handle(const char *name)
+{
+    struct os_taskq_hdl *h = NULL;
+    void *task;
+    void *queue;
+    int i;
+
+    task = xTaskGetHandle(name);
+    if (!task) {
+        return NULL;
+    }
+    queue = get_taskq(task);
+    if (!queue) {
+        return NULL;
+    }
+
+    local_irq_disable();
+    for (i = 0; i < OS_TASKQ_HANDLE_NUM; i++) {
+        if (taskq_hdl[i].task == task) {
+            h = &taskq_hdl[i];
+            break;
+        }
+        if (!h && !taskq_hdl[i].task) {
+            h = &taskq_hdl[i];
+        }
+    }
+    if (h && h->task != task) {
+        memset(h, 0, sizeof(*h));
+        h->name = name;
+        h->task = task;
+        h->queue = queue;
+    }
+    local_irq_enable();
+
+    if (!h) {
+        log_error("no free handle for %s", name);
+    }
+    return h;
+}
+
+/*
+ * 调用前已关中断并确认空间足够
+ */
+static void __os_taskq_send(struct os_taskq_hdl *h, int type, int argc, int *argv, long *woken)
+{
+    int head = (type << 8) | (argc & 0xff);
+    int i;
+
+    xQueueGenericSendFromISR(h->queue, &head, woken, 0);
+    for (i = 0; i < argc; i++) {
+        xQueueGenericSendFromISR(h->queue, &argv[i], woken, 0);
+    }
+}
+
+static void os_taskq_stat_update(struct os_taskq_hdl *h, int num, u32 begin)
+{
+    u32 depth = uxQueueMessagesWaiting(h->queue);
+    u32 cost = taskq_tick_diff(begin, TICK_CNT);
+
+    h->stat.post += num;
+    if (depth > h->stat.max_depth) {
+        h->stat.max_depth = depth;
+    }
+    if (cost > h->stat.max_cost) {
+        h->stat.max_cost = cost;
+    }
+}
+
+int os_taskq_post_batch_h(os_taskq_t h, const struct os_taskq_msg *msg, int num)
+{
+    u32 begin = TICK_CNT;
+    long woken = 0;
+    u32 need = 0;
+    int i;
+
+    if (!h || !h->queue) {
+        return OS_TASK_NOT_EXIST;
+    }
+    for (i = 0; i < num; i++) {
+        need += msg[i].argc + 1;
+    }
+
+    local_irq_disable();
+    if (uxQueueSpacesAvailable(h->queue) < need) {
+        h->stat.full++;
+        local_irq_enable();
+        return OS_Q_FULL;
+    }
+    for (i = 0; i < num; i++) {
+        __os_taskq_send(h, msg[i].type, msg[i].argc, msg[i].argv, &woken);
+    }
+    os_taskq_stat_update(h, num, begin);
+    local_irq_enable();
+
+    if (woken) {
+        vPortYield();
+    }
+    return OS_NO_ERR;
+}
+
+int os_taskq_post_h(os_taskq_t h, int type, int argc, int *argv)
+{
+    struct os_taskq_msg msg;
+
+    msg.type = type;
+    msg.argc = argc;
+    msg.argv = argv;
+    return os_taskq_post_batch_h(h, &msg, 1);
+}
+
+int os_taskq_post_msg_h(os_taskq_t h, int argc, ...)
+{
+    int argv[8];
+    va_list argptr;
+    int i;
+
+    if (argc > ARRAY_SIZE(argv)) {
+        return OS_ERR_INVALID_OPT;
+    }
+    va_start(argptr, argc);
+    for (i = 0; i < argc; i++) {
+        argv[i] = va_arg(argptr, int);
+    }
+    va_end(argptr);
+
+    return os_taskq_post_h(h, Q_MSG, argc, argv);
+}
+
+void os_taskq_stat_dump(void)
+{
+    struct os_taskq_stat stat;
+    int i;
+
+    for (i = 0; i < OS_TASKQ_HANDLE_NUM; i++) {
+        if (!taskq_hdl[i].task) {
+            continue;
+        }
+        local_irq_disable();
+        memcpy(&stat, &taskq_hdl[i].stat, sizeof(stat));
+        local_irq_enable();
+        log_info("%s: post %d, full %d, max_depth %d, max_cost %d",
+                 taskq_hdl[i].name, stat.post, stat.full, stat.max_depth, stat.max_cost);
+    }
+}
@@ -247,6 +247,11 @@ SECTIONS
 		//cpu start
         *(.data*)
 
+        . = ALIGN(4);
+        mem_slab_begin = .;
+        KEEP(*(.mem_slab))
+        mem_slab_end = .;
+
         . = ALIGN(32);
 		#include "btstack/btstack_lib_data.ld"
 		. = ALIGN(4);
@@ -620,6 +625,17 @@ SECTIONS
 #include "btctrler/port/bd19/btctler_lib.ld"
 #include "update/update.ld"
 #include "driver/cpu/bd19/driver_lib.ld"
+
+SECTIONS
+{
+    //延迟日志(dlog)格式串: INFO段不占地址空间也不下载, 段内偏移即格式串ID,
+    //由cpu/bd19/tools/dlog_decode.py从sdk.elf读取
+    .dlog_str 0 (INFO) :
+    {
+        KEEP(*(.dlog_str))
+    }
+}
+
 //================== Section Info Export ====================//
 text_begin  = ADDR(.text);
 text_size   = SIZEOF(.text);
@@ -92,6 +92,14 @@ struct tone_file_handle {
 #if (SYS_VOL_TYPE == VOL_TYPE_DIGITAL)
     dvol_handle *dvol;
 #endif
+#if TONE_PCM_CACHE_EN
+    u8 pcm_play;                        // 正在从PCM缓存直接输出
+    volatile u8 pcm_busy;               // audio_pwm_task正在往输出写缓存数据, 不能释放
+    u8 first_out;                       // 已经输出第一包数据
+    u32 cache_pos;
+    struct tone_pcm_cache *cache;       // 当前播放的缓存
+    struct tone_pcm_cache *capture;     // 当前解码输出正在填充的缓存
+#endif
 };
 
 struct tone_dec_handle {
@@ -124,6 +132,161 @@ extern int bt_audio_sync_nettime_select(u8 basetime);
 extern u32 bt_audio_sync_lat_time(void);
 static void file_decoder_syncts_free(struct tone_file_handle *dec);
 
+#if TONE_PCM_CACHE_EN
+/*
+ * 提示音PCM缓存
+ * tone_table.c里通过tone_pcm_cache_add()登记常用提示音, 第一次播放时把解码输出
+ * 录到缓存里, 之后再播放就不打开文件和解码器, 直接把PCM写到audio_pwm.
+ * 缓存一旦填好就常驻, 超过TONE_PCM_CACHE_MAX_LEN的提示音不缓存.
+ */
+struct tone_pcm_cache {
+    const char *name;
+    s16 *pcm;
+    u32 len;
+    u8 valid;
+    u8 nocache;         // 太长, 放弃缓存
+};
+
+static struct tone_pcm_cache tone_pcm_cache_tab[TONE_PCM_CACHE_NUM];
+static struct tone_latency_stat tone_lat_stat;
+static u32 tone_req_ms;
+static os_taskq_t tone_app_core_q;    // 输出回调里发消息, 不每次按名字查找任务
+
+static int tone_pcm_play_start(void);
+static int tone_pcm_play_run(void);
+
+int tone_pcm_cache_add(const char *name)
+{
+    int i;
+
+    if (!name || IS_REPEAT_BEGIN(name) || IS_REPEAT_END(name) || IS_DEFAULT_SINE(name)) {
+        return -EINVAL;
+    }
+    for (i = 0; i < TONE_PCM_CACHE_NUM; i++) {
+        if (!tone_pcm_cache_tab[i].name) {
+            tone_pcm_cache_tab[i].name = name;
+            return 0;
+        }
+    }
+    log_error("tone pcm cache full:%s", name);
+    return -ENOMEM;
+}
+
+static struct tone_pcm_cache *tone_pcm_cache_find(const char *name)
+{
+    int i;
+
+    if (!name || IS_REPEAT_BEGIN(name) || IS_REPEAT_END(name) || IS_DEFAULT_SINE(name)) {
+        return NULL;
+    }
+    for (i = 0; i < TONE_PCM_CACHE_NUM; i++) {
+        if (tone_pcm_cache_tab[i].name && strcmp(tone_pcm_cache_tab[i].name, name) == 0) {
+            return &tone_pcm_cache_tab[i];
+        }
+    }
+    return NULL;
+}
+
+// 解码播放登记过的提示音时开始录制解码输出
+static void tone_pcm_cache_capture_begin(struct tone_file_handle *dec)
+{
+    struct tone_pcm_cache *cache = tone_pcm_cache_find(dec->list[dec->idx]);
+
+    dec->capture = NULL;
+    if (!cache || cache->valid || cache->nocache) {
+        return;
+    }
+    if (!cache->pcm) {
+        cache->pcm = malloc(TONE_PCM_CACHE_MAX_LEN);
+        if (!cache->pcm) {
+            return;
+        }
+    }
+    cache->len = 0;
+    dec->capture = cache;
+}
+
+/*
+ * 在数字音量之前把解码输出拷到缓存末尾(暂不计入长度), 输出写入wlen字节后
+ * 再用tone_pcm_cache_commit()提交, 缓存里保存的是原始音量的数据
+ */
+static void tone_pcm_cache_capture(struct tone_file_handle *dec, s16 *data, int len)
+{
+    struct tone_pcm_cache *cache = dec->capture;
+
+    if (!cache || len <= 0) {
+        return;
+    }
+    if (cache->len + len > TONE_PCM_CACHE_MAX_LEN) {
+        log_info("tone too long to cache:%s", cache->name);
+        free(cache->pcm);
+        cache->pcm = NULL;
+        cache->len = 0;
+        cache->nocache = 1;
+        dec->capture = NULL;
+        return;
+    }
+    memcpy((u8 *)cache->pcm + cache->len, data, len);
+}
+
+static void tone_pcm_cache_commit(struct tone_file_handle *dec, int wlen)
+{
+    if (dec->capture && wlen > 0) {
+        dec->capture->len += wlen;
+    }
+}
+
+// ok:解码正常结束, 缓存生效; 否则(被打断/出错)丢弃已录制的数据
+static void tone_pcm_cache_capture_end(struct tone_file_handle *dec, u8 ok)
+{
+    struct tone_pcm_cache *cache = dec->capture;
+    s16 *pcm;
+
+    if (!cache) {
+        return;
+    }
+    dec->capture = NULL;
+    if (!ok || cache->len == 0) {
+        cache->len = 0;
+        return;
+    }
+    pcm = realloc(cache->pcm, cache->len);
+    if (pcm) {
+        cache->pcm = pcm;
+    }
+    cache->valid = 1;
+    log_info("tone cached:%s,%d bytes", cache->name, cache->len);
+}
+
+// 记录从请求播放到第一包数据写到输出的时间
+static void tone_latency_mark(struct tone_file_handle *dec)
+{
+    u32 ms;
+
+    if (dec->first_out) {
+        return;
+    }
+    dec->first_out = 1;
+    ms = sys_timer_get_ms() - tone_req_ms;
+    tone_lat_stat.play_cnt++;
+    if (dec->pcm_play) {
+        tone_lat_stat.cache_hit++;
+    }
+    tone_lat_stat.last_ms = ms;
+    if (ms > tone_lat_stat.max_ms) {
+        tone_lat_stat.max_ms = ms;
+    }
+    tone_lat_stat.total_ms += ms;
+    log_info("tone start latency:%dms%s", ms, dec->pcm_play ? " (cache)" : "");
+}
+
+int tone_latency_stat_get(struct tone_latency_stat *stat)
+{
+    memcpy(stat, &tone_lat_stat, sizeof(*stat));
+    return 0;
+}
+#endif
+
 void tone_event_to_user(u8 event, const char *name);
 void tone_event_clear()
 {
@@ -282,6 +445,16 @@ static char *get_file_ext_name(char *name)
 struct audio_dec_input tone_input;
 static void tone_file_dec_release()
 {
+#if TONE_PCM_CACHE_EN
+    // 停掉缓存输出, 并等audio_pwm_task里正在进行的写入结束后再释放file_dec
+    local_irq_disable();
+    file_dec->pcm_play = 0;
+    local_irq_enable();
+    while (file_dec->pcm_busy) {
+        os_time_dly(1);
+    }
+    tone_pcm_cache_capture_end(file_dec, 0);
+#endif
 #if (SYS_VOL_TYPE == VOL_TYPE_DIGITAL)
     if ((tone_input.coding_type == AUDIO_CODING_WAV) && (tone_dec->preemption == 0)) {
         audio_digital_vol_bg_fade(0);
@@ -394,6 +567,13 @@ static int tone_file_list_repeat(struct audio_decoder *decoder)
     }
 
     log_info("repeat idx:%d,%s", file_dec->idx, file_dec->list[file_dec->idx]);
+#if TONE_PCM_CACHE_EN
+    file_dec->cache = tone_pcm_cache_find(file_dec->list[file_dec->idx]);
+    if (file_dec->cache && file_dec->cache->valid) {
+        return 1;
+    }
+    file_dec->cache = NULL;
+#endif
     file_dec->file = fopen(file_dec->list[file_dec->idx], "r");
     if (!file_dec->file) {
         log_error("repeat end:fopen repeat file faild");
@@ -426,6 +606,9 @@ static void tone_dec_event_handler(struct audio_decoder *decoder, int argc, int
             log_error("file_dec magic no match:%d-%d", argv[1], file_dec->magic);
             break;
         }
+#if TONE_PCM_CACHE_EN
+        tone_pcm_cache_capture_end(file_dec, argv[0] == AUDIO_DEC_EVENT_END);
+#endif
         repeat = tone_file_list_repeat(decoder);
         log_info("AUDIO_DEC_EVENT_END,err=%x,repeat=%d\n", argv[0], repeat);
 
@@ -606,6 +789,9 @@ static int tone_final_output_handler(struct tone_file_handle *dec, s16 *data, in
 {
 #if 1
 
+#if TONE_PCM_CACHE_EN
+    tone_pcm_cache_capture(dec, data, len);
+#endif
 #if (SYS_VOL_TYPE == VOL_TYPE_DIGITAL)
     if (file_dec->dvol) {
         audio_digital_vol_run(file_dec->dvol, data, len);
@@ -615,6 +801,12 @@ static int tone_final_output_handler(struct tone_file_handle *dec, s16 *data, in
     if (wlen != len) {
         /* putchar('W'); */
     }
+#if TONE_PCM_CACHE_EN
+    if (wlen) {
+        tone_latency_mark(dec);
+    }
+    tone_pcm_cache_commit(dec, wlen);
+#endif
     return wlen;
 #else
     put_buf(data, len);
@@ -743,12 +935,122 @@ static void file_decoder_syncts_free(struct tone_file_handle *dec)
 
 void tone_play_resume_handler(void *priv)
 {
+#if TONE_PCM_CACHE_EN
+    if (tone_pcm_play_run()) {
+        return;
+    }
+#endif
     if (file_dec) {
         /* putchar('Z'); */
         audio_decoder_resume(&file_dec->decoder);
     }
 }
 
+#if TONE_PCM_CACHE_EN
+static int tone_pcm_play_end(int magic)
+{
+    if (!file_dec || file_dec->magic != (u32)magic) {
+        return 0;
+    }
+    if (tone_file_list_repeat(NULL)) {
+        tone_file_dec_start();
+    } else {
+        tone_file_list_stop(0);
+    }
+    return 0;
+}
+
+#if (SYS_VOL_TYPE == VOL_TYPE_DIGITAL)
+static s16 tone_pcm_vol_buf[128];   // 缓存是原始音量, 过数字音量用的中转buffer
+#endif
+
+static u32 tone_pcm_play_write(struct tone_file_handle *dec, s16 *pcm, u32 len)
+{
+#if (SYS_VOL_TYPE == VOL_TYPE_DIGITAL)
+    u32 wlen = 0;
+    u32 n, w;
+
+    if (dec->dvol) {
+        while (wlen < len) {
+            n = MIN(len - wlen, sizeof(tone_pcm_vol_buf));
+            memcpy(tone_pcm_vol_buf, (u8 *)pcm + wlen, n);
+            audio_digital_vol_run(dec->dvol, tone_pcm_vol_buf, n);
+            w = audio_pwm_write(tone_pcm_vol_buf, n);
+            wlen += w;
+            if (w < n) {
+                break;
+            }
+        }
+        return wlen;
+    }
+#endif
+    return audio_pwm_write(pcm, len);
+}
+
+/*
+ * audio_pwm缓冲低于门限时由audio_pwm_task回调, 往输出缓冲里填缓存的PCM
+ * file_dec在app_core里释放, 这里置pcm_busy后再使用, 释放时会等pcm_busy清零
+ * @return 1:处于缓存输出状态
+ */
+static int tone_pcm_play_run(void)
+{
+    struct tone_file_handle *dec;
+    struct tone_pcm_cache *cache;
+    u8 end = 0;
+    int argv[3];
+
+    local_irq_disable();
+    dec = file_dec;
+    if (!dec || !dec->pcm_play) {
+        local_irq_enable();
+        return 0;
+    }
+    dec->pcm_busy = 1;
+    local_irq_enable();
+
+    cache = dec->cache;
+    dec->cache_pos += tone_pcm_play_write(dec, (s16 *)((u8 *)cache->pcm + dec->cache_pos),
+                                          cache->len - dec->cache_pos);
+    if (dec->cache_pos >= cache->len) {
+        // 数据已经全部进了输出缓冲, 回到app_core做列表的下一项或者结束
+        dec->pcm_play = 0;
+        end = 1;
+        argv[0] = (int)tone_pcm_play_end;
+        argv[1] = 1;
+        argv[2] = (int)dec->magic;
+    }
+    dec->pcm_busy = 0;
+
+    if (end) {
+        os_taskq_post_h(tone_app_core_q, Q_CALLBACK, ARRAY_SIZE(argv), argv);
+    }
+    return 1;
+}
+
+// 缓存命中: 不打开解码器, 直接输出
+static int tone_pcm_play_start(void)
+{
+    file_dec->cache_pos = 0;
+    file_dec->pcm_play = 1;
+    file_dec->magic = rand32();
+    if (!tone_app_core_q) {
+        tone_app_core_q = os_taskq_get_handle("app_core");
+    }
+
+#if (SYS_VOL_TYPE == VOL_TYPE_DIGITAL)
+    if (!file_dec->dvol) {
+        file_dec->dvol = audio_digital_vol_open(SYS_DEFAULT_TONE_VOL, SYS_MAX_VOL, 20);
+    }
+#endif
+    audio_pwm_set_resume((void (*)(void *))tone_play_resume_handler);
+    set_state(2);
+
+    tone_latency_mark(file_dec);
+    tone_pcm_play_run();
+    return 0;
+}
+#endif
+
 
 
 
@@ -758,6 +1060,12 @@ int tone_file_dec_start()
     struct audio_fmt *fmt;
     u8 file_name[16];
 
+#if TONE_PCM_CACHE_EN
+    if (file_dec && file_dec->cache) {
+        return tone_pcm_play_start();
+    }
+#endif
+
     if (!file_dec || !file_dec->file) {
         return -EINVAL;
     }
@@ -837,6 +1145,9 @@ __dec_start:
     }
     file_dec->dvol = audio_digital_vol_open(SYS_DEFAULT_TONE_VOL, SYS_MAX_VOL, 20);
 #endif/*VOL_TYPE_DIGITAL*/
+#if TONE_PCM_CACHE_EN
+    tone_pcm_cache_capture_begin(file_dec);
+#endif
     err = audio_decoder_start(&file_dec->decoder);
     if (err) {
         goto __err2;
@@ -963,19 +1274,29 @@ int tone_list_play_start(const char **list, u8 preemption, u8 tws)
     char *format = NULL;
     FILE *file = NULL;
     int index = 0;
+    struct tone_pcm_cache *cache = NULL;
 
     if (IS_REPEAT_BEGIN(list[0])) {
         index = 1;
     }
 
-    printf(">>> %s %d\n", __func__, __LINE__);
-    file = fopen(list[index], "r");
-    if (!file) {
-        return -EINVAL;
+#if TONE_PCM_CACHE_EN
+    tone_req_ms = sys_timer_get_ms();
+    cache = tone_pcm_cache_find(list[index]);
+    if (cache && !cache->valid) {
+        cache = NULL;
     }
+#endif
     printf(">>> %s %d\n", __func__, __LINE__);
-    fget_name(file, file_name, 16);
-    format = get_file_ext_name((char *)file_name);
+    if (!cache) {
+        file = fopen(list[index], "r");
+        if (!file) {
+            return -EINVAL;
+        }
+        printf(">>> %s %d\n", __func__, __LINE__);
+        fget_name(file, file_name, 16);
+        format = get_file_ext_name((char *)file_name);
+    }
 
     file_dec = zalloc(sizeof(*file_dec));
 
@@ -983,6 +1304,9 @@ int tone_list_play_start(const char **list, u8 preemption, u8 tws)
     file_dec->idx  = index;
     file_dec->file = file;
     file_dec->tws = tws;
+#if TONE_PCM_CACHE_EN
+    file_dec->cache = cache;
+#endif
     if (index == 1) {
         file_dec->loop = TONE_REPEAT_COUNT(list[0]);
     }
@@ -997,7 +1321,7 @@ int tone_list_play_start(const char **list, u8 preemption, u8 tws)
     tone_dec->wait.preemption = preemption;
     printf(">>> %s %d\n", __func__, __LINE__);
     /*AAC提示音默认打断播放*/
-    if (ASCII_StrCmpNoCase(format, "aac", 3) == 0) {
+    if (format && ASCII_StrCmpNoCase(format, "aac", 3) == 0) {
         printf("aac tone,preemption = 1\n");
         tone_dec->wait.preemption = 1;
         tone_dec->wait.format = AUDIO_CODING_AAC;
@@ -0,0 +1,144 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+"""
+dlog 延迟二进制日志解码
+
+从 sdk.elf 的 .dlog_str 段取回格式串, 把串口抓到的 dlog 帧还原成文本,
+帧以外的字节(普通 printf 输出)原样透传.
+
+用法:
+    python dlog_decode.py sdk.elf uart_capture.bin
+    python dlog_decode.py sdk.elf -          # 从 stdin 读取
+
+帧格式见 include_lib/system/generic/dlog.h
+"""
+
+import re
+import struct
+import sys
+
+DLOG_SYNC = 0xA5
+DLOG_INFO_HEX = 0x80
+DLOG_MAX_ARGS = 6
+DLOG_HEXDUMP_MAX = 32
+HEAD_LEN = 12
+
+FMT_SPEC = re.compile(r'%([-+ #0]*)(\d*)(?:\.(\d+))?(hh|h|ll|l|z)?([diuxXcsp%])')
+
+
+def load_dlog_str(elf_path):
+    with open(elf_path, 'rb') as f:
+        elf = f.read()
+    if elf[:4] != b'\x7fELF' or elf[4] != 1:
+        raise SystemExit('%s: not an ELF32 file' % elf_path)
+    endian = '<' if elf[5] == 1 else '>'
+    shoff, = struct.unpack_from(endian + 'I', elf, 0x20)
+    shentsize, shnum, shstrndx = struct.unpack_from(endian + 'HHH', elf, 0x2e)
+
+    def section(i):
+        return struct.unpack_from(endian + 'IIIIIIIIII', elf, shoff + i * shentsize)
+
+    strtab = section(shstrndx)
+    for i in range(shnum):
+        sh = section(i)
+        name_off = strtab[4] + sh[0]
+        name = elf[name_off:elf.index(b'\0', name_off)]
+        if name == b'.dlog_str':
+            return sh[3], elf[sh[4]:sh[4] + sh[5]]
+    raise SystemExit('%s: no .dlog_str section' % elf_path)
+
+
+def format_args(fmt, args):
+    it = iter(args)
+    out = []
+    pos = 0
+    for m in FMT_SPEC.finditer(fmt):
+        out.append(fmt[pos:m.start()])
+        pos = m.end()
+        flags, width, prec, _, conv = m.groups()
+        if conv == '%':
+            out.append('%')
+            continue
+        v = next(it, None)
+        if v is None:
+            out.append('<?>')
+            continue
+        if conv in 'di':
+            v = v - (1 << 32) if v & 0x80000000 else v
+            py = 'd'
+        elif conv == 'c':
+            v = chr(v & 0xff)
+            py = 'c'
+        elif conv in 'sp':
+            v = '0x%08x' % v        # 只保存了指针
+            py = 's'
+        else:
+            py = conv
+        spec = '%' + flags + width + ('.' + prec if prec else '') + py
+        out.append(spec % v)
+    out.append(fmt[pos:])
+    return ''.join(out)
+
+
+def decode(data, base, strs, out):
+    last_seq = None
+    text = bytearray()      # 帧以外的字节, 攒起来按 utf-8 整段解码(中文日志)
+
+    def flush_text():
+        if text:
+            out.write(text.decode('utf-8', 'replace'))
+            del text[:]
+
+    i = 0
+    n = len(data)
+    while i < n:
+        b = data[i]
+        if b != DLOG_SYNC or i + HEAD_LEN > n:
+            text.append(b)
+            i += 1
+            continue
+        _, info, length, seq, ts, fid = struct.unpack_from('<BBBBII', data, i)
+        hexdump = info & DLOG_INFO_HEX
+        valid = (hexdump and 2 <= length <= 2 + DLOG_HEXDUMP_MAX) or \
+                (not hexdump and length % 4 == 0 and length <= DLOG_MAX_ARGS * 4 and
+                 0 <= fid - base < len(strs))
+        if not valid or i + HEAD_LEN + length > n:
+            text.append(b)
+            i += 1
+            continue
+        flush_text()
+        payload = data[i + HEAD_LEN:i + HEAD_LEN + length]
+        i += HEAD_LEN + length
+
+        if last_seq is not None and seq != (last_seq + 1) & 0xff:
+            out.write('[dlog] lost %d frame(s)\n' % ((seq - last_seq - 1) & 0xff))
+        last_seq = seq
+
+        if hexdump:
+            total = payload[0] | payload[1] << 8
+            line = ' '.join('%02X' % x for x in payload[2:])
+            if total > length - 2:
+                line += ' ...(%d bytes)' % total
+        else:
+            off = fid - base
+            fmt = strs[off:strs.index(b'\0', off)].decode('utf-8', 'replace')
+            args = struct.unpack_from('<%dI' % (length // 4), payload)
+            line = format_args(fmt, args).rstrip('\r\n')
+        out.write('[%08d]%s\n' % (ts, line))
+    flush_text()
+
+
+def main():
+    if len(sys.argv) != 3:
+        raise SystemExit(__doc__)
+    base, strs = load_dlog_str(sys.argv[1])
+    if sys.argv[2] == '-':
+        data = sys.stdin.buffer.read()
+    else:
+        with open(sys.argv[2], 'rb') as f:
+            data = f.read()
+    decode(data, base, strs, sys.stdout)
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,101 @@
+#ifndef _IIC_QUEUE_H_
+#define _IIC_QUEUE_H_
+
+#include "generic/typedef.h"
+
+/*
+ * iic传输队列
+ *
+ * 每个从设备打开一个client, 传输(先写后读, 中间repeated start)挂到client自己的队列上,
+ * 由iic_queue任务按client轮流执行, 完成后在iic_queue任务中回调.
+ * 提交接口可在中断里调用, 同步接口只能在任务中调用.
+ * 同一条iic总线上的设备都应通过队列访问, 总线互斥由队列保证, 不再需要关中断/spin_lock.
+ */
+
+enum {
+    IIC_QUEUE_BUS_SOFT = 0,     //iic_soft.c
+    IIC_QUEUE_BUS_HW,           //硬件iic(IIC_QUEUE_HW_BUS_ENABLE, 需要硬件iic驱动, 默认不支持)
+    IIC_QUEUE_BUS_MOCK,         //模拟总线, 不接硬件调试上层(IIC_QUEUE_MOCK_BUS_ENABLE)
+};
+
+struct iic_client;
+typedef struct iic_client *iic_client_t;
+
+struct iic_xfer;
+typedef void (*iic_xfer_cb_t)(struct iic_xfer *xfer, int result);
+
+/*
+ * 由调用者提供, 回调之前不能释放或修改
+ * result: >=0 读到的字节数(只写时为写入的字节数)
+ *         -ENXIO 地址无应答, -EIO 数据无应答, -EINTR client关闭时被取消
+ */
+struct iic_xfer {
+    struct iic_xfer *next;
+    const u8 *wbuf;
+    u8 *rbuf;
+    u16 wlen;
+    u16 rlen;
+    iic_xfer_cb_t cb;
+    void *priv;
+    u32 submit_hms;     //提交时刻, jiffies_half_msec()
+    u8 pending;
+};
+
+static inline void iic_xfer_init(struct iic_xfer *x, const u8 *wbuf, u16 wlen,
+                                 u8 *rbuf, u16 rlen, iic_xfer_cb_t cb, void *priv)
+{
+    x->next = NULL;
+    x->wbuf = wbuf;
+    x->wlen = wlen;
+    x->rbuf = rbuf;
+    x->rlen = rlen;
+    x->cb = cb;
+    x->priv = priv;
+    x->pending = 0;
+}
+
+/*
+ * @brief 打开一个从设备
+ * @parm name  名字, 只用于统计输出
+ * @parm bus  IIC_QUEUE_BUS_SOFT/IIC_QUEUE_BUS_HW/IIC_QUEUE_BUS_MOCK
+ * @parm iic  iic句柄(soft_iic_cfg/hw_iic_cfg下标), 需已init
+ * @parm addr  7bit从机地址
+ * @parm byte_delay  写字节之间的延时(delay()参数), 部分器件需要
+ * @return client句柄, NULL 失败
+ */
+iic_client_t iic_client_open(const char *name, u8 bus, u8 iic, u8 addr, u8 byte_delay);
+/*
+ * @brief 关闭从设备, 未执行的传输以-EINTR回调
+ */
+void iic_client_close(iic_client_t c);
+/*
+ * @brief 异步提交传输, 可在中断中调用
+ * @return 0 成功，< 0 失败(x已在队列中返回-EBUSY)
+ */
+int iic_xfer_submit(iic_client_t c, struct iic_xfer *x);
+/*
+ * @brief 同步传输, 阻塞到完成, 只能在任务中调用
+ * @return 同iic_xfer.result
+ */
+int iic_xfer_sync(iic_client_t c, struct iic_xfer *x);
+/*
+ * @brief 同步连续读寄存器: 写reg, repeated start, 读len字节
+ * @return 读到的字节数，< 0 失败
+ */
+int iic_reg_read(iic_client_t c, u8 reg, u8 *buf, u16 len);
+/*
+ * @brief 同步写1个寄存器
+ * @return 0 成功，< 0 失败
+ */
+int iic_reg_write(iic_client_t c, u8 reg, u8 val);
+
+void iic_queue_stat_dump(void);
+
+/*
+ * @brief 模拟总线挂一个从设备, 寄存器地址自增读写regs, 不依赖硬件
+ * @parm addr  7bit从机地址
+ * @parm byte_delay  每字节模拟的总线耗时(delay()参数)
+ */
+void iic_queue_mock_attach(u8 addr, u8 *regs, u16 size, u16 byte_delay);
+
+#endif
@@ -19,6 +19,19 @@ struct msd_info {
     void (*msd_reset_wakeup_handle)(struct usb_device_t *usb_device, u32 itf_num);
 };
 
+struct msd_stat {
+    u32 rd_cmds;
+    u32 rd_bytes;
+    u32 rd_ms;          //READ_10 累计耗时
+    u32 rd_lat_max;     //单条READ_10 最大耗时(ms)
+    u32 wr_cmds;
+    u32 wr_bytes;
+    u32 wr_ms;
+    u32 wr_lat_max;
+    u32 ra_hit;         //预取命中次数
+    u32 ra_miss;        //预取作废次数
+};
+
 
 
 u32 msd_desc_config(const usb_dev usb_id, u8 *ptr, u32 *cur_itf_num);
@@ -31,4 +44,6 @@ u32 msd_register(const usb_dev id);
 u32 msd_release();
 void msd_set_reset_wakeup_handle(void (*handle)(struct usb_device_t *usb_device, u32 itf_num));
 void msd_reset(struct usb_device_t *usb_device, u32 itf_num);
+void msd_stat_get(struct msd_stat *stat, u8 reset);
+void msd_stat_dump(void);
 #endif  /*USBD_MSD_H*/
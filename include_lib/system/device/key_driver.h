@@ -28,6 +28,15 @@ typedef enum __KEY_DRIVER_TYPE {
 
 #define KEY_NOT_SUPPORT  0x01
 
+#define KEY_SCAN_IDLE_STOP  0xffff      //idle_scan_time: 没有按键时停止扫描, 只靠边沿唤醒(key_active_set)
+
+struct key_driver_stat {
+    u32 scan;               //扫描次数
+    u32 wakeup;             //边沿唤醒次数
+    u32 notify;             //发出的按键事件数
+    u32 last_latency;       //最近一次 按下->sys_event_notify 的时间, 单位ms
+    u32 max_latency;
+};
 
 struct key_driver_para {
     const u32 scan_time;	//按键扫描频率, 单位ms
@@ -47,6 +56,13 @@ struct key_driver_para {
     u8 notify_value;  		//在延时的待发送按键值
     u8 key_type;
     u8(*get_value)(void);
+//== 调度参数, 以下由key_driver维护
+    const u16 idle_scan_time;   //没有按键时的扫描周期(ms), 0:与scan_time相同, KEY_SCAN_IDLE_STOP:停止扫描
+    u16 timer;                  //扫描定时器
+    u8 active;                  //有按键按下/消抖中/等待连击, 此时按scan_time扫描并阻止进入低功耗
+    volatile u8 wake_pending;   //边沿唤醒置位, 由扫描定时器(或停止扫描时由app_core)切回scan_time
+    u32 press_ms;               //本次按下的时间, 用于统计延迟
+    struct key_driver_stat stat;
 };
 
 //组合按键映射按键值
@@ -63,6 +79,17 @@ struct key_remap_data {
 // key_driver API:
 extern int key_driver_init(void);
 
+/*
+ * 注册一个按键源: 由key_driver按该源的scan_time/idle_scan_time调度get_value采样,
+ * 采样结果进入统一的消抖/单击/多击/长按/HOLD状态机
+ */
+extern int key_driver_register(struct key_driver_para *scan_para);
+
+//按键边沿唤醒回调, 所有空闲的按键源立即按scan_time开始扫描
+extern void key_active_set(u8 port);
+
+extern void key_driver_stat_dump(void);
+
 
 
 #endif
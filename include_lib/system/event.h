@@ -100,6 +100,8 @@
 #define SYS_BT_EVENT_FORM_AT          (('I' << 24) | ('A' << 16) | ('T' << 8) | '\0')
 #define DEVICE_EVENT_FROM_ADAPTER      (('A' << 24) | ('D' << 16) | ('A' << 8) | '\0')
 #define DEVICE_EVENT_FROM_BOARD_UART   (('B' << 24) | ('D' << 16) | ('U' << 8) | '\0')
+#define DEVICE_EVENT_FROM_EVENT_QUEUE  (('E' << 24) | ('V' << 16) | ('Q' << 8) | '\0')
+#define DEVICE_EVENT_FROM_GSENSOR      (('G' << 24) | ('S' << 16) | ('R' << 8) | '\0')
 
 enum {
     KEY_EVENT_CLICK,
@@ -369,6 +371,47 @@ void sys_event_notify(struct sys_event *e);
 
 void sys_event_clear(struct sys_event *e);
 
+
+/*
+ * 按事件类型分表分发
+ *
+ * 每种事件类型(SYS_xxx_EVENT的bit位)一张处理函数表, 按priority从高到低排列,
+ * 分发时直接按类型取表, 不再遍历全部处理函数比较event_type;
+ * from为0时接收该类型的所有事件, 否则只接收 (u32)e->arg == from 的事件;
+ * 处理函数中调用sys_event_consume()后不再分发给同一张表后面的处理函数.
+ * 处理函数在app_core线程中执行.
+ */
+int sys_event_table_register(int event_type, int from, u8 priority,
+                             void (*handler)(struct sys_event *));
+
+void sys_event_table_unregister(void (*handler)(struct sys_event *));
+
+void sys_event_table_dispatch(struct sys_event *e);
+
+/*
+ * 有界事件队列, 用于鼠标位移、gsensor等高频事件源
+ *
+ * key非0且队列中已有同一key的未处理事件时, 调用merge把新事件合并进去,
+ * 不再占用新的位置; key为0时不合并.
+ * 队列满时丢弃新事件并计数, 返回-1.
+ * 可在中断中调用, 事件在app_core线程中按入队顺序交给分表处理函数,
+ * 对应类型没有注册分表处理函数时转给sys_event_notify(): 这样要在app_core
+ * 队列里再走一次, 且转发出去的事件不再合并. 高频事件源的接收方应该用
+ * sys_event_table_register()注册, 才能省掉这一次转发.
+ */
+typedef void (*sys_event_merge_t)(struct sys_event *dst, const struct sys_event *src);
+
+int sys_event_post_merge(struct sys_event *e, u32 key, sys_event_merge_t merge);
+
+#define sys_event_post(e) \
+    sys_event_post_merge(e, 0, NULL)
+
+/*位移类事件合并: x/y累加*/
+void sys_event_axis_merge(struct sys_event *dst, const struct sys_event *src);
+
+/*输出各类型分发次数, 队列入队/合并/丢弃次数和入队到分发的延时*/
+void sys_event_dispatch_stat_dump(void);
+
 void sys_key_event_disable();
 
 
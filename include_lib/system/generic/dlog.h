@@ -0,0 +1,115 @@
+#ifndef __DLOG_H
+#define __DLOG_H
+
+#include "typedef.h"
+#include "system/generic/log.h"
+
+/*
+ * 延迟二进制日志(deferred log)
+ *
+ * 热路径上log_print/printf_buf要在调用者上下文里格式化并阻塞等待串口发送,
+ * dlog只把 格式串ID + 整型参数 打包成一帧写入ring buffer(关中断时间只有一次拷贝),
+ * 由低优先级的dlog任务在空闲时把帧原样从串口输出, 主机端再还原成文本.
+ *
+ * - 格式串放在不下载的.dlog_str段(INFO, 起始地址0), 字符串在段内的偏移即ID,
+ *   固件里不占flash, 主机用cpu/bd19/tools/dlog_decode.py从sdk.elf取回格式串
+ * - 参数按u32保存, 最多DLOG_MAX_ARGS个; 不支持%s(保存的只是指针)和64bit参数
+ * - ring满时整帧丢弃并计数, 主机通过帧序号发现丢帧
+ * - CONFIG_DLOG_ENABLE为0时退化为普通log_print, 调用处不需要改动
+ *
+ * 串口帧格式(小端):
+ *   sync(0xA5) | info | len | seq | ts(u32, ms) | id(u32) | payload[len]
+ *   info: bit[2:0]日志等级, bit7置位表示payload为hexdump数据(前2字节为原始长度)
+ */
+
+#define DLOG_SYNC               0xA5
+#define DLOG_INFO_HEX           0x80
+#define DLOG_MAX_ARGS           6
+#define DLOG_HEXDUMP_MAX        32      //hexdump最多保存的字节数, 超出部分截断
+#define DLOG_BUF_SIZE           2048    //必须为2的幂
+
+struct dlog_frame_head {
+    u8 sync;
+    u8 info;
+    u8 len;
+    u8 seq;
+    u32 ts;
+    u32 id;
+};
+
+struct dlog_stat {
+    u32 frames;     /*写入ring的帧数*/
+    u32 lost;       /*ring满丢弃的帧数*/
+    u32 max_used;   /*ring最大使用量(字节)*/
+};
+
+#define __DLOG_NARG(_0, _1, _2, _3, _4, _5, _6, N, ...)    N
+#define DLOG_NARG(...)      __DLOG_NARG(_0, ## __VA_ARGS__, 6, 5, 4, 3, 2, 1, 0)
+
+/*格式串放入.dlog_str段, 返回段内地址作为ID*/
+#define DLOG_ID(format) \
+    ({ \
+        static const char __dlog_fmt[] __attribute__((section(".dlog_str"), used)) = format; \
+        (u32)__dlog_fmt; \
+    })
+
+#if CONFIG_DLOG_ENABLE
+
+#define dlog_print(level, format, ...) \
+    dlog_write(level, DLOG_ID(format), DLOG_NARG(__VA_ARGS__), ## __VA_ARGS__)
+
+#define dlog_hexdump(level, buf, len) \
+    dlog_write_hex(level, buf, len)
+
+#else
+
+#define dlog_print(level, format, ...) \
+    log_print(level, NULL, format "\r\n", ## __VA_ARGS__)
+
+#define dlog_hexdump(level, buf, len) \
+    printf_buf((u8 *)(buf), len)
+
+#endif /* #if CONFIG_DLOG_ENABLE */
+
+/*
+ * 与debug.h中log_xxx对应的延迟版本, 同样受LOG_TAG_CONST开关控制
+ */
+#define log_info_defer(format, ...)       \
+    if (LOG_IS_ENABLE(LOG_INFO)) \
+        dlog_print(__LOG_INFO, "[Info]: " _LOG_TAG format, ## __VA_ARGS__)
+
+#define log_info_hexdump_defer(x, y)     \
+    if (LOG_IS_ENABLE(LOG_INFO)) \
+        dlog_hexdump(__LOG_INFO, x, y)
+
+#define log_debug_defer(format, ...)       \
+    if (LOG_IS_ENABLE(LOG_DEBUG)) \
+        dlog_print(__LOG_DEBUG, "[Debug]: " _LOG_TAG format, ## __VA_ARGS__)
+
+#define log_error_defer(format, ...)       \
+    if (LOG_IS_ENABLE(LOG_ERROR)) \
+        dlog_print(__LOG_ERROR, "<Error>: " _LOG_TAG format, ## __VA_ARGS__)
+
+/* --------------------------------------------------------------------------*/
+/**
+ * @brief 写入一帧日志, 可在中断里调用, 不会阻塞
+ *
+ * @param [in] level 日志等级
+ * @param [in] id 格式串ID, 由DLOG_ID()生成
+ * @param [in] argc 后续参数个数, 超过DLOG_MAX_ARGS的部分丢弃
+ */
+/* ----------------------------------------------------------------------------*/
+void dlog_write(int level, u32 id, int argc, ...);
+
+void dlog_write_hex(int level, const void *buf, int len);
+
+/* --------------------------------------------------------------------------*/
+/**
+ * @brief 把ring中的帧全部输出, 用于死机/复位前保证日志不丢
+ */
+/* ----------------------------------------------------------------------------*/
+void dlog_flush(void);
+
+void dlog_stat_get(struct dlog_stat *stat);
+
+#endif
@@ -18,6 +18,7 @@
 #include "lbuf.h"
 #include "lbuf_lite.h"
 #include "circular_buf.h"
+#include "spsc_buf.h"
 #include "index.h"
 #include "debug_lite.h"
 
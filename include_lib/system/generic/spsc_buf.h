@@ -0,0 +1,242 @@
+#ifndef SPSC_BUF_INTERFACE_H
+#define SPSC_BUF_INTERFACE_H
+
+#include "typedef.h"
+
+/*
+ * 单生产者/单消费者无锁环形buffer
+ *
+ * 适用于中断(生产者) -> 任务(消费者)或者相反方向的数据传递:
+ * 写指针只由生产者修改, 读指针只由消费者修改, 两端都不需要关中断.
+ * 读写指针为自由增长的u32计数, 通过2的幂掩码取下标, 数据长度 = wr - rd.
+ * 接口命名与circular_buf.h保持一致, 便于替换cbuf.
+ */
+
+#define SPSC_BARRIER()      __asm__ volatile("" ::: "memory")
+
+/*
+ * 编译期检查缓存大小为2的幂, 在文件作用域使用:
+ * SPSC_BUF_SIZE_CHECK(xxx_buf, XXX_BUF_SIZE);
+ */
+#define SPSC_BUF_SIZE_CHECK(name, size) \
+    typedef char name##_spsc_size_not_pow2[((size) && !((size) & ((size) - 1))) ? 1 : -1]
+
+/* --------------------------------------------------------------------------*/
+/**
+ * @brief spsc_buf结构体
+ */
+/* ----------------------------------------------------------------------------*/
+typedef struct _spsc_buf {
+    u8 *begin;
+    u32 mask;
+    volatile u32 wr;    ///< 只由生产者修改
+    volatile u32 rd;    ///< 只由消费者修改
+    u32 wm_level;       ///< 水位回调门限,0表示不回调
+    void (*wm_cb)(void *priv);
+    void *wm_priv;
+} spsc_buf_t;
+
+/* --------------------------------------------------------------------------*/
+/**
+ * @brief spsc_buf初始化
+ *
+ * @param [in] sbuf spsc_buf句柄
+ * @param [in] buf 缓存空间
+ * @param [in] size 缓存总大小, 必须为2的幂, 常量大小用SPSC_BUF_SIZE_CHECK()在编译期检查
+ *
+ * @return 0:成功 -1:size不是2的幂
+ */
+/* ----------------------------------------------------------------------------*/
+static inline int spsc_buf_init(spsc_buf_t *sbuf, void *buf, u32 size)
+{
+    if (size == 0 || (size & (size - 1))) {
+        return -1;
+    }
+    sbuf->begin = buf;
+    sbuf->mask = size - 1;
+    sbuf->wr = 0;
+    sbuf->rd = 0;
+    sbuf->wm_level = 0;
+    sbuf->wm_cb = NULL;
+    sbuf->wm_priv = NULL;
+    return 0;
+}
+
+/* --------------------------------------------------------------------------*/
+/**
+ * @brief 设置水位回调: 生产者写入使数据量从低于level变为不低于level时调用一次cb
+ *        (边沿触发), 替代每写一包就post一次信号量
+ *
+ * @note  需在生产者启动之前设置
+ */
+/* ----------------------------------------------------------------------------*/
+static inline void spsc_buf_set_watermark(spsc_buf_t *sbuf, u32 level, void (*cb)(void *priv), void *priv)
+{
+    sbuf->wm_cb = cb;
+    sbuf->wm_priv = priv;
+    sbuf->wm_level = level;
+}
+
+static inline u32 spsc_buf_get_data_len(spsc_buf_t *sbuf)
+{
+    return sbuf->wr - sbuf->rd;
+}
+
+static inline u32 spsc_buf_get_free_len(spsc_buf_t *sbuf)
+{
+    return sbuf->mask + 1 - (sbuf->wr - sbuf->rd);
+}
+
+/* --------------------------------------------------------------------------*/
+/**
+ * @brief 生产者: 获取可直接写入的连续空间(不跨越buffer尾部),
+ *        写完后调用spsc_buf_write_updata()提交
+ *
+ * @param [out] len 可写的连续字节数
+ *
+ * @return 写指针地址
+ */
+/* ----------------------------------------------------------------------------*/
+static inline void *spsc_buf_write_alloc(spsc_buf_t *sbuf, u32 *len)
+{
+    u32 wr = sbuf->wr;
+    u32 free = spsc_buf_get_free_len(sbuf);
+    u32 tail = sbuf->mask + 1 - (wr & sbuf->mask);
+
+    *len = free < tail ? free : tail;
+    return sbuf->begin + (wr & sbuf->mask);
+}
+
+static inline void spsc_buf_write_updata(spsc_buf_t *sbuf, u32 len)
+{
+    u32 before = sbuf->wr - sbuf->rd;
+
+    SPSC_BARRIER();     //数据写完之后才更新写指针
+    sbuf->wr += len;
+
+    if (sbuf->wm_level && before < sbuf->wm_level &&
+        before + len >= sbuf->wm_level) {
+        sbuf->wm_cb(sbuf->wm_priv);
+    }
+}
+
+/* --------------------------------------------------------------------------*/
+/**
+ * @brief 消费者: 获取可直接读取的连续数据(不跨越buffer尾部),
+ *        读完后调用spsc_buf_read_updata()释放
+ *
+ * @param [out] len 可读的连续字节数
+ *
+ * @return 读指针地址
+ */
+/* ----------------------------------------------------------------------------*/
+static inline void *spsc_buf_read_alloc(spsc_buf_t *sbuf, u32 *len)
+{
+    u32 rd = sbuf->rd;
+    u32 data = sbuf->wr - rd;
+    u32 tail = sbuf->mask + 1 - (rd & sbuf->mask);
+
+    SPSC_BARRIER();     //先取写指针再读数据
+    *len = data < tail ? data : tail;
+    return sbuf->begin + (rd & sbuf->mask);
+}
+
+static inline void spsc_buf_read_updata(spsc_buf_t *sbuf, u32 len)
+{
+    SPSC_BARRIER();     //数据读完之后才释放空间
+    sbuf->rd += len;
+}
+
+/* --------------------------------------------------------------------------*/
+/**
+ * @brief 生产者: 拷贝写入, 空间不足时只写入能放下的部分
+ *
+ * @return 成功写入的字节数
+ */
+/* ----------------------------------------------------------------------------*/
+static inline u32 spsc_buf_write(spsc_buf_t *sbuf, const void *buf, u32 len)
+{
+    u32 wr = sbuf->wr;
+    u32 free = spsc_buf_get_free_len(sbuf);
+    u32 off = wr & sbuf->mask;
+    u32 first;
+
+    if (len > free) {
+        len = free;
+    }
+    first = sbuf->mask + 1 - off;
+    if (first > len) {
+        first = len;
+    }
+    memcpy(sbuf->begin + off, buf, first);
+    memcpy(sbuf->begin, (const u8 *)buf + first, len - first);
+    spsc_buf_write_updata(sbuf, len);
+
+    return len;
+}
+
+/* --------------------------------------------------------------------------*/
+/**
+ * @brief 消费者: 拷贝读取, 数据不足时只读取已有部分
+ *
+ * @return 成功读取的字节数
+ */
+/* ----------------------------------------------------------------------------*/
+static inline u32 spsc_buf_read(spsc_buf_t *sbuf, void *buf, u32 len)
+{
+    u32 rd = sbuf->rd;
+    u32 data = sbuf->wr - rd;
+    u32 off = rd & sbuf->mask;
+    u32 first;
+
+    SPSC_BARRIER();
+    if (len > data) {
+        len = data;
+    }
+    first = sbuf->mask + 1 - off;
+    if (first > len) {
+        first = len;
+    }
+    memcpy(buf, sbuf->begin + off, first);
+    memcpy((u8 *)buf + first, sbuf->begin, len - first);
+    spsc_buf_read_updata(sbuf, len);
+
+    return len;
+}
+
+/* --------------------------------------------------------------------------*/
+/**
+ * @brief 消费者: 读指针回退, 重新读取已读过的数据
+ *
+ * @param [in] len 要回退的字节数
+ * @param [in] reserve 给生产者保留的空闲字节数(至少为生产者单次写入长度),
+ *                     防止回退到生产者正在写的区域
+ *
+ * @return 实际回退的字节数
+ */
+/* ----------------------------------------------------------------------------*/
+static inline u32 spsc_buf_read_goback(spsc_buf_t *sbuf, u32 len, u32 reserve)
+{
+    u32 free = spsc_buf_get_free_len(sbuf);
+
+    if (free <= reserve) {
+        return 0;
+    }
+    if (len > free - reserve) {
+        len = free - reserve;
+    }
+    sbuf->rd -= len;
+    return len;
+}
+
+/* --------------------------------------------------------------------------*/
+/**
+ * @brief 消费者: 丢弃全部数据
+ */
+/* ----------------------------------------------------------------------------*/
+static inline void spsc_buf_clear(spsc_buf_t *sbuf)
+{
+    sbuf->rd = sbuf->wr;
+}
+
+#endif
@@ -1,6 +1,8 @@
 #ifndef _MEM_HEAP_H_
 #define _MEM_HEAP_H_
 
+#include "typedef.h"
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -27,6 +29,83 @@ void memory_init(void);
 void mem_stats(void);
 
 
+/*
+ *  Slab: 固定大小内存块池
+ *
+ *  1、块在池内用单链表管理, 申请/释放都是O(1), 关中断保护, 可在中断里调用；
+ *  2、MEM_SLAB_DEFINE定义的专用池放在.mem_slab段, mem_slab_stats可以统一列出；
+ *  3、slab_malloc按大小选择app_config.h中配置的尺寸档(MEM_SLAB_xxx_NUM),
+ *     该档用完时依次借用更大的档, 都没有或超过最大档时退回malloc,
+ *     所以slab_malloc的内存必须用slab_free释放。
+ */
+struct mem_slab {
+    const char *name;
+    u16 blk_size;       /*块大小, 4字节对齐*/
+    u16 blk_num;
+    u8 *buf;
+    void *free_list;
+    u16 uninit;         /*buf中从未分配过的第一个块, 省去初始化时串链表*/
+    u16 used;
+    u16 max_used;       /*使用量高水位*/
+    u32 alloc;          /*成功申请次数*/
+    u32 fail;           /*池满申请失败次数*/
+};
+
+#define MEM_SLAB_BLK_SIZE(size)     (((size) + 3) & ~3)
+
+/*
+ * 用调用者已有的数组作为池的存储, 不再另外占RAM;
+ * _buf为NULL/_blk_num为0时池为空, 申请直接失败, 可在运行时再填buf和blk_num
+ */
+#define MEM_SLAB_DEFINE_BUF(_name, _buf, _blk_size, _blk_num) \
+    struct mem_slab _name sec(.mem_slab) = { \
+        .name = #_name, \
+        .blk_size = MEM_SLAB_BLK_SIZE(_blk_size), \
+        .blk_num = _blk_num, \
+        .buf = (u8 *)(_buf), \
+    }
+
+#define MEM_SLAB_DEFINE(_name, _blk_size, _blk_num) \
+    static u32 _name##_buf[MEM_SLAB_BLK_SIZE(_blk_size) / 4 * (_blk_num)]; \
+    MEM_SLAB_DEFINE_BUF(_name, _name##_buf, _blk_size, _blk_num)
+
+extern struct mem_slab mem_slab_begin[];
+extern struct mem_slab mem_slab_end[];
+
+#define list_for_each_mem_slab(p) \
+    for (p = mem_slab_begin; p < mem_slab_end; p++)
+
+static inline int mem_slab_contain(struct mem_slab *slab, void *p)
+{
+    return (u8 *)p >= slab->buf &&
+           (u8 *)p < slab->buf + slab->blk_size * slab->blk_num;
+}
+
+void *mem_slab_alloc(struct mem_slab *slab);
+
+void mem_slab_free(struct mem_slab *slab, void *p);
+
+/*
+ * 只从尺寸档里申请, 申请不到返回NULL, 由调用者退回到自己的堆;
+ * slab_try_free返回0表示p不属于任何尺寸档
+ */
+void *slab_try_alloc(size_t size);
+
+int slab_try_free(void *p);
+
+void *slab_malloc(size_t size);
+
+void *slab_zalloc(size_t size);
+
+void slab_free(void *p);
+
+/**
+ * @brief 输出每个slab池的块大小/块数/当前使用/高水位/申请次数/失败次数,
+ *        以及退回堆的次数, 配合mem_stats()查看堆的使用
+ */
+void mem_slab_stats(void);
+
+
 #ifdef __cplusplus
 }
 #endif
@@ -233,6 +233,65 @@ int os_taskq_post_event(const char *name, int argc, ...);
 /* ----------------------------------------------------------------------------*/
 int os_taskq_del_type(const char *name, int type);
 
+
+/*
+ * 句柄方式taskq
+ *
+ * os_taskq_post_xxx(name, ...)每次发送都要按任务名查找任务(xTaskGetHandle逐个比较字符串),
+ * 高频发送的地方先用os_taskq_get_handle()解析一次, 之后按句柄发送.
+ * 消息格式与按名字发送的完全相同, 接收方仍用os_taskq_pend()/os_taskq_accept().
+ * 句柄在目标任务删除之前有效.
+ */
+typedef struct os_taskq_hdl *os_taskq_t;
+
+struct os_taskq_msg {
+    int type;       /*Q_MSG/Q_EVENT/Q_CALLBACK/Q_USER*/
+    int argc;
+    int *argv;
+};
+
+/* --------------------------------------------------------------------------*/
+/**
+ * @brief 按任务名获取taskq句柄, 同名任务重复获取返回同一个句柄
+ *
+ * @param name 任务名
+ *
+ * @return 句柄, NULL:任务不存在或者句柄已用完
+ */
+/* ----------------------------------------------------------------------------*/
+os_taskq_t os_taskq_get_handle(const char *name);
+
+/* --------------------------------------------------------------------------*/
+/**
+ * @brief 按句柄发送指定类型的taskq, 可在中断里调用
+ *
+ * @return 错误码, 与os_taskq_post_type()相同
+ */
+/* ----------------------------------------------------------------------------*/
+int os_taskq_post_h(os_taskq_t h, int type, int argc, int *argv);
+
+int os_taskq_post_msg_h(os_taskq_t h, int argc, ...);
+
+/* --------------------------------------------------------------------------*/
+/**
+ * @brief 一次关中断内发送多条消息, 只做一次空间检查和一次任务切换;
+ *        空间不足时一条都不发送
+ *
+ * @param msg 消息数组
+ * @param num 消息条数
+ *
+ * @return 错误码
+ */
+/* ----------------------------------------------------------------------------*/
+int os_taskq_post_batch_h(os_taskq_t h, const struct os_taskq_msg *msg, int num);
+
+/* --------------------------------------------------------------------------*/
+/**
+ * @brief 打印所有句柄的发送次数/满丢次数/最大深度/最大发送耗时
+ */
+/* ----------------------------------------------------------------------------*/
+void os_taskq_stat_dump(void);
+
 /* --------------------------------------------------------------------------*/
 /**
  * @brief 清除所有taskq
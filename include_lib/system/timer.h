@@ -260,6 +260,52 @@ void usr_timer_dump(void);
 
 /*-----------------------------------------------------------*/
 
+/*
+ *  Slack Timer
+ */
+
+/**
+ * @brief 添加允许延后的ms级定时任务(时间轮实现, 所有任务共用一个sys_timeout)
+ *
+ * @param [in] priv 定时任务处理函数的输入参数
+ * @param [in] func 定时任务处理函数
+ * @param [in] msec 定时时间
+ * @param [in] slack 允许延后的时间，单位：毫秒
+ *
+ * @return 定时器分配的ID, 0:失败
+ *
+ * @note
+ * 1、到期时刻落在[msec, msec + slack]内并对齐到粗边界，不同模块的定时任务
+ *    尽量在同一时刻到期，一次唤醒处理多个，适合电量检测、LED、状态同步等对时间不敏感的任务；
+ * 2、周期任务按添加时刻累加周期，单次间隔在msec ± slack之间变化，平均周期不变；
+ * 3、回调在app_core线程中执行，可在回调中删除/修改任意slack定时器；
+ * 4、slack为0时与sys_timer精度相同(10ms)；
+ * 5、与sys_slack_timer_del成对使用，timeout类型回调执行后ID自动释放。
+ */
+#define sys_slack_timer_add(priv, func, msec, slack) \
+    __sys_slack_timer_add(priv, func, msec, slack, 1, #func)
+
+#define sys_slack_timeout_add(priv, func, msec, slack) \
+    __sys_slack_timer_add(priv, func, msec, slack, 0, #func)
+
+u16 __sys_slack_timer_add(void *priv, void (*func)(void *priv), u32 msec, u32 slack,
+                          u8 periodic, const char *owner);
+
+void sys_slack_timer_del(u16 id);
+
+/**
+ * @brief 修改slack定时任务的定时时间，从当前时刻重新计时
+ */
+int sys_slack_timer_modify(u16 id, u32 msec);
+
+/**
+ * @brief 输出每个slack定时任务的周期/slack/执行次数/每秒执行次数，
+ *        以及实际唤醒次数，用于评估合并效果
+ */
+void sys_slack_timer_dump(void);
+
+/*-----------------------------------------------------------*/
+
 /*
  *  For Compatible
  */
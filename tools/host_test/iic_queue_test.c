@@ -0,0 +1,212 @@
+/*
+ * cpu/bd19/iic_queue.c 主机测试, 总线用模块自带的模拟总线(IIC_QUEUE_BUS_MOCK)
+ *
+ * 直接包含iic_queue.c, 以便检查内部状态. 覆盖:
+ *   - 同步读写经模拟总线落到寄存器, 地址无应答返回-ENXIO;
+ *   - 多个client同时排队时轮流执行, 一个client连续提交不会饿死其他client;
+ *   - 回调结果和pending标志;
+ *   - 关闭client时未执行的传输以-EINTR回调, 正在执行的传输正常完成后再释放;
+ *   - 统计计数;
+ *   - 不支持的总线类型打开失败.
+ *
+ * 编译运行: make -C tools/host_test
+ */
+#include <sched.h>
+#include <unistd.h>
+#include "../../cpu/bd19/iic_queue.c"
+
+#define MOCK_ADDR       0x18
+#define MOCK_NACK_ADDR  0x30
+#define FAIR_A_NUM      6
+#define FAIR_B_NUM      2
+#define CLOSE_NUM       4
+
+//iic_soft_bus_ops引用, 测试不走软件iic
+void soft_iic_start(soft_iic_dev iic) {}
+void soft_iic_stop(soft_iic_dev iic) {}
+u8 soft_iic_tx_byte(soft_iic_dev iic, u8 byte)
+{
+    return 0;
+}
+int soft_iic_read_buf(soft_iic_dev iic, void *buf, int len)
+{
+    return -1;
+}
+
+static u8 regs[16];
+static int err;
+
+#define CHECK(cond) \
+    do { \
+        if (!(cond)) { \
+            printf("FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond); \
+            err++; \
+        } \
+    } while (0)
+
+struct done_log {
+    volatile int num;
+    char order[16];
+    int result[16];
+};
+
+static struct done_log done;
+
+static void xfer_done(struct iic_xfer *x, int result)
+{
+    int i = done.num;
+
+    CHECK(!x->pending);
+    done.order[i] = *(char *)x->priv;
+    done.result[i] = result;
+    done.num = i + 1;
+}
+
+static void wait_done(int num)
+{
+    int i;
+
+    for (i = 0; i < 5000 && done.num < num; i++) {
+        usleep(1000);
+    }
+    CHECK(done.num == num);
+}
+
+static void test_sync(iic_client_t a, iic_client_t nack)
+{
+    u8 buf[3];
+
+    CHECK(iic_reg_write(a, 3, 0x5a) == 0);
+    CHECK(regs[3] == 0x5a);
+    regs[4] = 0x11;
+    regs[5] = 0x22;
+    CHECK(iic_reg_read(a, 3, buf, 3) == 3);
+    CHECK(buf[0] == 0x5a && buf[1] == 0x11 && buf[2] == 0x22);
+    CHECK(iic_reg_read(nack, 0, buf, 1) == -ENXIO);
+}
+
+static void test_fair(iic_client_t a, iic_client_t b)
+{
+    static struct iic_xfer xa[FAIR_A_NUM], xb[FAIR_B_NUM];
+    static u8 rbuf[FAIR_A_NUM + FAIR_B_NUM][2];
+    static u8 reg = 0;
+    static char ida = 'a', idb = 'b';
+    int i, left;
+
+    memset(&done, 0, sizeof(done));
+    //模拟在中断里连续提交: 全部入队后iic_queue任务才能取
+    local_irq_disable();
+    for (i = 0; i < FAIR_A_NUM; i++) {
+        iic_xfer_init(&xa[i], &reg, 1, rbuf[i], 2, xfer_done, &ida);
+        CHECK(iic_xfer_submit(a, &xa[i]) == 0);
+    }
+    CHECK(iic_xfer_submit(a, &xa[0]) == -EBUSY);
+    for (i = 0; i < FAIR_B_NUM; i++) {
+        iic_xfer_init(&xb[i], &reg, 1, rbuf[FAIR_A_NUM + i], 2, xfer_done, &idb);
+        CHECK(iic_xfer_submit(b, &xb[i]) == 0);
+    }
+    local_irq_enable();
+
+    wait_done(FAIR_A_NUM + FAIR_B_NUM);
+    //b的传输全部完成之前, 同一client不会连续执行两条
+    left = FAIR_B_NUM;
+    for (i = 0; i < done.num; i++) {
+        CHECK(done.result[i] == 2);
+        if (done.order[i] == 'b') {
+            left--;
+        }
+        if (left && i && done.order[i] == done.order[i - 1]) {
+            printf("order %.*s\n", done.num, done.order);
+            CHECK(0);
+            break;
+        }
+    }
+    CHECK(left == 0);
+}
+
+//@return 正常完成的传输数
+static int test_close(iic_client_t a)
+{
+    static struct iic_xfer x[CLOSE_NUM];
+    static u8 wbuf[2] = {8, 0x77};
+    static char id = 'a';
+    struct iic_xfer extra;
+    int i, num, eintr = 0, ok = 0;
+
+    memset(&done, 0, sizeof(done));
+    //每字节2ms, 保证关闭时第一条还在总线上
+    iic_mock.byte_delay = 2000;
+    local_irq_disable();
+    for (i = 0; i < CLOSE_NUM; i++) {
+        iic_xfer_init(&x[i], wbuf, 2, NULL, 0, xfer_done, &id);
+        CHECK(iic_xfer_submit(a, &x[i]) == 0);
+    }
+    local_irq_enable();
+
+    for (i = 0; i < 5000 && iic_queue.busy != a; i++) {
+        sched_yield();
+        usleep(100);
+    }
+    CHECK(iic_queue.busy == a);
+    num = done.num;
+    iic_client_close(a);
+    //未执行的传输在iic_client_close()里直接回调, 正在执行的那条还没有回调
+    CHECK(done.num < CLOSE_NUM);
+    CHECK(done.num > num);
+    iic_xfer_init(&extra, wbuf, 2, NULL, 0, NULL, NULL);
+    CHECK(iic_xfer_submit(a, &extra) == -EINVAL);
+
+    wait_done(CLOSE_NUM);
+    for (i = 0; i < done.num; i++) {
+        if (done.result[i] == -EINTR) {
+            eintr++;
+        } else if (done.result[i] == 2) {
+            ok++;
+        }
+    }
+    CHECK(eintr >= 1 && eintr + ok == CLOSE_NUM);
+    CHECK(regs[8] == 0x77);
+    //正在执行的传输完成后由iic_queue任务释放
+    for (i = 0; i < 1000 && a->used; i++) {
+        usleep(1000);
+    }
+    CHECK(!a->used && !a->closing);
+    iic_mock.byte_delay = 0;
+    return ok;
+}
+
+int main(void)
+{
+    iic_client_t a, b, nack;
+    int ok;
+
+    iic_queue_mock_attach(MOCK_ADDR, regs, sizeof(regs), 0);
+    CHECK(iic_client_open("hw", IIC_QUEUE_BUS_HW, 0, MOCK_ADDR, 0) == NULL);
+    a = iic_client_open("a", IIC_QUEUE_BUS_MOCK, 0, MOCK_ADDR, 0);
+    b = iic_client_open("b", IIC_QUEUE_BUS_MOCK, 0, MOCK_ADDR, 0);
+    nack = iic_client_open("nack", IIC_QUEUE_BUS_MOCK, 0, MOCK_NACK_ADDR, 0);
+    CHECK(a && b && nack);
+
+    test_sync(a, nack);
+    test_fair(a, b);
+    iic_queue_stat_dump();
+
+    //写1 + 读1 + 轮流FAIR_A_NUM条, 每条读传输写1字节读2字节
+    CHECK(a->stat.xfer == 2 + FAIR_A_NUM && a->stat.err == 0);
+    CHECK(a->stat.bytes == 2 + 4 + FAIR_A_NUM * 3);
+    CHECK(a->stat.max_queued == FAIR_A_NUM);
+    CHECK(b->stat.xfer == FAIR_B_NUM && b->stat.bytes == FAIR_B_NUM * 3);
+    CHECK(nack->stat.xfer == 1 && nack->stat.err == 1 && nack->stat.bytes == 0);
+    CHECK(iic_queue.queued == 0);
+
+    ok = test_close(a);
+    //被取消的传输不计入统计
+    CHECK(a->stat.xfer == 2 + FAIR_A_NUM + ok);
+
+    if (err) {
+        printf("iic_queue_test: %d check(s) failed\n", err);
+        return 1;
+    }
+    printf("iic_queue_test: ok\n");
+    return 0;
+}
@@ -0,0 +1,10 @@
+#ifndef APP_CONFIG_H
+#define APP_CONFIG_H
+
+/*
+ * 主机测试用: 只打开被测模块
+ */
+#define CONFIG_IIC_QUEUE_ENABLE         1
+#define IIC_QUEUE_MOCK_BUS_ENABLE       1
+
+#endif
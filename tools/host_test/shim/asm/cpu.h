@@ -0,0 +1,26 @@
+#ifndef ASM_CPU_H
+#define ASM_CPU_H
+
+/*
+ * 主机测试用: 替代include_lib/driver/cpu/bd19/asm/cpu.h,
+ * 只提供generic/typedef.h需要的基本类型和字节序定义
+ */
+
+typedef unsigned char   		u8, bool, BOOL;
+typedef char            		s8;
+typedef unsigned short  		u16;
+typedef signed short    		s16;
+typedef unsigned int    		u32;
+typedef signed int      		s32;
+typedef long long               s64;
+typedef unsigned long long      u64;
+
+#ifndef BIG_ENDIAN
+#define BIG_ENDIAN 			0x3021
+#endif
+#ifndef LITTLE_ENDIAN
+#define LITTLE_ENDIAN 		0x4576
+#endif
+#define CPU_ENDIAN 			LITTLE_ENDIAN
+
+#endif
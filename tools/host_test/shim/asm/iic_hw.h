@@ -0,0 +1,8 @@
+#ifndef _IIC_HW_H_
+#define _IIC_HW_H_
+
+/*
+ * 主机测试用: 没有硬件iic
+ */
+
+#endif
@@ -0,0 +1,17 @@
+#ifndef ASM_INCLUDES_H
+#define ASM_INCLUDES_H
+
+/*
+ * 主机测试用: 关中断用一把可重入的全局锁模拟, 没有中断上下文
+ */
+#include "generic/typedef.h"
+
+void local_irq_disable(void);
+void local_irq_enable(void);
+
+static inline int cpu_in_irq(void)
+{
+    return 0;
+}
+
+#endif
@@ -0,0 +1,19 @@
+/*
+ * 主机测试用: 替代include_lib/system/debug.h, 直接输出到stdout
+ */
+#include <stdio.h>
+
+#undef log_info
+#undef log_error
+
+#ifdef LOG_INFO_ENABLE
+#define log_info(format, ...)       printf("[Info] :" LOG_TAG format "\n", ## __VA_ARGS__)
+#else
+#define log_info(...)
+#endif
+
+#ifdef LOG_ERROR_ENABLE
+#define log_error(format, ...)      printf("<Error> :" LOG_TAG format "\n", ## __VA_ARGS__)
+#else
+#define log_error(...)
+#endif
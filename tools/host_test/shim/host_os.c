@@ -0,0 +1,105 @@
+/*
+ * 主机测试用os接口: 任务用线程实现, 关中断用全局可重入锁
+ */
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+#include "asm/includes.h"
+#include "system/includes.h"
+
+static pthread_mutex_t irq_lock;
+static pthread_once_t irq_once = PTHREAD_ONCE_INIT;
+static __thread const char *task_name = "main";
+
+static void irq_lock_init(void)
+{
+    pthread_mutexattr_t attr;
+
+    pthread_mutexattr_init(&attr);
+    pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+    pthread_mutex_init(&irq_lock, &attr);
+}
+
+void local_irq_disable(void)
+{
+    pthread_once(&irq_once, irq_lock_init);
+    pthread_mutex_lock(&irq_lock);
+}
+
+void local_irq_enable(void)
+{
+    pthread_mutex_unlock(&irq_lock);
+}
+
+//delay()参数按us模拟总线耗时
+void delay(unsigned int n)
+{
+    if (n) {
+        usleep(n);
+    }
+}
+
+unsigned long jiffies_half_msec(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 2000 + ts.tv_nsec / 500000;
+}
+
+int os_sem_create(OS_SEM *sem, int cnt)
+{
+    return sem_init(sem, 0, cnt);
+}
+
+int os_sem_pend(OS_SEM *sem, int timeout)
+{
+    return sem_wait(sem);
+}
+
+int os_sem_post(OS_SEM *sem)
+{
+    return sem_post(sem);
+}
+
+int os_sem_del(OS_SEM *sem, int block)
+{
+    return sem_destroy(sem);
+}
+
+struct task_arg {
+    void (*task)(void *p);
+    void *p;
+    const char *name;
+};
+
+static void *task_entry(void *arg)
+{
+    struct task_arg a = *(struct task_arg *)arg;
+
+    free(arg);
+    task_name = a.name;
+    a.task(a.p);
+    return NULL;
+}
+
+int task_create(void (*task)(void *p), void *p, const char *name)
+{
+    struct task_arg *a = malloc(sizeof(*a));
+    pthread_t tid;
+
+    a->task = task;
+    a->p = p;
+    a->name = name;
+    if (pthread_create(&tid, NULL, task_entry, a)) {
+        free(a);
+        return -1;
+    }
+    pthread_detach(tid);
+    return 0;
+}
+
+const char *os_current_task(void)
+{
+    return task_name;
+}
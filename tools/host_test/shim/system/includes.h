@@ -0,0 +1,21 @@
+#ifndef SYSTEM_INCLUDES_H
+#define SYSTEM_INCLUDES_H
+
+/*
+ * 主机测试用: 用pthread/POSIX信号量实现被测模块用到的os接口, 实现在host_os.c
+ */
+#include <stdio.h>
+#include <semaphore.h>
+#include "generic/typedef.h"
+
+typedef sem_t OS_SEM;
+
+int os_sem_create(OS_SEM *sem, int cnt);
+int os_sem_pend(OS_SEM *sem, int timeout);
+int os_sem_post(OS_SEM *sem);
+int os_sem_del(OS_SEM *sem, int block);
+
+int task_create(void (*task)(void *p), void *p, const char *name);
+const char *os_current_task(void);
+
+#endif
@@ -0,0 +1,6 @@
+#ifndef SYSTEM_MALLOC_H
+#define SYSTEM_MALLOC_H
+
+#include <stdlib.h>
+
+#endif
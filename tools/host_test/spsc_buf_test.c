@@ -0,0 +1,144 @@
+/*
+ * include_lib/system/generic/spsc_buf.h 主机并发测试
+ *
+ * 生产者线程按递增字节序列写入(交替使用拷贝写和write_alloc直接写, 长度随机),
+ * 消费者线程交替使用拷贝读和read_alloc直接读并逐字节校验, 同时统计水位回调次数.
+ * 目标芯片是单核, SPSC_BARRIER()只是编译器屏障, 在x86这类强序主机上等价;
+ * 弱序主机(arm64等)上本测试不能说明问题.
+ *
+ * 编译运行: make -C tools/host_test
+ */
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include "generic/typedef.h"
+#include "generic/spsc_buf.h"
+
+#define TEST_BUF_SIZE       256
+#define TEST_TOTAL_BYTES    (16 * 1024 * 1024)
+#define TEST_WM_LEVEL       64
+
+static spsc_buf_t sbuf;
+static u8 buf[TEST_BUF_SIZE];
+SPSC_BUF_SIZE_CHECK(test_buf, TEST_BUF_SIZE);
+static volatile u32 wm_cnt;
+static int err;
+
+static u32 rand_next(u32 *seed)
+{
+    *seed = *seed * 1103515245 + 12345;
+    return *seed >> 8;
+}
+
+static void wm_cb(void *priv)
+{
+    wm_cnt++;
+}
+
+static void *producer(void *arg)
+{
+    u32 seed = 1;
+    u32 total = 0;
+    u8 val = 0;
+    u8 tmp[TEST_BUF_SIZE];
+    u32 len, i;
+    u8 *p;
+
+    while (total < TEST_TOTAL_BYTES) {
+        len = rand_next(&seed) % (TEST_BUF_SIZE / 2) + 1;
+        if (len > TEST_TOTAL_BYTES - total) {
+            len = TEST_TOTAL_BYTES - total;
+        }
+        if (rand_next(&seed) & 1) {
+            for (i = 0; i < len; i++) {
+                tmp[i] = val + i;
+            }
+            len = spsc_buf_write(&sbuf, tmp, len);
+        } else {
+            p = spsc_buf_write_alloc(&sbuf, &i);
+            len = len < i ? len : i;
+            for (i = 0; i < len; i++) {
+                p[i] = val + i;
+            }
+            spsc_buf_write_updata(&sbuf, len);
+        }
+        if (!len) {
+            sched_yield();
+        }
+        val += len;
+        total += len;
+    }
+    return NULL;
+}
+
+static void *consumer(void *arg)
+{
+    u32 seed = 2;
+    u32 total = 0;
+    u8 val = 0;
+    u8 tmp[TEST_BUF_SIZE];
+    u32 len, i;
+    u8 *p;
+
+    while (total < TEST_TOTAL_BYTES && !err) {
+        len = rand_next(&seed) % (TEST_BUF_SIZE / 2) + 1;
+        if (rand_next(&seed) & 1) {
+            len = spsc_buf_read(&sbuf, tmp, len);
+            p = tmp;
+        } else {
+            p = spsc_buf_read_alloc(&sbuf, &i);
+            len = len < i ? len : i;
+        }
+        for (i = 0; i < len; i++) {
+            if (p[i] != (u8)(val + i)) {
+                printf("spsc_buf: data error at %u: %02x != %02x\n", total + i, p[i], (u8)(val + i));
+                err = 1;
+                break;
+            }
+        }
+        if (p != tmp) {
+            spsc_buf_read_updata(&sbuf, len);
+        }
+        if (!len) {
+            sched_yield();
+        }
+        val += len;
+        total += len;
+    }
+    return NULL;
+}
+
+int main(void)
+{
+    pthread_t tp, tc;
+    u8 odd[100];
+
+    if (spsc_buf_init(&sbuf, odd, sizeof(odd)) != -1 || spsc_buf_init(&sbuf, odd, 0) != -1) {
+        printf("spsc_buf: non power of 2 size accepted\n");
+        return 1;
+    }
+    if (spsc_buf_init(&sbuf, buf, sizeof(buf))) {
+        printf("spsc_buf: init failed\n");
+        return 1;
+    }
+    spsc_buf_set_watermark(&sbuf, TEST_WM_LEVEL, wm_cb, NULL);
+
+    pthread_create(&tp, NULL, producer, NULL);
+    pthread_create(&tc, NULL, consumer, NULL);
+    pthread_join(tp, NULL);
+    pthread_join(tc, NULL);
+
+    if (err) {
+        return 1;
+    }
+    if (spsc_buf_get_data_len(&sbuf) != 0) {
+        printf("spsc_buf: %u bytes left\n", spsc_buf_get_data_len(&sbuf));
+        return 1;
+    }
+    if (wm_cnt == 0) {
+        printf("spsc_buf: watermark callback never called\n");
+        return 1;
+    }
+    printf("spsc_buf: %u bytes ok, watermark %u\n", TEST_TOTAL_BYTES, wm_cnt);
+    return 0;
+}